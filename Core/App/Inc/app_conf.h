@@ -0,0 +1,151 @@
+#ifndef _APP_CONF_H
+#define _APP_CONF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Feature switches (1 = enabled, 0 = disabled)
+****************************************************************/
+
+/* Run-time clock scaling: low MSI range while waiting for the echo,
+ * full PLL speed for filtering and display rendering. */
+#define APP_CLOCK_SCALING                  1
+
+/* Buzzer cadence generated by TIM4 gating TIM1 instead of toggling the
+ * PWM from the main loop. */
+#define APP_BUZZER_HW_CADENCE              1
+
+/* DMA-streamed buzzer patterns: boot chirp and a two-tone alarm in the
+ * contact zone. Builds on the hardware cadence timer setup. */
+#define APP_BUZZER_PATTERNS                1
+
+/* Second SSD1306 at the rear, on the same I2C2 bus as the dashboard
+ * panel (0x3C). Its frames are queued behind the dashboard ones by DMA. */
+#define APP_OLED_REAR_PANEL                1
+#define APP_OLED_REAR_ADDR                 (0x3D << 1)
+
+/* Distance history graph below the dashboard text. The panel scrolls the
+ * plot itself, so a sample costs one column over I2C, not a frame. */
+#define APP_OLED_GRAPH                     1
+#define APP_OLED_GRAPH_SAMPLE_MS           20U   /**< >= SSD1306_SCROLL_SETTLE_MS */
+#define APP_OLED_GRAPH_FULL_SCALE_CM       400   /**< Distance on the top row [cm] */
+
+/* Dashboard proximity bar: empty at this distance, full at contact. */
+#define APP_OLED_BAR_RANGE_CM              200
+
+/* Fast boot: the sensor and buzzer paths come up first and the main loop
+ * starts measuring at once. The OLED init table and the first blank frame
+ * go out by DMA from the loop, as soon as the panel has powered up. */
+#define APP_FAST_BOOT                      1
+
+/* A display that does not answer, or an I2C2 bus that had to be recovered,
+ * is initialized again after this time. */
+#define APP_OLED_RETRY_MS                  500U
+
+/* Debug: report an I2C2 timeout every N ms to exercise bus recovery and
+ * display re-init on the target (0 = off). */
+#define APP_BUS_FAULT_INJECT_MS            0
+
+/* Hot-path I/O (HC-SR04 trigger and echo edge, buzzer PWM start/stop,
+ * EXTI dispatch) by direct register access instead of HAL
+ * calls. The driver APIs stay the same (IO_* in main.h). */
+#define APP_FAST_IO                        1
+
+/* Interference rejection (other parking sensors in range): every ping is
+ * delayed by a pseudo-random 0..APP_PING_JITTER_US, consecutive offsets
+ * at least APP_PING_JITTER_STEP_US apart, and an echo is only used when
+ * earlier echoes pinged at other offsets agree with it (HCSR04_SetConfirm,
+ * HCSR04_SetPingOffset). */
+#define APP_PING_JITTER                    1
+#define APP_PING_JITTER_US                 2000U
+#define APP_PING_JITTER_STEP_US            600U  /**< >= HS_SR04_AGREE_OFFSET_US */
+
+/* Per-unit distance calibration over UART ("cal <cm>", "cal fit",
+ * "cal save", "cal reset", "cal show"), stored in the last flash page. */
+#define APP_CALIBRATION                    1
+#define APP_CALIB_SAMPLES                  32U   /**< Accepted echoes averaged per target */
+
+/* Bay occupancy events instead of a distance line per measurement. The bay
+ * is occupied once a target stays nearer than ENTER_CM, free once it stays
+ * past EXIT_CM or out of range, for the dwell time and at least DEBOUNCE
+ * readings in a row. UART gets a line per change and a heartbeat; the
+ * panels only redraw when the readout moves by DISPLAY_STEP_CM. */
+#define APP_OCCUPANCY                      1
+#define APP_OCC_ENTER_CM                   150U
+#define APP_OCC_EXIT_CM                    200U
+#define APP_OCC_ENTER_DWELL_MS             3000U
+#define APP_OCC_EXIT_DWELL_MS              5000U
+#define APP_OCC_DEBOUNCE                   5U    /**< Readings in a row */
+#define APP_OCC_HEARTBEAT_MS               60000U
+#define APP_OCC_DISPLAY_STEP_CM            2U
+
+/* Monitoring summaries over UART: min, max, mean, standard deviation and
+ * percentiles of the distance and of the ping latency (trigger to
+ * validated result), over the last STATS_PANES intervals. */
+#define APP_STATS                          1
+#define APP_STATS_INTERVAL_MS              15000U
+#define APP_STATS_RANGE_CM                 400.0f /**< Distance histogram range */
+
+/* Flight recorder of the raw pings (trigger, echo edges, validation) in a
+ * RAM ring of 8-byte records, dumped by "trace dump" over UART for
+ * Tools/replay. "trace clear" starts it over. */
+#define APP_TRACE                          1
+#define APP_TRACE_RECORDS                  1024U /**< Power of 2, ~3 per ping */
+#define APP_TRACE_DUMP_PER_LOOP            4U    /**< UART lines per main loop pass */
+
+/* End-to-end latency per output, over UART: from the echo edge in the
+ * EXTI ISR to TIM1 reprogrammed (buzzer) or to the frame's last byte on
+ * the bus (each panel). p50, p99 and max over the last STATS_PANES
+ * intervals, and the longest since boot. */
+#define APP_LATENCY                        1
+#define APP_LATENCY_INTERVAL_MS            15000U
+#define APP_LATENCY_BUZZER_RANGE_US        2000.0f  /**< Histogram range */
+#define APP_LATENCY_DISPLAY_RANGE_US       50000.0f /**< Histogram range */
+
+#if APP_TRACE && (APP_TRACE_RECORDS & (APP_TRACE_RECORDS - 1U))
+#error "APP_TRACE_RECORDS must be a power of 2"
+#endif
+#if APP_OCCUPANCY && (APP_OCC_EXIT_CM <= APP_OCC_ENTER_CM)
+#error "APP_OCC_EXIT_CM must lie above APP_OCC_ENTER_CM"
+#endif
+#if APP_PING_JITTER && (APP_PING_JITTER_US < 2U * APP_PING_JITTER_STEP_US)
+#error "APP_PING_JITTER_US must be at least twice APP_PING_JITTER_STEP_US"
+#endif
+#if APP_BUZZER_PATTERNS && !APP_BUZZER_HW_CADENCE
+#error "APP_BUZZER_PATTERNS requires APP_BUZZER_HW_CADENCE"
+#endif
+
+/****************************************************************
+ * Reporting
+****************************************************************/
+#define APP_CLOCK_REPORT_INTERVAL_MS       5000U /**< Clock scaling report period [ms] */
+#define APP_DISPLAY_REPORT_INTERVAL_MS     5000U /**< Display render/transfer report period [ms] */
+#define APP_BOOT_REPORT_TIMEOUT_MS         2000U /**< Boot milestones are reported at the latest after [ms] */
+
+/* Measure full-frame OLED FPS for every I2C speed profile at boot and
+ * print it over UART (adds ~10 s per profile to start-up). */
+#define APP_OLED_FPS_REPORT                0
+
+/* Time the per-pixel reference drawing routines against the span/blit
+ * primitives at boot and print both over UART. */
+#define APP_OLED_GFX_BENCH                 0
+
+/* Time the hot-path I/O operations with the DWT cycle counter at boot and
+ * print them over UART; build with APP_FAST_IO 0 and 1 to compare. */
+#define APP_IO_BENCH                       0
+
+/* Interrupt entry latency of the priority plan (irq_conf.h) under
+ * synthetic load, at boot: min, p50, p99, max, jitter and the histogram
+ * in DWT cycles over UART. TIM6 and TIM7 are borrowed for the test.
+ * LOOPBACK 1: EXTI0 is driven through a jumper from the trigger pin to the
+ * echo pin, sensor unplugged; 0: by software, no jumper. */
+#define APP_IRQ_SELFTEST                   0
+#define APP_IRQ_SELFTEST_LOOPBACK          1
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_CONF_H */
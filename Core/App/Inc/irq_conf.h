@@ -0,0 +1,56 @@
+#ifndef _IRQ_CONF_H
+#define _IRQ_CONF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Interrupt priority plan
+ *
+ * HAL_Init selects NVIC_PRIORITYGROUP_4: 16 preemption levels, no
+ * subpriority, so every HAL_NVIC_SetPriority() passes 0 as the sub.
+ * A lower number preempts a higher one; equal levels never preempt
+ * each other and wait for the running handler to return.
+ *
+ * The echo edge alone is on level 0: its timestamp is the
+ * measurement, and anything that can hold it off adds directly to the
+ * distance error (1 us = 0.17 mm, but a 10 us DMA callback is 1.7 mm).
+ * The PRIMASK sections of the timebase and the trace ring still mask
+ * it; they are a few dozen cycles each.
+ *
+ * SysTick only feeds HAL_GetTick() timeouts polled from the main loop,
+ * so it goes to the bottom. Nothing may wait on HAL_GetTick() from a
+ * handler.
+****************************************************************/
+#define IRQ_PRIO_ECHO          0U    /**< EXTI0: HC-SR04 echo edge timestamp */
+#define IRQ_PRIO_I2C           2U    /**< I2C2 event/error: bus manager state machine */
+#define IRQ_PRIO_I2C_DMA       2U    /**< DMA1 channel 4: I2C2 TX, queues the next frame */
+#define IRQ_PRIO_TIMEBASE      3U    /**< TIM2 wrap: late service is fine, readers see a pending wrap */
+#define IRQ_PRIO_UART_RX       3U    /**< USART2 RX: one byte per 87 us at 115200 */
+#define IRQ_PRIO_SYSTICK       15U   /**< HAL tick */
+
+/* The plan as a table, for the interrupt latency self-test (irqtest.c):
+ * X(name, priority) */
+#define IRQ_PLAN(X)                          \
+    X("exti0 echo", IRQ_PRIO_ECHO)           \
+    X("i2c2 ev/er", IRQ_PRIO_I2C)            \
+    X("dma1 ch4",   IRQ_PRIO_I2C_DMA)        \
+    X("tim2 base",  IRQ_PRIO_TIMEBASE)       \
+    X("usart2 rx",  IRQ_PRIO_UART_RX)        \
+    X("systick",    IRQ_PRIO_SYSTICK)
+
+#if (IRQ_PRIO_ECHO >= IRQ_PRIO_I2C) || (IRQ_PRIO_ECHO >= IRQ_PRIO_I2C_DMA) || \
+    (IRQ_PRIO_ECHO >= IRQ_PRIO_TIMEBASE) || (IRQ_PRIO_ECHO >= IRQ_PRIO_UART_RX) || \
+    (IRQ_PRIO_ECHO >= IRQ_PRIO_SYSTICK)
+#error "IRQ_PRIO_ECHO must preempt every other interrupt"
+#endif
+#if IRQ_PRIO_SYSTICK > 15U
+#error "The STM32L4 NVIC has 4 priority bits"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IRQ_CONF_H */
@@ -34,6 +34,7 @@ extern "C" {
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "app_conf.h"
 
 /* USER CODE END Includes */
 
@@ -55,7 +56,7 @@ extern "C" {
 /* Exported functions prototypes ---------------------------------------------*/
 void Error_Handler(void);
 
-extern TIM_HandleTypeDef htim3;
+extern volatile uint32_t echo_irq_entry;   /**< DWT stamp at EXTI0 handler entry */
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
@@ -79,6 +80,73 @@ extern TIM_HandleTypeDef htim3;
 /*****************************************************************************
 * Static inline functions 
 ******************************************************************************/
+/* Hot-path I/O. With APP_FAST_IO the same operations are done by direct
+ * register access: one store instead of a HAL call with parameter checks,
+ * handle state and lock bookkeeping. */
+static inline void IO_PinWrite(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+#if APP_FAST_IO
+  port->BSRR = (state != GPIO_PIN_RESET) ? (uint32_t)pin : (uint32_t)pin << 16;
+#else
+  HAL_GPIO_WritePin(port, pin, state);
+#endif
+}
+
+static inline GPIO_PinState IO_PinRead(GPIO_TypeDef *port, uint16_t pin)
+{
+#if APP_FAST_IO
+  return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+#else
+  return HAL_GPIO_ReadPin(port, pin);
+#endif
+}
+
+/* Register path leaves the HAL channel state alone: use one backend for
+ * both start and stop of a channel */
+static inline void IO_PwmStart(TIM_HandleTypeDef *htim, uint32_t channel)
+{
+#if APP_FAST_IO
+  htim->Instance->CCER |= TIM_CCER_CC1E << (channel & 0x1FU);
+  if (IS_TIM_BREAK_INSTANCE(htim->Instance))
+  {
+    htim->Instance->BDTR |= TIM_BDTR_MOE;
+  }
+  htim->Instance->CR1 |= TIM_CR1_CEN;
+#else
+  HAL_TIM_PWM_Start(htim, channel);
+#endif
+}
+
+static inline void IO_PwmStop(TIM_HandleTypeDef *htim, uint32_t channel)
+{
+#if APP_FAST_IO
+  htim->Instance->CCER &= ~(TIM_CCER_CC1E << (channel & 0x1FU));
+  if ((htim->Instance->CCER & TIM_CCER_CCxE_MASK) == 0U)
+  {
+    if (IS_TIM_BREAK_INSTANCE(htim->Instance))
+    {
+      htim->Instance->BDTR &= ~TIM_BDTR_MOE;
+    }
+    htim->Instance->CR1 &= ~TIM_CR1_CEN;
+  }
+#else
+  HAL_TIM_PWM_Stop(htim, channel);
+#endif
+}
+
+/* EXTI line handler body: clear the pending bit, call the callback */
+static inline void IO_ExtiIrq(uint16_t pin)
+{
+#if APP_FAST_IO
+  if (EXTI->PR1 & pin)
+  {
+    EXTI->PR1 = pin;
+    HAL_GPIO_EXTI_Callback(pin);
+  }
+#else
+  HAL_GPIO_EXTI_IRQHandler(pin);
+#endif
+}
 
 
 #ifdef __cplusplus
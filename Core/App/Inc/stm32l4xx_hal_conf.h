@@ -30,6 +30,7 @@
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+#include "irq_conf.h"
 
 /* ########################## Module Selection ############################## */
 /**
@@ -182,7 +183,7 @@
   */
 
 #define  VDD_VALUE					  3300U /*!< Value of VDD in mv */
-#define  TICK_INT_PRIORITY            0U    /*!< tick interrupt priority */
+#define  TICK_INT_PRIORITY            IRQ_PRIO_SYSTICK /*!< tick interrupt priority (irq_conf.h) */
 #define  USE_RTOS                     0U
 #define  PREFETCH_ENABLE              1U
 #define  INSTRUCTION_CACHE_ENABLE     1U
@@ -15,6 +15,8 @@
 
 /* STM32L4 HAL peripherals */
 #include "main.h"
+#include "app_conf.h"
+#include "dma.h"
 #include "gpio.h"
 #include "i2c.h"
 #include "systemclock.h"
@@ -23,19 +25,45 @@
 
 /* External hardware drivers */
 #include "hcsr04.h"
+#include "i2c_bus.h"
+#include "timebase.h"
+#include "calib.h"
+#include "occupancy.h"
+#include "stats.h"
+#include "pipeline.h"
+#include "trace.h"
+#include "latency.h"
+#include "irqtest.h"
 #include "buzzer.h"
+#include "policy.h"
 #include "ssd1306.h"
 #include "ssd1306_fonts.h"
+#include "ssd1306_glyph.h"
+#include "ssd1306_tests.h"
+#include "ui.h"
 
 /* Standard C library */
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
 
 /*******************************************************************************
  * Defines
  ******************************************************************************/
 #define UART_MAX_BUFFER_LEN    100     /**< Maximum length of the UART buffer */
+#define BUZZER_CONTINUOUS_PERIOD_MS 500 /**< Cadence period of a steady tone [ms] */
+#define APP_COMMANDS           (APP_CALIBRATION || APP_TRACE) /**< UART command input */
+
+/* Dashboard layout: readout row (pages 0-1), proximity bar (page 2), graph (pages 3-7) */
+#define DASH_GLYPHS            "0123456789. -" /**< Cached cells of the distance readout */
+#define DASH_FIELD_LEN         6       /**< "ddd.dd" */
+#define DASH_ROW_H             16      /**< Readout row height [px] */
+#define DASH_VALUE_X           42      /**< First column of the distance digits */
+#define DASH_BAR_Y             16
+#define DASH_GRAPH_X           22      /**< Axis column, scale labels go left of it */
+#define DASH_GRAPH_Y           24
 
 /*******************************************************************************
  * Typedefs
@@ -48,6 +76,42 @@ typedef uint8_t oled_value_size_t;     /**< String length for OLED display   */
 typedef char    uart_value_t;          /**< Character used for UART transfer */
 typedef uint8_t uart_value_size_t;     /**< String length for UART transfer  */
 
+/* Dashboard widgets; the message takes the readout row while it is shown */
+typedef enum {
+    DASH_W_LABEL = 0,                  /**< "Dist:" */
+    DASH_W_VALUE,                      /**< Distance digits */
+    DASH_W_UNIT,                       /**< "cm" */
+    DASH_W_BUZZER,                     /**< Bell icon while the buzzer sounds */
+    DASH_W_MESSAGE,                    /**< One line of free text */
+    DASH_W_BAR,                        /**< Proximity bar */
+#if APP_OLED_GRAPH
+    DASH_W_SCALE_TOP,                  /**< Graph full-scale label */
+    DASH_W_SCALE_ZERO,                 /**< Graph zero label */
+    DASH_W_GRAPH,                      /**< Distance history */
+#endif
+    DASH_W_COUNT
+} dash_widget_t;
+
+/* Boot milestones, in the order they are normally reached */
+typedef enum {
+    BOOT_SENSOR = 0,                   /**< HC-SR04 and its timers ready */
+    BOOT_BUZZER,                       /**< Buzzer timers and cadence ready */
+    BOOT_PERIPH,                       /**< UART and I2C ready, System_Init done */
+    BOOT_FIRST_ECHO,                   /**< First valid echo */
+    BOOT_FIRST_BUZZ,                   /**< Buzzer follows the first valid distance */
+    BOOT_OLED_START,                   /**< Display init sent or queued */
+    BOOT_OLED_READY,                   /**< Display init and blank frame on the panel */
+    BOOT_MILESTONES
+} boot_milestone_t;
+
+/* Deferred display bring-up, one step per loop pass (fast boot and after
+ * a bus recovery) */
+typedef enum {
+    OLED_BOOT_POWER_UP = 0,            /**< Waiting for the panel power-up time or a retry */
+    OLED_BOOT_DASH,                    /**< Dashboard init transfer in flight */
+    OLED_BOOT_DONE
+} oled_boot_t;
+
 /*******************************************************************************
  * Global variables
  ******************************************************************************/
@@ -55,122 +119,631 @@ typedef uint8_t uart_value_size_t;     /**< String length for UART transfer  */
 UART_HandleTypeDef huart2;
 TIM_HandleTypeDef  htim1;
 TIM_HandleTypeDef  htim2;
-TIM_HandleTypeDef  htim3;
+TIM_HandleTypeDef  htim4;
 I2C_HandleTypeDef  hi2c2;
+DMA_HandleTypeDef  hdma_tim1_up;
+DMA_HandleTypeDef  hdma_i2c2_tx;
+DMA_HandleTypeDef  hdma_tim4_ch1;
+
+/* I2C2 transaction manager: both OLED panels, room for more devices */
+static i2c_bus_t   i2c2_bus;
 
 /* HC-SR04 echo timing */
-volatile timer_tick_t start_time  = 0;        /**< Rising edge timestamp [timer ticks] */
-volatile timer_tick_t end_time    = 0;        /**< Falling edge timestamp [timer ticks] */
-echo_state_t          echo_state  = WAITING_RISING_EDGE; /**< Current state of echo signal */
+volatile uint32_t     echo_irq_entry = 0;     /**< DWT stamp at EXTI0 handler entry [cycles] */
+static volatile uint32_t echo_irq_last_cycles = 0; /**< Handler entry -> edge timestamp [cycles] */
+static volatile uint32_t echo_irq_max_cycles  = 0;
 
 /* UART communication */
 uart_value_size_t uart_mes_len = 0;          /**< Length of the message sent via UART */
 uart_value_t      uart_buffer[UART_MAX_BUFFER_LEN]; /**< UART message buffer */
 
 /* Distance and buzzer logic */
-static uint32_t          last_distance_measure = 0;     /**< Last measurement timestamp [ms] */
-static hcsr04_distance_t distance              = -1.0f; /**< Last measured distance [cm] */
-static uint32_t          last_buzzer_toggle    = 0;     /**< Last buzzer toggle timestamp [ms] */
+static timebase_us_t     next_ping_us          = 0;     /**< Earliest next trigger */
+#if APP_PING_JITTER
+static uint32_t          ping_rng              = 0;     /**< xorshift32 state */
+static uint32_t          ping_offset_us        = 0;     /**< Jitter of the last ping */
+#endif
+static uint32_t          echo_latency_us       = 0;     /**< Trigger to validated result */
+static hcsr04_result_t   echo_result;                   /**< Validation of the last trigger */
+static pipeline_t        pipe;                          /**< Echo, distance, buzzer and display decisions */
 static bool              buzzer_on             = false; /**< Buzzer state flag (ON/OFF) */
+#if APP_BUZZER_HW_CADENCE
+static uint32_t          buzzer_cadence        = POLICY_CADENCE_SILENT; /**< Active cadence [ms] */
+static uint32_t          buzzer_tone           = 0;     /**< Active tone [Hz] */
+#else
+static uint32_t          last_buzzer_toggle    = 0;     /**< Last buzzer toggle timestamp [ms] */
+#endif
+
+#if APP_CLOCK_SCALING
+/* Clock scaling report */
+static uint32_t          measurement_count     = 0;     /**< Measurements since boot */
+static uint32_t          last_clock_report     = 0;     /**< Last clock report timestamp [ms] */
+#endif
+
+#if APP_STATS
+/* Monitoring summaries */
+static uint32_t          last_stats_report     = 0;     /**< Last summary timestamp [ms] */
+#endif
+
+#if APP_LATENCY
+/* End-to-end latency, echo edge to output */
+static latency_channel_t latency[LATENCY_OUT_COUNT];
+static volatile uint32_t latency_shown_us[LATENCY_OUT_COUNT]; /**< Panel samples from the I2C ISR, 0 = none */
+static uint32_t          last_latency_report   = 0;     /**< Last latency report timestamp [ms] */
+#endif
+
+#if APP_TRACE
+/* Raw ping trace dump */
+static uint32_t          trace_dump_next       = 0;     /**< Next record to send */
+static bool              trace_dumping         = false;
+#endif
+
+/* Display statistics report */
+static uint32_t          last_display_report   = 0;     /**< Last display report timestamp [ms] */
+
+/* Boot milestones [us since reset] */
+static uint32_t          boot_us[BOOT_MILESTONES];
+static uint32_t          boot_marked           = 0;     /**< Bit per milestone reached */
+static uint32_t          boot_base_us          = 0;     /**< Time before the timebase started [us] */
+static bool              boot_reported         = false;
+
+/* Display bring-up */
+static bool              display_ready         = false; /**< Dashboard UI may be committed */
+static oled_boot_t       oled_boot             = APP_FAST_BOOT ? OLED_BOOT_POWER_UP : OLED_BOOT_DONE;
+static uint32_t          oled_retry_at         = 0;     /**< Next init attempt after a failure [ms] */
+#if APP_BUS_FAULT_INJECT_MS
+static uint32_t          last_fault_inject     = 0;     /**< Last injected I2C fault [ms] */
+#endif
+
+/* Main loop time [us] */
+static uint32_t          loop_last_us          = 0;
+static uint32_t          loop_max_us           = 0;     /**< Longest since the last report */
+static uint32_t          loop_worst_us         = 0;     /**< Longest since boot */
+
+/* Dashboard UI */
+static ssd1306_GlyphCache_t dash_glyphs;                  /**< Pre-rendered Font_7x10 cells */
+static ui_widget_t          dash_widgets[DASH_W_COUNT];
+static ui_screen_t          dash_ui;
+
+#if APP_OLED_GRAPH
+static uint32_t          last_graph_sample     = 0;     /**< Last graph sample timestamp [ms] */
+#endif
+
+#if APP_OLED_REAR_PANEL
+/* Rear OLED panel (the dashboard panel is the driver default) */
+static uint8_t           rear_framebuffers[2][SSD1306_BUFFER_SIZE];
+static SSD1306_t         rear_panel = SSD1306_PANEL_INIT(&hi2c2, APP_OLED_REAR_ADDR,
+                                                         SSD1306_WIDTH, SSD1306_HEIGHT,
+                                                         rear_framebuffers[0], rear_framebuffers[1]);
+static char              rear_text[16];                 /**< Shown on the panel, "" = redraw */
+#endif
+
+#if APP_CALIBRATION
+/* Calibration */
+static calib_table_t     calib;                         /**< Applied to every echo */
+static calib_ref_t       cal_refs[CALIB_MAX_REFS];
+static uint32_t          cal_ref_count         = 0;
+static uint32_t          cal_target_cm         = 0;     /**< Target being sampled, 0 = none */
+static uint32_t          cal_sum_us            = 0;
+static uint32_t          cal_samples           = 0;
+#endif
+
+#if APP_COMMANDS
+/* UART command input */
+static char              cmd_line[24];                  /**< Command being received */
+static uint32_t          cmd_line_len          = 0;
+#endif
 
 /*******************************************************************************
  * Constants
  ******************************************************************************/
 const uint32_t measure_interval = 1;   /**< Measurement interval [ms] */
-const uint32_t interval_min     = 50;  /**< Minimum buzzer toggle interval [ms] */
-const uint32_t interval_max     = 500; /**< Maximum buzzer toggle interval [ms] */
+
+/* 8x8 bell, screenbuffer format (one byte per column, LSB on top) */
+static const uint8_t icon_bell[8] = { 0x20, 0x3C, 0x3E, 0xBF, 0xBF, 0x3E, 0x3C, 0x20 };
+
+/*******************************************************************************
+ * Boot milestones: timebase once it runs, HAL tick before that
+ ******************************************************************************/
+static uint32_t Boot_Now(void) {
+    return boot_base_us + timebase_now32();
+}
+
+static void Boot_Mark(boot_milestone_t milestone) {
+    if (boot_marked & (1U << milestone)) {
+        return;
+    }
+    boot_us[milestone] = Boot_Now();
+    boot_marked |= 1U << milestone;
+}
 
 /*******************************************************************************
- * System Initialization
+ * Blocking display bring-up (both panels, then the glyph cache)
+ ******************************************************************************/
+#if !APP_FAST_BOOT
+static void Display_Init(void) {
+    Boot_Mark(BOOT_OLED_START);
+    ssd1306_Init();                   // Sends one init table and a blank frame
+    Boot_Mark(BOOT_OLED_READY);
+    ssd1306_GlyphCacheInit(&dash_glyphs, &Font_7x10, DASH_GLYPHS);
+#if APP_OLED_REAR_PANEL
+    ssd1306_InitPanel(&rear_panel);   // Stays blank if no panel answers at 0x3D
+    ssd1306_Select(NULL);
+#endif
+}
+#endif
+
+#if APP_IO_BENCH
+/*******************************************************************************
+ * Hot-path I/O cost in DWT cycles for the selected backend. Runs before the
+ * buzzer cadence takes TIM1 over; every operation leaves the pins and
+ * timers as it found them.
+ ******************************************************************************/
+typedef enum {
+    IO_BENCH_PIN_WRITE = 0,            /**< Trigger pin set + reset */
+    IO_BENCH_PIN_READ,                 /**< Echo pin read */
+    IO_BENCH_PWM_TOGGLE,               /**< Buzzer stop + start, both channels */
+    IO_BENCH_DELAY_10US,               /**< delay_us(10) */
+    IO_BENCH_TRIGGER,                  /**< HCSR04_Trigger() (12 us of delays) */
+    IO_BENCH_COUNT
+} io_bench_t;
+
+#define IO_BENCH_RUNS          16U
+
+static uint32_t io_bench_cycles[IO_BENCH_COUNT];  /**< Mean cost [cycles] */
+
+static void IO_Bench(void) {
+    volatile GPIO_PinState level;
+
+    for (uint32_t op = 0; op < IO_BENCH_COUNT; op++) {
+        uint32_t t0 = DWT->CYCCNT;
+        for (uint32_t i = 0; i < IO_BENCH_RUNS; i++) {
+            switch ((io_bench_t)op) {
+            case IO_BENCH_PIN_WRITE:
+                IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_SET);
+                IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_RESET);
+                break;
+            case IO_BENCH_PIN_READ:
+                level = IO_PinRead(HS_SR04_ECHO_PORT, HS_SR04_ECHO_PIN);
+                break;
+            case IO_BENCH_PWM_TOGGLE:
+                IO_PwmStop(&htim1, TIM_CHANNEL_1);
+                IO_PwmStop(&htim1, TIM_CHANNEL_4);
+                IO_PwmStart(&htim1, TIM_CHANNEL_1);
+                IO_PwmStart(&htim1, TIM_CHANNEL_4);
+                break;
+            case IO_BENCH_DELAY_10US:
+                delay_us(10);
+                break;
+            default:
+                HCSR04_Trigger();
+                break;
+            }
+        }
+        io_bench_cycles[op] = (DWT->CYCCNT - t0) / IO_BENCH_RUNS;
+    }
+    (void)level;
+}
+
+static void IO_BenchReport(void) {
+    static const char *const names[IO_BENCH_COUNT] = {
+        "pin w+w", "pin read", "pwm toggle", "delay 10us", "trigger"
+    };
+
+    for (uint32_t op = 0; op < IO_BENCH_COUNT; op++) {
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "IO %-10s %lu cyc (%s)\r\n",
+                                names[op], (unsigned long)io_bench_cycles[op],
+                                APP_FAST_IO ? "reg" : "HAL");
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+}
+#endif
+
+#if APP_IRQ_SELFTEST
+/*******************************************************************************
+ * Interrupt entry latency of the priority plan, one summary line and the
+ * non-empty histogram bins ("lower edge:count") per row, in DWT cycles.
+ ******************************************************************************/
+static void IrqTest_Report(void) {
+    static irqtest_row_t rows[IRQTEST_ROWS];
+
+    irqtest_run(rows);
+    for (uint32_t r = 0; r < IRQTEST_ROWS; r++) {
+        const irqtest_row_t *row = &rows[r];
+        uint32_t mean = row->count ? row->sum / row->count : 0U;
+
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                                "IRQ %-10s p%-2u %-4s n:%lu miss:%lu min:%lu mean:%lu p50:%lu p99:%lu max:%lu jit:%lu\r\n",
+                                row->name, (unsigned)row->prio, row->via,
+                                (unsigned long)row->count, (unsigned long)row->missed,
+                                (unsigned long)row->min, (unsigned long)mean,
+                                (unsigned long)irqtest_percentile(row, 50U),
+                                (unsigned long)irqtest_percentile(row, 99U), (unsigned long)row->max,
+                                (unsigned long)(row->max - row->min));
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+
+        /* As many bins per line as fit the buffer */
+        uint32_t bin = 0;
+        while (bin < IRQTEST_BINS) {
+            int len = snprintf(uart_buffer, sizeof(uart_buffer), "IRQH %-10s", row->name);
+            uint32_t shown = 0;
+            for (; bin < IRQTEST_BINS && len < (int)sizeof(uart_buffer) - 16; bin++) {
+                if (row->hist[bin] != 0U) {
+                    len += snprintf(uart_buffer + len, sizeof(uart_buffer) - len, " %lu:%u",
+                                    (unsigned long)(bin * IRQTEST_BIN_CYCLES), (unsigned)row->hist[bin]);
+                    shown++;
+                }
+            }
+            if (shown != 0U) {
+                len += snprintf(uart_buffer + len, sizeof(uart_buffer) - len, "\r\n");
+                MX_USART2_Write((uint8_t*)uart_buffer, (uint16_t)len);
+            }
+        }
+    }
+}
+#endif
+
+#if APP_PING_JITTER
+static void Ping_JitterInit(void);
+#endif
+
+/*******************************************************************************
+ * System Initialization: sensor path first, then buzzer, then the rest
  ******************************************************************************/
 static void System_Init(void) {
     HAL_Init();
     SystemClock_Config();
+    SystemClock_CycleCounterInit();
 
     MX_GPIO_Init();
-    MX_USART2_UART_Init();
+    MX_DMA_Init();
     MX_TIM2_Init();
-    MX_TIM3_Init();
+    timebase_init();
+    boot_base_us = HAL_GetTick() * 1000U;
+
+    if (HCSR04_Init() != HAL_OK) {
+        Error_Handler();
+    }
+#if APP_PING_JITTER
+    Ping_JitterInit();
+#endif
+    Boot_Mark(BOOT_SENSOR);
+
     MX_TIM1_Init();
+    MX_TIM4_Init();
+#if APP_IO_BENCH
+    IO_Bench();
+#endif
+#if APP_BUZZER_HW_CADENCE
+    if (Buzzer_HwCadence_Init() != HAL_OK) {
+        Error_Handler();
+    }
+#endif
+#if APP_BUZZER_PATTERNS
+    Buzzer_Pattern_Play(&buzzer_pattern_chirp);
+#endif
+    Boot_Mark(BOOT_BUZZER);
+
+    MX_USART2_UART_Init();
+#if APP_IRQ_SELFTEST
+    IrqTest_Report();
+#endif
+    pipeline_init(&pipe, timebase_now_ms());
+#if APP_LATENCY
+    latency_init(&latency[LATENCY_OUT_BUZZER], APP_LATENCY_BUZZER_RANGE_US);
+    latency_init(&latency[LATENCY_OUT_DASH], APP_LATENCY_DISPLAY_RANGE_US);
+    latency_init(&latency[LATENCY_OUT_REAR], APP_LATENCY_DISPLAY_RANGE_US);
+#endif
+#if APP_CALIBRATION
+    calib_identity(&calib);
+    calib_load(&calib);               /* Uncalibrated if the page is empty */
+#endif
+#if APP_COMMANDS
+    MX_USART2_StartRx();
+#endif
     MX_I2C2_Init();
+    i2c_bus_init(&i2c2_bus, &hi2c2);
+    Boot_Mark(BOOT_PERIPH);
+#if APP_IO_BENCH
+    IO_BenchReport();
+#endif
 
-    ssd1306_Init();
-    ssd1306_Fill(Black);
-    ssd1306_UpdateScreen();
+#if !APP_FAST_BOOT
+    Display_Init();
+#endif
+}
 
-    if (HCSR04_Init() != HAL_OK) {
-        Error_Handler();
+/*******************************************************************************
+ * Dashboard widgets. Nothing is drawn here; ui_commit() in the main loop
+ * renders whatever changed and sends it once per loop.
+ ******************************************************************************/
+static void Dashboard_Init(void) {
+    ui_widget_t *w = dash_widgets;
+
+    ui_label_init(&w[DASH_W_LABEL], (ui_rect_t){ 0, 0, DASH_VALUE_X - 1, DASH_ROW_H },
+                  &Font_7x10, UI_ALIGN_RIGHT, "Dist:");
+    ui_value_init(&w[DASH_W_VALUE], DASH_VALUE_X, (DASH_ROW_H - Font_7x10.height) / 2,
+                  &dash_glyphs, DASH_FIELD_LEN, 2);
+    /* The unit follows the digit cells of the glyph cache */
+    const ui_rect_t *value = &w[DASH_W_VALUE].box;
+    ui_label_init(&w[DASH_W_UNIT], (ui_rect_t){ value->x + value->w + 4, 0,
+                                                ui_text_width(&Font_7x10, "cm"), DASH_ROW_H },
+                  &Font_7x10, UI_ALIGN_LEFT, "cm");
+    ui_icon_init(&w[DASH_W_BUZZER], (ui_rect_t){ SSD1306_WIDTH - 8, 4, 8, 8 }, icon_bell);
+    ui_label_init(&w[DASH_W_MESSAGE], (ui_rect_t){ 0, 0, SSD1306_WIDTH, DASH_ROW_H },
+                  &Font_7x10, UI_ALIGN_CENTER, "");
+    ui_bar_init(&w[DASH_W_BAR], (ui_rect_t){ 0, DASH_BAR_Y, SSD1306_WIDTH, 8 }, APP_OLED_BAR_RANGE_CM);
+#if APP_OLED_GRAPH
+    char scale[8];
+    snprintf(scale, sizeof(scale), "%dm", APP_OLED_GRAPH_FULL_SCALE_CM / 100);
+
+    ui_label_init(&w[DASH_W_SCALE_TOP], (ui_rect_t){ 0, DASH_GRAPH_Y, DASH_GRAPH_X - 2, 8 },
+                  &Font_6x8, UI_ALIGN_LEFT, scale);
+    ui_label_init(&w[DASH_W_SCALE_ZERO], (ui_rect_t){ 0, SSD1306_HEIGHT - 8, DASH_GRAPH_X - 2, 8 },
+                  &Font_6x8, UI_ALIGN_LEFT, "0");
+    ui_graph_init(&w[DASH_W_GRAPH],
+                  (ui_rect_t){ DASH_GRAPH_X, DASH_GRAPH_Y, SSD1306_WIDTH - DASH_GRAPH_X, SSD1306_HEIGHT - DASH_GRAPH_Y },
+                  APP_OLED_GRAPH_FULL_SCALE_CM);
+#endif
+
+    ssd1306_Fill(Black);   /* The boot reports may have left a full screen */
+    ui_screen_init(&dash_ui, dash_widgets, DASH_W_COUNT);
+}
+
+/* Readout row shows either label/value/unit or one line of text */
+static void Dashboard_ShowReadout(bool readout) {
+    ui_set_visible(&dash_widgets[DASH_W_LABEL], readout);
+    ui_set_visible(&dash_widgets[DASH_W_VALUE], readout);
+    ui_set_visible(&dash_widgets[DASH_W_UNIT], readout);
+    ui_set_visible(&dash_widgets[DASH_W_MESSAGE], !readout);
+    if (!readout) {
+        ui_set_visible(&dash_widgets[DASH_W_BUZZER], false);
+    }
+}
+
+static void Dashboard_ShowMessage(const char *msg) {
+    if (!display_ready) {
+        return;
     }
+    ui_label_set(&dash_widgets[DASH_W_MESSAGE], msg);
+    Dashboard_ShowReadout(false);
+    ui_bar_set(&dash_widgets[DASH_W_BAR], 0);
+}
+
+/*******************************************************************************
+ * Panels are initialized: run the boot reports and set up the dashboard
+ ******************************************************************************/
+#if APP_OLED_FPS_REPORT
+static void Oled_FpsReport(void);
+#endif
+#if APP_OLED_GFX_BENCH
+static void Oled_GfxBenchReport(void);
+#endif
+
+static void Display_Start(void) {
+    static bool reported = false;   /* Not again after a bus recovery */
 
-    HAL_TIM_Base_Start(&htim2);
-    HAL_TIM_Base_Start(&htim3);
+    if (!reported) {
+        reported = true;
+#if APP_OLED_FPS_REPORT
+        Oled_FpsReport();
+#endif
+#if APP_OLED_GFX_BENCH
+        Oled_GfxBenchReport();
+#endif
+    }
+    Dashboard_Init();    /* After the boot reports, which draw full screens */
+#if APP_OLED_REAR_PANEL
+    rear_text[0] = '\0';  /* Panel was (re)initialized blank */
+#endif
+#if APP_LATENCY
+    /* Changes decided before a bus recovery are not the redraw's latency */
+    (void)latency_take(&latency[LATENCY_OUT_DASH]);
+    (void)latency_take(&latency[LATENCY_OUT_REAR]);
+#endif
+    display_ready = true;
 }
 
 /*******************************************************************************
- * Display message on OLED and UART
+ * Deferred display bring-up. Never waits: the dashboard init is queued as
+ * soon as the panel has powered up, the glyph cache is built while it is
+ * on the bus, and the rear panel is queued once the bus is free again.
+ * A panel that does not answer is retried every APP_OLED_RETRY_MS.
  ******************************************************************************/
-static void Show_Message(const char *msg) {
-    /* Clear OLED display */
-    ssd1306_Fill(Black);
+static void Display_BootStep(void) {
+    switch (oled_boot) {
+    case OLED_BOOT_POWER_UP:
+        if (!ssd1306_IsPoweredUp() || (int32_t)(timebase_now_ms() - oled_retry_at) < 0) {
+            return;
+        }
+        Boot_Mark(BOOT_OLED_START);
+        if (ssd1306_InitAsync() != INITIALIZED_OLED_INIT_SUCCESSFULLY) {
+            oled_retry_at = timebase_now_ms() + APP_OLED_RETRY_MS;
+            return;
+        }
+        ssd1306_GlyphCacheInit(&dash_glyphs, &Font_7x10, DASH_GLYPHS);
+        oled_boot = OLED_BOOT_DASH;
+        break;
 
-    /* Compute horizontal centering */
-    uint8_t str_len = strlen(msg);
-    uint8_t oled_width = 128;      // OLED width in pixels
-    uint8_t char_width = 7;        // Font_7x10 character width
-    uint8_t x_pos = (oled_width - (str_len * char_width)) / 2;
+    case OLED_BOOT_DASH:
+        if (ssd1306_IsBusy()) {
+            return;
+        }
+        Boot_Mark(BOOT_OLED_READY);
+#if APP_OLED_REAR_PANEL
+        ssd1306_InitPanelAsync(&rear_panel);   // Stays blank if no panel answers at 0x3D
+        ssd1306_Select(NULL);
+#endif
+        Display_Start();
+        oled_boot = OLED_BOOT_DONE;
+        break;
 
-    /* Vertical centering for single line */
-    uint8_t oled_height = 64;      // OLED height in pixels
-    uint8_t char_height = 10;      // Font_7x10 character height
-    uint8_t y_pos = (oled_height - char_height) / 2;
+    default:
+        break;
+    }
+}
 
-    /* Set cursor and write string */
-    ssd1306_SetCursor(x_pos, y_pos);
-    ssd1306_WriteString((char*)msg, Font_7x10, White);
-    ssd1306_UpdateScreen();
+/*******************************************************************************
+ * I2C2 fault handling. A bus error or a missed deadline stops the display
+ * (its writes fail fast meanwhile), the bus is recovered here in the main
+ * loop and both panels are initialized again by Display_BootStep. The
+ * sensing and buzzer paths never wait on the display.
+ ******************************************************************************/
+static void Display_Service(void) {
+#if APP_BUS_FAULT_INJECT_MS
+    if (timebase_now_ms() - last_fault_inject >= APP_BUS_FAULT_INJECT_MS) {
+        last_fault_inject = timebase_now_ms();
+        MX_I2C2_InjectFault();
+    }
+#endif
+    if (!MX_I2C2_RecoveryPending()) {
+        return;
+    }
+
+    display_ready = false;
+    ssd1306_AbortBus(&hi2c2);         /* Drops the frames and everything else on I2C2 */
+    MX_I2C2_Recover();
+    oled_retry_at = timebase_now_ms() + APP_OLED_RETRY_MS;
+    oled_boot = OLED_BOOT_POWER_UP;
+}
+
+/* Failed transfers and bus wait timeouts (may run from the I2C ISR) */
+void i2c_bus_on_error(i2c_bus_t *bus, uint32_t error) {
+    if (bus == &i2c2_bus) {
+        MX_I2C2_ReportError(error);
+    }
+}
+
+/*******************************************************************************
+ * Main loop time: last, longest per report window, longest since boot
+ ******************************************************************************/
+static void Loop_Account(uint32_t start_us) {
+    loop_last_us = timebase_now32() - start_us;
+    if (loop_last_us > loop_max_us) {
+        loop_max_us = loop_last_us;
+    }
+    if (loop_last_us > loop_worst_us) {
+        loop_worst_us = loop_last_us;
+    }
+}
+
+/*******************************************************************************
+ * Display message on OLED and UART (OLED only with APP_OCCUPANCY: the UART
+ * carries the BAY event lines, and this runs on every loop pass)
+ ******************************************************************************/
+static void Show_Message(const char *msg) {
+    Dashboard_ShowMessage(msg);
 
+#if !APP_OCCUPANCY
     /* UART transmission */
     uart_mes_len = sprintf(uart_buffer, "%s\r\n", msg);
-    HAL_UART_Transmit(&huart2, (uint8_t*)uart_buffer, uart_mes_len, HAL_MAX_DELAY);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+#endif
 }
 
 
+#if APP_OLED_GRAPH
 /*******************************************************************************
- * Update OLED and UART with distance
+ * Add the latest distance to the graph (one scrolled column per sample,
+ * pushed by the next commit)
  ******************************************************************************/
-static void Display_Update(float distance) {
+static void Graph_Update(float distance, const policy_entry_t *policy) {
+    uint32_t now = timebase_now_ms();
+
+    if (!display_ready || now - last_graph_sample < APP_OLED_GRAPH_SAMPLE_MS) {
+        return;
+    }
+    last_graph_sample = now;
+
+    bool valid = (policy->zone != POLICY_ZONE_INVALID) && (distance >= 0.0f);
+    int32_t sample = valid ? (int32_t)distance : -1;
+#if APP_OCCUPANCY
+    /* Event mode: the plot only moves with the readout */
+    static int32_t last_sample = -2;
+    if (sample == last_sample) {
+        return;
+    }
+    last_sample = sample;
+#endif
+    ui_graph_push(&dash_widgets[DASH_W_GRAPH], sample);
+}
+#endif
+
+#if APP_OLED_REAR_PANEL
+/*******************************************************************************
+ * Large distance readout on the rear panel
+ ******************************************************************************/
+static void Rear_Update(float distance, const policy_entry_t *policy) {
+    char oled_buffer[16];
+    bool valid = (policy->style == POLICY_STYLE_DISTANCE) && pipe.valid;
+
+    if (valid) {
+        snprintf(oled_buffer, sizeof(oled_buffer), "%d cm", (int)distance);
+    } else {
+        snprintf(oled_buffer, sizeof(oled_buffer), "-- cm");
+    }
+    if (strcmp(oled_buffer, rear_text) == 0) {
+        return;                          /* Same frame as on the panel */
+    }
+    strcpy(rear_text, oled_buffer);
+
+    ssd1306_Select(&rear_panel);
+#if APP_LATENCY
+    latency_decide(&latency[LATENCY_OUT_REAR], valid ? (uint32_t)distance : LATENCY_KEY_INVALID, pipe.capture_us);
+    ssd1306_TagFrame(latency_take(&latency[LATENCY_OUT_REAR]));
+#endif
+    ssd1306_BeginFrame();
+    ssd1306_Fill(Black);
+
+    /* Centre one line of Font_11x18 */
+    uint16_t width = ui_text_width(&Font_11x18, oled_buffer);
+    uint8_t x_pos = (width < SSD1306_WIDTH) ? (SSD1306_WIDTH - width) / 2 : 0;
+    uint8_t y_pos = (SSD1306_HEIGHT - Font_11x18.height) / 2;
+
+    ssd1306_SetCursor(x_pos, y_pos);
+    ssd1306_WriteString(oled_buffer, Font_11x18, White);
+    ssd1306_Present();   /* Queued behind the dashboard frame on I2C2 */
+    ssd1306_Select(NULL);
+}
+#endif
+
+/*******************************************************************************
+ * Update the dashboard widgets and UART with distance
+ ******************************************************************************/
+static void Display_Update(float distance, const policy_entry_t *policy) {
     char oled_buffer[32];
     int int_part = (int)distance;
     int frac_part = (int)((distance - int_part) * 100);
+    bool valid = (policy->style == POLICY_STYLE_DISTANCE) && pipe.valid;
 
-    if ((distance >= 2.5f && distance <= 40.0f) && (echo_state == VALIDATE_MEASURE)) {
+    if (valid) {
         snprintf(oled_buffer, sizeof(oled_buffer), "Dist: %d.%02d cm", int_part, frac_part);
     } else {
         snprintf(oled_buffer, sizeof(oled_buffer), "Distance: Invalid");
     }
+#if APP_LATENCY
+    if (display_ready) {
+        latency_decide(&latency[LATENCY_OUT_DASH],
+                       valid ? (uint32_t)(int_part * 100 + frac_part) : LATENCY_KEY_INVALID, pipe.capture_us);
+    }
+#endif
 
-    /* Clear display */
-    ssd1306_Fill(Black);
-
-    /* Compute horizontal centering */
-    uint8_t str_len = strlen(oled_buffer);
-    uint8_t oled_width = 128;      // OLED width in pixels
-    uint8_t char_width = 7;        // Font_7x10 width
-    uint8_t x_pos = (oled_width - (str_len * char_width)) / 2;
-
-    /* Vertical centering for 1 line */
-    uint8_t oled_height = 64;      // OLED height in pixels
-    uint8_t char_height = 10;      // Font_7x10 height
-    uint8_t y_pos = (oled_height - char_height) / 2;
-
-    ssd1306_SetCursor(x_pos, y_pos);
-    ssd1306_WriteString(oled_buffer, Font_7x10, White);
-    ssd1306_UpdateScreen();
+    if (valid && display_ready) {
+        ui_value_set(&dash_widgets[DASH_W_VALUE], int_part * 100 + frac_part);
+        ui_bar_set(&dash_widgets[DASH_W_BAR], APP_OLED_BAR_RANGE_CM - int_part);
+        Dashboard_ShowReadout(true);
+        ui_set_visible(&dash_widgets[DASH_W_BUZZER], buzzer_on);
+    } else if (!valid) {
+        Dashboard_ShowMessage(oled_buffer);
+    }
 
+#if !APP_OCCUPANCY
     /* UART output remains the same */
     uart_mes_len = sprintf(uart_buffer, "%s\r\n", oled_buffer);
-    HAL_UART_Transmit(&huart2, (uint8_t*)uart_buffer, uart_mes_len, HAL_MAX_DELAY);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+#endif
 }
+#if !APP_BUZZER_HW_CADENCE
 /*******************************************************************************
  * Configure and start buzzer PWM signal
  * @param freq Frequency of the buzzer tone in Hz
@@ -189,8 +762,8 @@ static void Buzzer_Start(uint32_t freq) {
     __HAL_TIM_SET_COUNTER(&htim1, 0);
 
     /* Start PWM */
-    HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
-    HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_4);
+    IO_PwmStart(&htim1, TIM_CHANNEL_1);
+    IO_PwmStart(&htim1, TIM_CHANNEL_4);
 
     buzzer_on = true;
 }
@@ -199,32 +772,80 @@ static void Buzzer_Start(uint32_t freq) {
  * Stop buzzer PWM signal
  ******************************************************************************/
 static void Buzzer_Stop(void) {
-    HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_1);
-    HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_4);
+    IO_PwmStop(&htim1, TIM_CHANNEL_1);
+    IO_PwmStop(&htim1, TIM_CHANNEL_4);
 
     buzzer_on = false;
 }
+#endif /* !APP_BUZZER_HW_CADENCE */
 
+#if APP_BUZZER_HW_CADENCE
 /*******************************************************************************
- * Control buzzer behavior based on distance
+ * Apply a policy to the hardware cadence, touching timer registers only when
+ * the tone or cadence changes
+ * @param policy Policy entry for the current echo
  ******************************************************************************/
-static void Buzzer_Control(float distance) {
-    if (distance < 0) {
+static void Buzzer_SetZone(const policy_entry_t *policy) {
+    if (policy->cadence_ms == buzzer_cadence && policy->tone_hz == buzzer_tone) {
+        return;
+    }
+    buzzer_cadence = policy->cadence_ms;
+    buzzer_tone    = policy->tone_hz;
+
+#if APP_BUZZER_PATTERNS
+    Buzzer_Pattern_Stop();
+
+    if (buzzer_cadence == POLICY_CADENCE_CONTINUOUS) {
+        /* Contact zone → looped two-tone alarm instead of a steady tone */
+        buzzer_on = (Buzzer_Pattern_Play(&buzzer_pattern_alarm) == HAL_OK);
+        return;
+    }
+#endif
+
+    if (buzzer_cadence == POLICY_CADENCE_SILENT || buzzer_tone == 0) {
+        Buzzer_HwCadence_Off();
+        buzzer_on = false;
+    } else if (buzzer_cadence == POLICY_CADENCE_CONTINUOUS) {
+        Buzzer_HwCadence_Set(buzzer_tone, BUZZER_CADENCE_CONTINUOUS, BUZZER_CONTINUOUS_PERIOD_MS);
+        buzzer_on = true;
+    } else {
+        /* Beep for one interval, stay silent for the next one */
+        Buzzer_HwCadence_Set(buzzer_tone, buzzer_cadence, 2 * buzzer_cadence);
+        buzzer_on = true;
+    }
+}
+
+/*******************************************************************************
+ * Control buzzer behavior from the distance policy (hardware cadence)
+ ******************************************************************************/
+static void Buzzer_Control(const policy_entry_t *policy) {
+    Buzzer_SetZone(policy);
+
+    if (policy->zone == POLICY_ZONE_INVALID) {
+        Show_Message("Distance: Invalid");
+    }
+}
+#else
+/*******************************************************************************
+ * Control buzzer behavior from the distance policy
+ ******************************************************************************/
+static void Buzzer_Control(const policy_entry_t *policy) {
+    if (policy->zone == POLICY_ZONE_INVALID) {
         /* Invalid distance → stop buzzer */
         Buzzer_Stop();
         Show_Message("Distance: Invalid");
         return;
     }
 
-    if (distance < 2.5f) {
+    if (policy->cadence_ms == POLICY_CADENCE_CONTINUOUS) {
         /* Always ON for very close objects */
         if (!buzzer_on) {
-            Buzzer_Start(2000);
+            Buzzer_Start(policy->tone_hz);
         }
         return;
     }
 
-    if (distance >= 40.0f) {
+    if (policy->cadence_ms == POLICY_CADENCE_SILENT) {
         /* Always OFF for distant objects */
         if (buzzer_on) {
             Buzzer_Stop();
@@ -232,64 +853,725 @@ static void Buzzer_Control(float distance) {
         return;
     }
 
-    /* Scale toggle interval between 2.5 cm and 40 cm */
-    float scale = (distance - 2.5f) / (40.0f - 2.5f);
-    if (scale < 0.0f) scale = 0.0f;
-    if (scale > 1.0f) scale = 1.0f;
-
-    /* Compute toggle interval based on distance */
-    uint32_t buzzer_interval = interval_min + (uint32_t)(scale * (interval_max - interval_min));
-    uint32_t now = HAL_GetTick();
+    uint32_t now = timebase_now_ms();
 
     /* Toggle buzzer if interval elapsed */
-    if (now - last_buzzer_toggle >= buzzer_interval) {
+    if (now - last_buzzer_toggle >= policy->cadence_ms) {
         last_buzzer_toggle = now;
 
         if (buzzer_on) {
             Buzzer_Stop();
         } else {
-            Buzzer_Start(2000);
+            Buzzer_Start(policy->tone_hz);
+        }
+    }
+}
+#endif /* APP_BUZZER_HW_CADENCE */
+
+#if APP_PING_JITTER
+/*******************************************************************************
+ * Ping jitter: seeded per unit, so that sensors with the same firmware
+ * never run in step, and never twice the same offset in a row
+ ******************************************************************************/
+static void Ping_JitterInit(void) {
+    ping_rng = HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2() ^ DWT->CYCCNT;
+    if (ping_rng == 0) {
+        ping_rng = 0x2545F491U;     /* xorshift must not start at 0 */
+    }
+    HCSR04_SetConfirm(true);
+}
+
+static uint32_t Ping_Jitter(void) {
+    uint32_t offset;
+
+    do {
+        ping_rng ^= ping_rng << 13;
+        ping_rng ^= ping_rng >> 17;
+        ping_rng ^= ping_rng << 5;
+        offset = ping_rng % (APP_PING_JITTER_US + 1U);
+    } while ((offset > ping_offset_us ? offset - ping_offset_us : ping_offset_us - offset) <
+             APP_PING_JITTER_STEP_US);
+
+    ping_offset_us = offset;
+    return offset;
+}
+#endif
+
+/*******************************************************************************
+ * Ping the HC-SR04 when it is due and wait for the validated result in
+ * echo_result. Returns false if no ping went out in this pass.
+ ******************************************************************************/
+static bool Measure_Echo(void) {
+    if (timebase_expired(next_ping_us)) {
+        next_ping_us = timebase_now_us() + measure_interval * 1000U;
+
+#if APP_CLOCK_SCALING
+        /* Only waiting for the echo from here on → run from MSI.
+         * TIM1 takes the new prescaler at its next update: the cadence
+         * gate can hold that off for a whole silent interval, at 5x or
+         * 1/5 the pitch, and a reload would skip a pattern step. Stay at
+         * full speed while the buzzer sounds. */
+#if APP_BUZZER_HW_CADENCE
+        bool sounding = buzzer_on;
+#if APP_BUZZER_PATTERNS
+        sounding = sounding || Buzzer_Pattern_IsPlaying();
+#endif
+        if (!sounding)
+#endif
+        {
+            SystemClock_SetProfile(SYSCLK_PROFILE_LOW);
+        }
+        measurement_count++;
+#endif
+
+        uint32_t ping_us = timebase_now32();
+#if APP_PING_JITTER
+        HCSR04_SetPingOffset(ping_offset_us);
+#endif
+        timer_tick_t trigger_us = HCSR04_Trigger();
+#if APP_TRACE
+#if APP_PING_JITTER
+        trace_put(TRACE_PING, trigger_us, (uint16_t)ping_offset_us, 0);
+#else
+        trace_put(TRACE_PING, trigger_us, 0, 0);
+#endif
+#else
+        (void)trigger_us;
+#endif
+
+        timebase_us_t timeout = timebase_deadline_us(HS_SR04_ECHO_TIMEOUT_US);
+        bool timed_out = false;
+        while (!HCSR04_PollEcho(&echo_result, timed_out)) {
+            timed_out = timebase_expired(timeout);
+        }
+        uint32_t done_us32 = timebase_now32();
+        echo_latency_us = done_us32 - ping_us;
+#if APP_TRACE
+        trace_put(TRACE_DONE, done_us32, (uint16_t)echo_result.echo_us,
+                  (uint8_t)(echo_result.reason | (timed_out ? TRACE_DONE_TIMED_OUT : 0U)));
+#endif
+#if APP_PING_JITTER
+        /* The echo wait usually outlasts the interval: jitter from its end */
+        timebase_us_t done_us = timebase_now_us();
+        if (done_us > next_ping_us) {
+            next_ping_us = done_us;
+        }
+        next_ping_us += Ping_Jitter();
+#endif
+
+#if APP_CLOCK_SCALING
+        /* Back to full speed for filtering and display rendering */
+        SystemClock_SetProfile(SYSCLK_PROFILE_FULL);
+#endif
+        return true;
+    }
+    return false;
+}
+
+#if APP_CALIBRATION
+/*******************************************************************************
+ * Calibration over UART. "cal <cm>" averages the next APP_CALIB_SAMPLES
+ * raw echoes into a reference for a target at that distance, "cal fit"
+ * applies the fitted table (RAM only), "cal save" keeps it over resets,
+ * "cal reset" goes back to uncalibrated, "cal show" lists the state.
+ ******************************************************************************/
+static void Cal_Print(const char *msg) {
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "CAL %s\r\n", msg);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+
+static void Cal_Show(void) {
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "CAL table refs:%u, %lu new refs\r\n",
+                            (unsigned)calib.refs, (unsigned long)cal_ref_count);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+
+    for (uint32_t i = 0; i < cal_ref_count; i++) {
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "CAL ref %lu: %luus -> %luus (%lucm)\r\n",
+                                (unsigned long)i, (unsigned long)cal_refs[i].raw_us,
+                                (unsigned long)cal_refs[i].true_us,
+                                (unsigned long)(POLICY_ECHO_TO_CM100(cal_refs[i].true_us) / 100U));
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+}
+
+static void Cal_Command(const char *arg) {
+    if (strcmp(arg, "fit") == 0) {
+        Cal_Print(calib_fit(&calib, cal_refs, cal_ref_count) ? "fitted" : "fit failed");
+    } else if (strcmp(arg, "save") == 0) {
+        Cal_Print(calib_store(&calib) ? "saved" : "save failed");
+    } else if (strcmp(arg, "reset") == 0) {
+        calib_identity(&calib);
+        cal_ref_count = 0;
+        Cal_Print(calib_erase() ? "reset" : "erase failed");
+    } else if (strcmp(arg, "show") == 0) {
+        Cal_Show();
+    } else {
+        char *end;
+        long cm = strtol(arg, &end, 10);
+
+        if ((end == arg) || (*end != '\0') || (cm < 2) || (cm > 400)) {
+            Cal_Print("target 2..400 cm");
+        } else if (cal_ref_count >= CALIB_MAX_REFS) {
+            Cal_Print("too many refs, cal reset");
+        } else {
+            cal_target_cm = (uint32_t)cm;
+            cal_sum_us    = 0;
+            cal_samples   = 0;
+        }
+    }
+}
+
+/* Reference sampling, once per loop */
+static void Cal_Service(void) {
+    if ((cal_target_cm == 0) || !pipe.fresh) {
+        return;
+    }
+    cal_sum_us += pipe.raw_us;
+    if (++cal_samples < APP_CALIB_SAMPLES) {
+        return;
+    }
+
+    cal_refs[cal_ref_count].raw_us  = (cal_sum_us + APP_CALIB_SAMPLES / 2U) / APP_CALIB_SAMPLES;
+    cal_refs[cal_ref_count].true_us = CALIB_CM100_TO_ECHO(cal_target_cm * 100U);
+    cal_ref_count++;
+    cal_target_cm = 0;
+    Cal_Show();
+}
+#endif
+
+#if APP_OCCUPANCY
+/*******************************************************************************
+ * Bay occupancy events (pipeline_occupancy), one short UART line each, e.g.
+ * "BAY 7 occ d:87 min:85 t:412" (seq, event, parked and closest distance
+ * [cm], time in the last state [s]).
+ ******************************************************************************/
+static void Occupancy_Service(void) {
+    static const char *const events[] = { "free", "occ", "hb" };
+    static const char *const states[] = { "", "/free", "/occ" };
+    occupancy_event_t event;
+
+    if (!pipeline_occupancy(&pipe, timebase_now_ms(), &event)) {
+        return;
+    }
+
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "BAY %u %s%s d:%u min:%u t:%lu\r\n",
+                            (unsigned)event.seq, events[event.type],
+                            (event.type == OCCUPANCY_EVENT_HEARTBEAT) ? states[event.state] : "",
+                            (unsigned)event.distance_cm, (unsigned)event.closest_cm,
+                            (unsigned long)event.duration_s);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+#endif
+
+#if APP_STATS
+/*******************************************************************************
+ * Monitoring summaries: samples go into the windows as they come, a line
+ * per quantity every APP_STATS_INTERVAL_MS. Distances are printed in mm.
+ ******************************************************************************/
+static void Stats_Print(const char *name, const stats_summary_t *sum, float scale) {
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "STAT %s n:%lu min:%ld max:%ld mean:%ld sd:%ld p50:%ld p90:%ld p99:%ld\r\n",
+                            name, (unsigned long)sum->count,
+                            (long)(sum->min * scale), (long)(sum->max * scale),
+                            (long)(sum->mean * scale), (long)(sum->std * scale),
+                            (long)(sum->p50 * scale), (long)(sum->p90 * scale),
+                            (long)(sum->p99 * scale));
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+
+static void Stats_Service(void) {
+    pipeline_stats(&pipe, echo_latency_us);
+
+    uint32_t now = timebase_now_ms();
+    if (now - last_stats_report < APP_STATS_INTERVAL_MS) {
+        return;
+    }
+    last_stats_report = now;
+
+    stats_summary_t sum;
+    stats_publish(&pipe.stats_distance, &sum);
+    Stats_Print("dist[mm]", &sum, 10.0f);
+    stats_publish(&pipe.stats_latency, &sum);
+    Stats_Print("ping[us]", &sum, 1.0f);
+}
+#endif
+
+#if APP_LATENCY
+/*******************************************************************************
+ * End-to-end latency: echo edge (EXTI) to an audible or visible change.
+ * The buzzer reacts in the main loop; a panel when its frame is on the bus,
+ * often in the I2C ISR, so those samples wait in latency_shown_us until the
+ * next pass. A line per output every APP_LATENCY_INTERVAL_MS, e.g.
+ * "LAT dash n:48 p50:2875 p99:3516 max:3602 worst:21344 us".
+ ******************************************************************************/
+/* Hardware cadence: a new tone or cadence is in TIM1 at once. Software
+ * cadence: with the next toggle. */
+static void Latency_Buzzer(const policy_entry_t *policy, bool toggled) {
+    latency_decide(&latency[LATENCY_OUT_BUZZER], LATENCY_KEY_BUZZER(policy), pipe.capture_us);
+#if !APP_BUZZER_HW_CADENCE
+    if (!toggled) {
+        return;
+    }
+#else
+    (void)toggled;
+#endif
+    uint32_t tag = latency_take(&latency[LATENCY_OUT_BUZZER]);
+    if (tag != LATENCY_NONE) {
+        latency_add(&latency[LATENCY_OUT_BUZZER], timebase_now32() - tag);
+    }
+}
+
+static void Latency_Service(void) {
+    static const char *const names[LATENCY_OUT_COUNT] = { "buzzer", "dash", "rear" };
+
+    for (uint32_t out = LATENCY_OUT_DASH; out < LATENCY_OUT_COUNT; out++) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t latency_us = latency_shown_us[out];
+        latency_shown_us[out] = 0;
+        __set_PRIMASK(primask);
+
+        if (latency_us != 0U) {
+            latency_add(&latency[out], latency_us);
+        }
+    }
+
+    uint32_t now = timebase_now_ms();
+    if (now - last_latency_report < APP_LATENCY_INTERVAL_MS) {
+        return;
+    }
+    last_latency_report = now;
+
+    for (uint32_t out = 0; out < LATENCY_OUT_COUNT; out++) {
+#if !APP_OLED_REAR_PANEL
+        if (out == LATENCY_OUT_REAR) {
+            continue;
+        }
+#endif
+        stats_summary_t sum;
+        stats_publish(&latency[out].hist, &sum);
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "LAT %s n:%lu p50:%lu p99:%lu max:%lu worst:%lu us\r\n",
+                                names[out], (unsigned long)sum.count, (unsigned long)sum.p50,
+                                (unsigned long)sum.p99, (unsigned long)sum.max,
+                                (unsigned long)latency[out].worst_us);
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+}
+#endif
+
+#if APP_TRACE
+/*******************************************************************************
+ * Raw ping trace. "trace dump" freezes the recorder and sends it a few
+ * lines per loop pass, so the sensor keeps running meanwhile:
+ *   TR begin <records> <lost>
+ *   TR C <index> <8 calibration offsets [us]>   (per-unit correction)
+ *   TR <P|E|D> <t_us> <value> <flags>           (trace_rec_t, oldest first)
+ *   TR end
+ ******************************************************************************/
+static void Trace_Command(const char *arg) {
+    if (strcmp(arg, "dump") == 0) {
+        trace_freeze(true);
+        trace_dump_next = 0;
+        trace_dumping   = true;
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "TR begin %lu %lu\r\n",
+                                (unsigned long)trace_count(), (unsigned long)trace_lost());
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+#if APP_CALIBRATION
+        for (uint32_t i = 0; i < CALIB_POINTS; i += 8U) {
+            const int16_t *c = &calib.corr_us[i];
+            uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "TR C %lu %d %d %d %d %d %d %d %d\r\n",
+                                    (unsigned long)i, c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]);
+            MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+        }
+#endif
+    } else if (strcmp(arg, "clear") == 0) {
+        trace_clear();
+    }
+}
+
+static void Trace_Service(void) {
+    static const char types[] = { 'P', 'E', 'D' };
+
+    if (!trace_dumping) {
+        return;
+    }
+    for (uint32_t n = 0; (n < APP_TRACE_DUMP_PER_LOOP) && (trace_dump_next < trace_count()); n++) {
+        trace_rec_t rec;
+        trace_get(trace_dump_next++, &rec);
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "TR %c %lu %u %u\r\n",
+                                types[rec.type], (unsigned long)rec.t_us,
+                                (unsigned)rec.value, (unsigned)rec.flags);
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+    if (trace_dump_next >= trace_count()) {
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "TR end\r\n");
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+        trace_dumping = false;
+        trace_freeze(false);
+    }
+}
+#endif
+
+#if APP_COMMANDS
+/*******************************************************************************
+ * UART command lines, dispatched by their first word
+ ******************************************************************************/
+static void Command_Run(const char *line) {
+#if APP_CALIBRATION
+    if (strncmp(line, "cal ", 4) == 0) {
+        Cal_Command(line + 4);
+        return;
+    }
+#endif
+#if APP_TRACE
+    if (strncmp(line, "trace ", 6) == 0) {
+        Trace_Command(line + 6);
+        return;
+    }
+#endif
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "? cal <cm>|fit|save|reset|show, trace dump|clear\r\n");
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+
+static void Command_Service(void) {
+    uint8_t byte;
+
+    while (MX_USART2_Read(&byte)) {
+        if ((byte == '\r') || (byte == '\n')) {
+            if (cmd_line_len != 0) {
+                cmd_line[cmd_line_len] = '\0';
+                cmd_line_len = 0;
+                Command_Run(cmd_line);
+            }
+        } else if (cmd_line_len < sizeof(cmd_line) - 1U) {
+            cmd_line[cmd_line_len++] = (char)byte;
         }
     }
 }
+#endif
 
+#if APP_CLOCK_SCALING
 /*******************************************************************************
- * Measure distance using HC-SR04
+ * Report clock scaling latency and energy estimate over UART
  ******************************************************************************/
-static float Measure_Distance(void) {
-    uint32_t now = HAL_GetTick();
+static void Clock_Report(void) {
+    uint32_t now = timebase_now_ms();
+
+    if (now - last_clock_report < APP_CLOCK_REPORT_INTERVAL_MS) {
+        return;
+    }
+    last_clock_report = now;
+
+    systemclock_stats_t stats;
+    SystemClock_GetStats(&stats);
+
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "CLK sw:%lu up:%lu/%luus down:%lu/%luus E:%luuJ/meas\r\n",
+                            (unsigned long)stats.switches,
+                            (unsigned long)stats.last_latency_us[SYSCLK_PROFILE_FULL],
+                            (unsigned long)stats.max_latency_us[SYSCLK_PROFILE_FULL],
+                            (unsigned long)stats.last_latency_us[SYSCLK_PROFILE_LOW],
+                            (unsigned long)stats.max_latency_us[SYSCLK_PROFILE_LOW],
+                            (unsigned long)(SystemClock_EnergyPerMeasurement_nJ(measurement_count) / 1000U));
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+#endif
+
+/*******************************************************************************
+ * Report display render/transfer overlap over UART
+ ******************************************************************************/
+static void Display_ReportPanel(const char *name) {
+    SSD1306_FrameStats_t stats;
+    ssd1306_GetFrameStats(&stats);
+
+    /* Share of the last transfer hidden behind CPU work */
+    uint32_t hidden_us = (stats.transfer_us > stats.wait_us) ? stats.transfer_us - stats.wait_us : 0;
+    uint32_t overlap   = (stats.transfer_us != 0) ? (hidden_us * 100U) / stats.transfer_us : 0;
+
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "OLED %s fr:%lu rnd:%lu/%luus xfer:%lu/%luus wait:%lu/%luus ovl:%lu%% err:%lu\r\n",
+                            name, (unsigned long)stats.frames,
+                            (unsigned long)stats.render_us, (unsigned long)stats.render_max_us,
+                            (unsigned long)stats.transfer_us, (unsigned long)stats.transfer_max_us,
+                            (unsigned long)stats.wait_us, (unsigned long)stats.wait_max_us,
+                            (unsigned long)overlap, (unsigned long)stats.errors);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+
+/* I2C2 recovery counters, then each device's share of the bus since the
+ * last report */
+static void Bus_Report(uint32_t elapsed_ms) {
+    i2c_bus_stats_t bus;
+    MX_I2C2_GetStats(&bus);
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "I2C2 err:%lu to:%lu rec:%lu stuck:%lu preempt:%lu\r\n",
+                            (unsigned long)bus.errors, (unsigned long)bus.timeouts,
+                            (unsigned long)bus.recoveries, (unsigned long)bus.stuck,
+                            (unsigned long)i2c2_bus.preemptions);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
 
-    if (now - last_distance_measure >= measure_interval) {
-        last_distance_measure = now;
+    for (i2c_dev_t *dev = i2c2_bus.devices; dev != NULL; dev = dev->next) {
+        i2c_dev_stats_t stats;
+        i2c_dev_get_stats(dev, &stats);
+        i2c_dev_clear_stats(dev);
 
-        echo_state = WAITING_RISING_EDGE;
-        HCSR04_Trigger();
+        uint32_t busy = (elapsed_ms != 0) ? stats.busy_us / (elapsed_ms * 10U) : 0;
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                                "I2C2 %s@%02X xf:%lu %luB busy:%lu%% wait:%luus err:%lu\r\n",
+                                dev->name, (unsigned)(dev->address >> 1),
+                                (unsigned long)stats.xfers, (unsigned long)stats.bytes,
+                                (unsigned long)busy, (unsigned long)stats.wait_max_us,
+                                (unsigned long)stats.errors);
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+}
+
+/* Measurements per validation reason since boot, for field diagnostics */
+static void Echo_ReasonReport(const hcsr04_echo_stats_t *echo) {
+    static const char *const names[HCSR04_REASON_COUNT] = {
+        "ok", "to", "unp", "short", "long", "rise", "jump", "unconf", "edge"
+    };
+    int len = snprintf(uart_buffer, sizeof(uart_buffer), "ECHO");
+
+    for (uint32_t i = 0; i < HCSR04_REASON_COUNT && len < (int)sizeof(uart_buffer); i++) {
+        len += snprintf(uart_buffer + len, sizeof(uart_buffer) - len, " %s:%lu",
+                        names[i], (unsigned long)echo->reasons[i]);
+    }
+    if (len > (int)sizeof(uart_buffer) - 3) {
+        len = (int)sizeof(uart_buffer) - 3;
+    }
+    uart_mes_len = len + snprintf(uart_buffer + len, sizeof(uart_buffer) - len, "\r\n");
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+}
+
+static void Display_Report(void) {
+    uint32_t now = timebase_now_ms();
+
+    if (now - last_display_report < APP_DISPLAY_REPORT_INTERVAL_MS) {
+        return;
+    }
+    uint32_t elapsed_ms = now - last_display_report;
+    last_display_report = now;
+
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "LOOP %lu/%lu/%luus echo irq:%lu/%lucyc UART drop:%lu\r\n",
+                            (unsigned long)loop_last_us, (unsigned long)loop_max_us,
+                            (unsigned long)loop_worst_us,
+                            (unsigned long)echo_irq_last_cycles, (unsigned long)echo_irq_max_cycles,
+                            (unsigned long)MX_USART2_GetDrops());
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    loop_max_us = 0;
 
-        timer_tick_t timeout = now + 20;  
-        float dist = -1.0f;
+    hcsr04_echo_stats_t echo;
+    HCSR04_GetEchoStats(&echo);
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "ECHO rec:%lu drop:%lu stale:%lu acc:%lu false:%lu conf:%u%%\r\n",
+                            (unsigned long)echo.records, (unsigned long)echo.dropped,
+                            (unsigned long)echo.stale, (unsigned long)echo.accepted,
+                            (unsigned long)echo.false_accepts, (unsigned)echo_result.confidence);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    Echo_ReasonReport(&echo);
+    Bus_Report(elapsed_ms);
 
-        while(HAL_GetTick() < timeout) {
-            dist = HCSR04_measure_distance_cm();
-            if(dist >= 0)
-                return dist;
+    Display_ReportPanel("dash");
+    uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                            "UI commits:%lu widgets:%lu win:%luB dma:%lu pages\r\n",
+                            (unsigned long)dash_ui.stats.commits, (unsigned long)dash_ui.stats.renders,
+                            (unsigned long)dash_ui.stats.sync_bytes, (unsigned long)dash_ui.stats.dma_pages);
+    MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+#if APP_OLED_REAR_PANEL
+    ssd1306_Select(&rear_panel);
+    Display_ReportPanel("rear");
+    ssd1306_Select(NULL);
+#endif
+}
+
+/*******************************************************************************
+ * Report boot milestones once, when the display is up and the buzzer has
+ * followed a first distance (or after APP_BOOT_REPORT_TIMEOUT_MS)
+ ******************************************************************************/
+static void Boot_Report(void) {
+    static const char *const names[BOOT_MILESTONES] = {
+        "sensor", "buzzer", "periph", "first echo", "first buzz", "oled start", "oled ready"
+    };
+
+    if (boot_reported || !(boot_marked & (1U << BOOT_OLED_READY))) {
+        return;
+    }
+    if (!(boot_marked & (1U << BOOT_FIRST_BUZZ)) && timebase_now_ms() < APP_BOOT_REPORT_TIMEOUT_MS) {
+        return;
+    }
+    boot_reported = true;
+
+    for (uint32_t i = 0; i < BOOT_MILESTONES; i++) {
+        if (boot_marked & (1U << i)) {
+            uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "BOOT %-10s %lu us\r\n",
+                                    names[i], (unsigned long)boot_us[i]);
+        } else {
+            uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "BOOT %-10s -\r\n", names[i]);
         }
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
     }
-    return distance; /* Return last known distance */
 }
 
+#if APP_OLED_FPS_REPORT
+/*******************************************************************************
+ * Measure full-frame OLED refresh rate for every I2C speed profile
+ ******************************************************************************/
+static void Oled_FpsReport(void) {
+    static const char *const profile_names[I2C_SPEED_COUNT] = {
+        "Sm 100kHz", "Fm 400kHz", "Fm+ 1MHz"
+    };
+
+    for (uint32_t speed = 0; speed < I2C_SPEED_COUNT; speed++) {
+        if (MX_I2C2_SetSpeed((i2c_speed_t)speed) != HAL_OK) {
+            continue;
+        }
+
+        ssd1306_FpsResult_t fps;
+        ssd1306_TestFPS(&fps);
+
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer),
+                                "OLED %s: %lu.%02lu FPS (%lu frames in %lu us, %lu us/frame)\r\n",
+                                profile_names[speed],
+                                (unsigned long)(fps.fps_x100 / 100), (unsigned long)(fps.fps_x100 % 100),
+                                (unsigned long)fps.frames, (unsigned long)fps.elapsed_us,
+                                (unsigned long)(fps.elapsed_us / fps.frames));
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+
+    MX_I2C2_SetSpeed(I2C2_SPEED_DEFAULT);
+}
+#endif
+
+#if APP_OLED_GFX_BENCH
+/*******************************************************************************
+ * Time old (per-pixel) vs. new (span/blit) graphics primitives
+ ******************************************************************************/
+static void Oled_GfxBenchReport(void) {
+    ssd1306_BenchResult_t results[8];
+    int count = ssd1306_TestBenchmark(results, sizeof(results) / sizeof(results[0]));
+
+    for (int i = 0; i < count; i++) {
+        uart_mes_len = snprintf(uart_buffer, sizeof(uart_buffer), "GFX %-10s old:%luus new:%luus %s\r\n",
+                                results[i].name,
+                                (unsigned long)results[i].ref_us, (unsigned long)results[i].fast_us,
+                                results[i].match ? "same" : "differs");
+        MX_USART2_Write((uint8_t*)uart_buffer, uart_mes_len);
+    }
+}
+#endif
+
 /*******************************************************************************
  * Main function
  ******************************************************************************/
 int main(void) {
     System_Init();
+#if !APP_FAST_BOOT
+    Display_Start();
+#endif
 
     while (1) {
-        distance = Measure_Distance();
-        Buzzer_Control(distance);
-        Display_Update(distance);
+        uint32_t loop_start_us = timebase_now32();
+
+        bool pinged = Measure_Echo();
+#if APP_CALIBRATION
+        pipeline_echo(&pipe, pinged ? &echo_result : NULL, &calib);
+#else
+        pipeline_echo(&pipe, pinged ? &echo_result : NULL, NULL);
+#endif
+#if APP_COMMANDS
+        Command_Service();
+#endif
+#if APP_CALIBRATION
+        Cal_Service();
+#endif
+        if (pipe.echo_us != 0) {
+            Boot_Mark(BOOT_FIRST_ECHO);
+        }
+
+        const policy_entry_t *policy = pipe.policy;
+#if APP_LATENCY
+        bool buzzer_was_on = buzzer_on;
+#endif
+        Buzzer_Control(policy);
+#if APP_LATENCY
+        Latency_Buzzer(policy, buzzer_on != buzzer_was_on);
+#endif
+        if (policy->zone != POLICY_ZONE_INVALID) {
+            Boot_Mark(BOOT_FIRST_BUZZ);
+        }
+#if APP_STATS
+        Stats_Service();
+#endif
+#if APP_OCCUPANCY
+        Occupancy_Service();
+#endif
+        float shown = pipeline_readout(&pipe);
+        Display_Service();
+        Display_BootStep();
+#if APP_OLED_GRAPH
+        Graph_Update(shown, policy);
+#endif
+        Display_Update(shown, policy);
+        if (display_ready) {
+#if APP_LATENCY
+            ssd1306_TagFrame(latency_take(&latency[LATENCY_OUT_DASH]));
+#endif
+            ui_commit(&dash_ui);              /* One dashboard transfer per loop */
+#if APP_OLED_REAR_PANEL
+            Rear_Update(shown, policy);       /* Queued behind it on I2C2 */
+#endif
+        }
+#if APP_CLOCK_SCALING
+        Clock_Report();
+#endif
+        Display_Report();
+        Boot_Report();
+#if APP_LATENCY
+        Latency_Service();
+#endif
+#if APP_TRACE
+        Trace_Service();
+#endif
+        Loop_Account(loop_start_us);
     }
 }
 
+/*******************************************************************************
+ * Microsecond time base for the SSD1306 and I2C bus statistics
+ ******************************************************************************/
+uint32_t ssd1306_GetTimeUs(void)
+{
+    return timebase_now32();
+}
+
+/* Same time base for the I2C bus utilization */
+uint32_t i2c_bus_time_us(void)
+{
+    return timebase_now32();
+}
+
+#if APP_LATENCY
+/* A frame tagged with an echo capture time is on the panel (I2C ISR, or
+ * the main loop for a blocking update): Latency_Service takes it from here */
+void ssd1306_FrameShown(SSD1306_t *panel, uint32_t tag, uint32_t shown_us)
+{
+    latency_out_t out = LATENCY_OUT_DASH;
+    uint32_t latency_us = shown_us - tag;
+
+#if APP_OLED_REAR_PANEL
+    if (panel == &rear_panel)
+    {
+        out = LATENCY_OUT_REAR;
+    }
+#else
+    (void)panel;
+#endif
+    latency_shown_us[out] = (latency_us != 0U) ? latency_us : 1U;
+}
+#endif
+
 /*******************************************************************************
  * EXTI callback for HC-SR04 echo pin
  ******************************************************************************/
@@ -297,29 +1579,27 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
     if(GPIO_Pin == HS_SR04_ECHO_PIN)
     {
-        switch(echo_state){
-            case WAITING_RISING_EDGE: {
-                /* Rising edge detected → start timing */
-                if(HAL_GPIO_ReadPin(HS_SR04_ECHO_PORT, HS_SR04_ECHO_PIN) == GPIO_PIN_SET)
-                {
-                    start_time = __HAL_TIM_GET_COUNTER(&htim2);
-                    echo_state = WAITING_FALLING_EDGE;
-                }
-                break;
-            }
-            case WAITING_FALLING_EDGE: { 
-                /* Falling edge detected → stop timing */
-                if(HAL_GPIO_ReadPin(HS_SR04_ECHO_PORT, HS_SR04_ECHO_PIN) == GPIO_PIN_RESET)
-                {
-                    end_time = __HAL_TIM_GET_COUNTER(&htim2);
-                    echo_state = MEASURING_ECHO_DATA;
-                }
-                break;
-            }
-            default:
-                echo_state = UNKNOWN_ECHO_SPIKES; /* Unexpected signal → mark as unknown */
-                break;
+#if APP_IRQ_SELFTEST
+        if (irqtest_active())
+        {
+            irqtest_echo_edge(echo_irq_entry);
+            return;
         }
+#endif
+        /* Timestamp before anything else, then the entry latency */
+        timer_tick_t now = timebase_now32();
+        echo_irq_last_cycles = DWT->CYCCNT - echo_irq_entry;
+        if (echo_irq_last_cycles > echo_irq_max_cycles)
+        {
+            echo_irq_max_cycles = echo_irq_last_cycles;
+        }
+
+        /* Completed echoes go to the HC-SR04 ring, read by Measure_Echo */
+        GPIO_PinState level = IO_PinRead(HS_SR04_ECHO_PORT, HS_SR04_ECHO_PIN);
+        HCSR04_EchoEdge(now, level);
+#if APP_TRACE
+        trace_put(TRACE_EDGE, now, (uint16_t)level, 0);
+#endif
     }
 }
 
@@ -20,6 +20,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "stm32l4xx_it.h"
+#include "timebase.h"
+#include "uart.h"
+#include "irqtest.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 /* USER CODE END Includes */
@@ -53,12 +56,15 @@
 /* USER CODE BEGIN 0 */
 void EXTI0_IRQHandler(void)
 {
-    HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0);
+    echo_irq_entry = DWT->CYCCNT;
+    IO_ExtiIrq(GPIO_PIN_0);
 }
 
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
+extern DMA_HandleTypeDef hdma_i2c2_tx;
+extern I2C_HandleTypeDef hi2c2;
 
 /* USER CODE BEGIN EV */
 
@@ -202,6 +208,82 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32l4xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles DMA1 channel4 global interrupt.
+  */
+void DMA1_Channel4_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Channel4_IRQn 0 */
+
+  /* USER CODE END DMA1_Channel4_IRQn 0 */
+  HAL_DMA_IRQHandler(&hdma_i2c2_tx);
+  /* USER CODE BEGIN DMA1_Channel4_IRQn 1 */
+
+  /* USER CODE END DMA1_Channel4_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C2 event interrupt.
+  */
+void I2C2_EV_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C2_EV_IRQn 0 */
+
+  /* USER CODE END I2C2_EV_IRQn 0 */
+  HAL_I2C_EV_IRQHandler(&hi2c2);
+  /* USER CODE BEGIN I2C2_EV_IRQn 1 */
+
+  /* USER CODE END I2C2_EV_IRQn 1 */
+}
+
+/**
+  * @brief This function handles I2C2 error interrupt.
+  */
+void I2C2_ER_IRQHandler(void)
+{
+  /* USER CODE BEGIN I2C2_ER_IRQn 0 */
+
+  /* USER CODE END I2C2_ER_IRQn 0 */
+  HAL_I2C_ER_IRQHandler(&hi2c2);
+  /* USER CODE BEGIN I2C2_ER_IRQn 1 */
+
+  /* USER CODE END I2C2_ER_IRQn 1 */
+}
+
+/**
+  * @brief This function handles USART2 global interrupt (receive).
+  */
+void USART2_IRQHandler(void)
+{
+  MX_USART2_IRQHandler();
+}
+
+/**
+  * @brief This function handles TIM2 global interrupt (time base wrap).
+  */
+void TIM2_IRQHandler(void)
+{
+  timebase_irq_handler();
+}
+
+#if APP_IRQ_SELFTEST
+/**
+  * @brief TIM7: interrupt latency probe (irqtest.c), counter read first.
+  */
+void TIM7_IRQHandler(void)
+{
+  irqtest_probe_irq_handler();
+}
+
+/**
+  * @brief TIM6: interrupt latency self-test load.
+  */
+void TIM6_DAC_IRQHandler(void)
+{
+  irqtest_load_irq_handler();
+}
+#endif
+
 /* USER CODE BEGIN 1 */
 
 /* USER CODE END 1 */
@@ -9,6 +9,7 @@ extern "C" {
  * Includes
 ****************************************************************/
 #include "stm32l4xx_hal_gpio.h"
+#include "buzzer_pattern.h"
 #include <stdbool.h>
 
 /****************************************************************
@@ -17,6 +18,8 @@ extern "C" {
 #define BUZZER_PORT GPIOA
 #define BUZZER_PIN  GPIO_PIN_11
 
+#define BUZZER_CADENCE_CONTINUOUS  0xFFFFFFFFU  /**< on_ms value: tone never gated off */
+
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
@@ -25,6 +28,16 @@ void buzzer_set_pwm_by_distance(float distance_cm);
 uint32_t calculate_buzzer_interval(float distance);
 void update_buzzer(uint32_t interval);
 
+/* Hardware cadence (TIM4 OC1REF gates TIM1 through ITR3) */
+HAL_StatusTypeDef Buzzer_HwCadence_Init(void);
+void Buzzer_HwCadence_Set(uint32_t freq_hz, uint32_t on_ms, uint32_t period_ms);
+void Buzzer_HwCadence_Off(void);
+
+/* Pattern player (TIM1 update DMA burst into ARR..CCR4) */
+HAL_StatusTypeDef Buzzer_Pattern_Play(const buzzer_pattern_t *pattern);
+void Buzzer_Pattern_Stop(void);
+bool Buzzer_Pattern_IsPlaying(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,78 @@
+#ifndef _BUZZER_PATTERN_H
+#define _BUZZER_PATTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define BUZZER_PATTERN_TIMER_HZ    1000000U  /**< TIM1 counter clock [Hz] */
+#define BUZZER_PATTERN_MAX_STEPS   32U       /**< Longest pattern the player accepts */
+#define BUZZER_PATTERN_VOLUME_MAX  100U      /**< Full volume = 50 % duty */
+#define BUZZER_PATTERN_SILENT_HZ   1000U     /**< Carrier used for silent steps [Hz] */
+
+/* One step of a pattern table: { frequency [Hz], volume [0..100], length [ms] } */
+#define BUZZER_TONE(freq_hz, volume, ms)  { (freq_hz), (volume), (ms) }
+#define BUZZER_REST(ms)                   { 0U, 0U, (ms) }
+
+/* Pattern from a static step array */
+#define BUZZER_PATTERN(steps, loop) \
+    { (steps), (uint8_t)(sizeof(steps) / sizeof((steps)[0])), (loop) }
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef struct {
+    uint16_t freq_hz;      /**< Tone frequency [Hz], 0 = rest */
+    uint8_t  volume;       /**< 0..BUZZER_PATTERN_VOLUME_MAX */
+    uint16_t duration_ms;  /**< Step length [ms] */
+} buzzer_step_t;
+
+typedef struct {
+    const buzzer_step_t *steps;
+    uint8_t              count;
+    bool                 loop;   /**< Repeat until stopped */
+} buzzer_pattern_t;
+
+/* Register image written by one TIM1 DMA burst (DMAR, base = ARR).
+ * Order follows the TIM1 register map: ARR, RCR, CCR1, CCR2, CCR3, CCR4. */
+typedef struct {
+    uint16_t arr;
+    uint16_t rcr;
+    uint16_t ccr1;
+    uint16_t ccr2;
+    uint16_t ccr3;
+    uint16_t ccr4;
+} buzzer_burst_t;
+
+#define BUZZER_BURST_WORDS  (sizeof(buzzer_burst_t) / sizeof(uint16_t))
+
+/****************************************************************
+ * Predefined patterns
+****************************************************************/
+extern const buzzer_pattern_t buzzer_pattern_chirp;   /**< Rising 1-3 kHz sweep */
+extern const buzzer_pattern_t buzzer_pattern_alarm;   /**< Two-tone alarm, looped */
+extern const buzzer_pattern_t buzzer_pattern_fade;    /**< 2 kHz with decaying envelope */
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void     buzzer_pattern_step_to_burst(const buzzer_step_t *step, buzzer_burst_t *burst);
+uint32_t buzzer_pattern_render(const buzzer_pattern_t *pattern,
+                               buzzer_burst_t *bursts, uint32_t max_bursts);
+uint32_t buzzer_pattern_render_stream(const buzzer_pattern_t *pattern, buzzer_burst_t *bursts);
+uint32_t buzzer_pattern_duration_ms(const buzzer_pattern_t *pattern);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BUZZER_PATTERN_H */
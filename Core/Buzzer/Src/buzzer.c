@@ -12,6 +12,8 @@
  ******************************************************************************/
 #include "main.h"
 #include "buzzer.h"
+#include "buzzer_pattern.h"
+#include "timer.h"
 
 /*******************************************************************************
  * Defines
@@ -25,6 +27,15 @@
  * Variables
  ******************************************************************************/
 extern TIM_HandleTypeDef htim1;
+extern TIM_HandleTypeDef htim4;
+
+/* Pattern player */
+static buzzer_burst_t pattern_bursts[BUZZER_PATTERN_MAX_STEPS + 2]; /**< DMA source */
+static const buzzer_pattern_t *pattern_playing = NULL;            /**< NULL = idle */
+static uint32_t pattern_smcr;                                      /**< TIM1 SMCR before play */
+
+/* Hardware cadence: written to TIM1 EGR by DMA on the TIM4 CC1 event */
+static const uint32_t cadence_tim1_reset = TIM_EGR_UG;
 
 /*******************************************************************************
  * Prototypes
@@ -78,4 +89,224 @@ void buzzer_set_pwm_by_distance(float distance_cm)
     __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_4, pulse);
 
     __HAL_TIM_SET_COUNTER(&htim1, 0);
-}
\ No newline at end of file
+}
+
+/*******************************************************************************
+ * Hardware cadence
+ ******************************************************************************/
+/* OC1M/OC4M field values written directly on zone changes */
+#define BUZZER_OCM_PWM2           (TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_0)
+#define BUZZER_OCM_FORCE_LOW      (TIM_CCMR1_OC1M_2)
+
+static void buzzer_set_output_mode(uint32_t ocm)
+{
+    TIM_TypeDef *tim = htim1.Instance;
+
+    tim->CCMR1 = (tim->CCMR1 & ~TIM_CCMR1_OC1M) | ocm;
+    tim->CCMR2 = (tim->CCMR2 & ~TIM_CCMR2_OC4M) | (ocm << 8);
+}
+
+/**
+ * @brief Put TIM1 under hardware cadence control.
+ *        TIM1 runs in gated slave mode on ITR3 (TIM4 TRGO = OC1REF), so the
+ *        tone only advances while TIM4 is in the ON part of its period.
+ *        A closed gate freezes TIM1 wherever it is, with the pin high half
+ *        of the time, so the TIM4 CC1 event that closes it also has DMA
+ *        write UG to TIM1: the counter restarts at 0, where PWM mode 2
+ *        keeps the pin low until the next beep.
+ */
+HAL_StatusTypeDef Buzzer_HwCadence_Init(void)
+{
+    TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+
+    sSlaveConfig.SlaveMode = TIM_SLAVEMODE_GATED;
+    sSlaveConfig.InputTrigger = TIM_TS_ITR3;
+    if (HAL_TIM_SlaveConfigSynchro(&htim1, &sSlaveConfig) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    /* Period/duty changes take effect at the next tone period */
+    htim1.Instance->CR1 |= TIM_CR1_ARPE;
+
+    Buzzer_HwCadence_Off();
+
+    if (HAL_DMA_Start(htim4.hdma[TIM_DMA_ID_CC1], (uint32_t)&cadence_tim1_reset,
+                      (uint32_t)&htim1.Instance->EGR, 1) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    __HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_CC1);
+
+    /* Outputs and MOE on; the gate decides when the counter runs */
+    htim1.Instance->CCER |= TIM_CCER_CC1E | TIM_CCER_CC4E;
+    __HAL_TIM_MOE_ENABLE(&htim1);
+    __HAL_TIM_ENABLE(&htim1);
+
+    return HAL_TIM_PWM_Start(&htim4, TIM_CHANNEL_1);
+}
+
+/**
+ * @brief Program tone and cadence registers. Called only on zone changes;
+ *        every beep after that is produced by TIM4/TIM1 with no CPU work.
+ * @param freq_hz   Tone frequency [Hz]
+ * @param on_ms     Beep length [ms], BUZZER_CADENCE_CONTINUOUS for a steady tone
+ * @param period_ms Cadence period [ms]
+ */
+void Buzzer_HwCadence_Set(uint32_t freq_hz, uint32_t on_ms, uint32_t period_ms)
+{
+    uint32_t period = (1000000 / freq_hz) - 1;     // TIM1 runs at 1 MHz
+    uint32_t pulse  = (period + 1) / 2;            // Duty 50%
+
+    __HAL_TIM_SET_AUTORELOAD(&htim1, period);
+    __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, pulse);
+    __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_4, pulse);
+
+    uint32_t cadence_ticks = (period_ms * TIM4_TICK_HZ) / 1000;
+    uint32_t on_ticks;
+
+    if (on_ms == BUZZER_CADENCE_CONTINUOUS) {
+        on_ticks = cadence_ticks + 1;              // CCR1 > ARR → OC1REF stays high
+    } else {
+        on_ticks = (on_ms * TIM4_TICK_HZ) / 1000;
+    }
+
+    uint32_t remaining = __HAL_TIM_GET_AUTORELOAD(&htim4) - __HAL_TIM_GET_COUNTER(&htim4);
+
+    __HAL_TIM_SET_AUTORELOAD(&htim4, cadence_ticks - 1);
+    __HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_1, on_ticks);
+
+    /* Preloaded values apply at the next period; restart right away if the
+     * old period would delay the new cadence by more than one new period */
+    if (remaining > cadence_ticks) {
+        htim4.Instance->EGR = TIM_EGR_UG;
+    }
+
+    buzzer_set_output_mode(BUZZER_OCM_PWM2);
+}
+
+/**
+ * @brief Close the gate and force both buzzer outputs low.
+ */
+void Buzzer_HwCadence_Off(void)
+{
+    __HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_1, 0);   // OC1REF low → TIM1 gated
+    buzzer_set_output_mode(BUZZER_OCM_FORCE_LOW);
+}
+
+/*******************************************************************************
+ * Pattern player (TIM1 DMA burst)
+ ******************************************************************************/
+/**
+ * @brief Stream a pattern into TIM1 with DMA bursts on the update event.
+ *        Every update writes ARR, RCR and CCR1..CCR4 through DMAR into the
+ *        preload registers, which become active at the next update. RCR makes
+ *        that update arrive only at the end of a step, so a step costs one
+ *        6-halfword burst and no CPU time. The DMA channel runs without an
+ *        interrupt; a looped pattern circulates until Buzzer_Pattern_Stop().
+ * @note  TIM1 leaves the gated cadence mode while a pattern plays. Clock
+ *        profile switches preload a new TIM1 prescaler, which would play
+ *        the steps after it at another pitch and length, so the caller
+ *        keeps the full profile while Buzzer_Pattern_IsPlaying() is true.
+ */
+HAL_StatusTypeDef Buzzer_Pattern_Play(const buzzer_pattern_t *pattern)
+{
+    TIM_TypeDef *tim = htim1.Instance;
+    DMA_HandleTypeDef *hdma = htim1.hdma[TIM_DMA_ID_UPDATE];
+
+    Buzzer_Pattern_Stop();
+
+    /* Step 0 is loaded by UG below; DMA starts at step 1 */
+    uint32_t bursts = buzzer_pattern_render_stream(pattern, pattern_bursts);
+    if (bursts == 0 || hdma == NULL) {
+        return HAL_ERROR;
+    }
+
+    uint32_t mode = pattern->loop ? DMA_CIRCULAR : DMA_NORMAL;
+
+    if (hdma->Init.Mode != mode) {
+        hdma->Init.Mode = mode;
+        if (HAL_DMA_Init(hdma) != HAL_OK) {
+            return HAL_ERROR;
+        }
+    }
+
+    /* Free-running TIM1, preloaded ARR/CCR, PWM mode 2 on both outputs;
+     * the end of a cadence beep must not restart it */
+    __HAL_TIM_DISABLE_DMA(&htim4, TIM_DMA_CC1);
+    pattern_smcr = tim->SMCR;
+    tim->SMCR &= ~TIM_SMCR_SMS;
+    tim->CR1 |= TIM_CR1_ARPE;
+    tim->CCMR1 |= TIM_CCMR1_OC1PE;
+    tim->CCMR2 |= TIM_CCMR2_OC4PE;
+    buzzer_set_output_mode(BUZZER_OCM_PWM2);
+
+    tim->ARR  = pattern_bursts[0].arr;
+    tim->RCR  = pattern_bursts[0].rcr;
+    tim->CCR1 = pattern_bursts[0].ccr1;
+    tim->CCR4 = pattern_bursts[0].ccr4;
+
+    if (HAL_TIM_DMABurst_MultiWriteStart(&htim1, TIM_DMABASE_ARR, TIM_DMA_UPDATE,
+                                         (const uint32_t *)&pattern_bursts[1],
+                                         TIM_DMABURSTLENGTH_6TRANSFERS,
+                                         bursts * BUZZER_BURST_WORDS) != HAL_OK) {
+        tim->SMCR = pattern_smcr;
+        __HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_CC1);
+        return HAL_ERROR;
+    }
+    pattern_playing = pattern;
+
+    /* UG: step 0 becomes active and its DMA request preloads step 1 */
+    tim->CR1 &= ~TIM_CR1_URS;
+    tim->EGR = TIM_EGR_UG;
+
+    tim->CCER |= TIM_CCER_CC1E | TIM_CCER_CC4E;
+    __HAL_TIM_MOE_ENABLE(&htim1);
+    __HAL_TIM_ENABLE(&htim1);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Abort the running pattern, silence the outputs and hand TIM1 back
+ *        to the cadence gate. The next Buzzer_HwCadence_Set() re-arms it.
+ */
+void Buzzer_Pattern_Stop(void)
+{
+    TIM_TypeDef *tim = htim1.Instance;
+
+    if (pattern_playing == NULL) {
+        return;
+    }
+
+    HAL_TIM_DMABurst_WriteStop(&htim1, TIM_DMA_UPDATE);
+    buzzer_set_output_mode(BUZZER_OCM_FORCE_LOW);
+
+    /* Drop the pattern repetition count so cadence updates apply at once */
+    tim->RCR = 0;
+    tim->EGR = TIM_EGR_UG;
+    tim->SMCR = pattern_smcr;
+    __HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_CC1);
+
+    pattern_playing = NULL;
+}
+
+/**
+ * @brief  Pattern state, polled from the main loop. A finished one-shot
+ *         pattern releases TIM1 here.
+ * @retval true while a pattern is audible.
+ */
+bool Buzzer_Pattern_IsPlaying(void)
+{
+    if (pattern_playing == NULL) {
+        return false;
+    }
+
+    if (!pattern_playing->loop &&
+        __HAL_DMA_GET_COUNTER(htim1.hdma[TIM_DMA_ID_UPDATE]) == 0) {
+        Buzzer_Pattern_Stop();
+        return false;
+    }
+
+    return true;
+}
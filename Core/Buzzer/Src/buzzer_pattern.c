@@ -0,0 +1,163 @@
+/**
+ * @file    buzzer_pattern.c
+ * @brief   Parking-Sensor project.
+ * @details Buzzer pattern tables and their translation into TIM1 register
+ *          images. No HAL dependency, so the renderer can also be built on
+ *          the host to inspect the generated register sequence.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "buzzer_pattern.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define BUZZER_PATTERN_MIN_HZ   16U      /**< ARR is 16 bit at 1 MHz */
+#define BUZZER_PATTERN_MAX_HZ   20000U
+#define BUZZER_PATTERN_MAX_REP  65536U   /**< RCR is 16 bit on TIM1 */
+
+/*******************************************************************************
+ * Pattern tables
+ ******************************************************************************/
+static const buzzer_step_t chirp_steps[] = {
+    BUZZER_TONE(1000, 100, 15),
+    BUZZER_TONE(1250, 100, 15),
+    BUZZER_TONE(1500, 100, 15),
+    BUZZER_TONE(1750, 100, 15),
+    BUZZER_TONE(2000, 100, 15),
+    BUZZER_TONE(2250, 100, 15),
+    BUZZER_TONE(2500, 100, 15),
+    BUZZER_TONE(2750, 100, 15),
+    BUZZER_TONE(3000, 100, 30),
+};
+
+static const buzzer_step_t alarm_steps[] = {
+    BUZZER_TONE(2900, 100, 120),
+    BUZZER_TONE(2200, 100, 120),
+    BUZZER_TONE(2900, 100, 120),
+    BUZZER_TONE(2200, 100, 120),
+    BUZZER_REST(80),
+};
+
+static const buzzer_step_t fade_steps[] = {
+    BUZZER_TONE(2000, 100, 40),
+    BUZZER_TONE(2000,  60, 40),
+    BUZZER_TONE(2000,  35, 40),
+    BUZZER_TONE(2000,  20, 40),
+    BUZZER_TONE(2000,  10, 40),
+    BUZZER_TONE(2000,   5, 40),
+};
+
+const buzzer_pattern_t buzzer_pattern_chirp = BUZZER_PATTERN(chirp_steps, false);
+const buzzer_pattern_t buzzer_pattern_alarm = BUZZER_PATTERN(alarm_steps, true);
+const buzzer_pattern_t buzzer_pattern_fade  = BUZZER_PATTERN(fade_steps, false);
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+/**
+ * @brief Translate one table step into the TIM1 register image.
+ *        Both outputs run in PWM mode 2 (active while CNT >= CCR), so the
+ *        volume sets the active part of the period: full volume is 50 % duty
+ *        and CCR = ARR + 1 keeps the pin low for a rest.
+ *        RCR holds the number of tone periods for the step minus one, so the
+ *        update event (and the next DMA burst) comes exactly at the step end.
+ */
+void buzzer_pattern_step_to_burst(const buzzer_step_t *step, buzzer_burst_t *burst)
+{
+    uint32_t freq = step->freq_hz;
+    uint32_t volume = step->volume;
+
+    if (freq == 0U || volume == 0U) {
+        freq = BUZZER_PATTERN_SILENT_HZ;
+        volume = 0U;
+    }
+    if (freq < BUZZER_PATTERN_MIN_HZ) freq = BUZZER_PATTERN_MIN_HZ;
+    if (freq > BUZZER_PATTERN_MAX_HZ) freq = BUZZER_PATTERN_MAX_HZ;
+    if (volume > BUZZER_PATTERN_VOLUME_MAX) volume = BUZZER_PATTERN_VOLUME_MAX;
+
+    uint32_t period = BUZZER_PATTERN_TIMER_HZ / freq;              // ARR + 1
+    uint32_t active = (period * volume) / (2U * BUZZER_PATTERN_VOLUME_MAX);
+    uint32_t repeats = (freq * step->duration_ms) / 1000U;
+
+    if (repeats == 0U) repeats = 1U;
+    if (repeats > BUZZER_PATTERN_MAX_REP) repeats = BUZZER_PATTERN_MAX_REP;
+
+    burst->arr  = (uint16_t)(period - 1U);
+    burst->rcr  = (uint16_t)(repeats - 1U);
+    burst->ccr1 = (uint16_t)(period - active);
+    burst->ccr2 = 0U;
+    burst->ccr3 = 0U;
+    burst->ccr4 = burst->ccr1;
+}
+
+/**
+ * @brief  Render a pattern table into consecutive TIM1 register images.
+ * @retval Number of bursts written (0 if the pattern does not fit).
+ */
+uint32_t buzzer_pattern_render(const buzzer_pattern_t *pattern,
+                               buzzer_burst_t *bursts, uint32_t max_bursts)
+{
+    if (pattern == 0 || pattern->count == 0U || pattern->count > max_bursts) {
+        return 0U;
+    }
+
+    for (uint32_t i = 0; i < pattern->count; i++) {
+        buzzer_pattern_step_to_burst(&pattern->steps[i], &bursts[i]);
+    }
+
+    return pattern->count;
+}
+
+/**
+ * @brief  Render a pattern as the player streams it. Step 0 is loaded by
+ *         UG, the DMA channel sends the rest: a looped pattern ends with a
+ *         copy of step 0 so the circular buffer wraps seamlessly, a
+ *         one-shot pattern ends with two rests, since the channel counter
+ *         reaches zero once the first rest is active, i.e. when the last
+ *         tone ended.
+ * @param  bursts Room for BUZZER_PATTERN_MAX_STEPS + 2 images.
+ * @retval Number of bursts the DMA channel sends after step 0 (0 if the
+ *         pattern does not fit).
+ */
+uint32_t buzzer_pattern_render_stream(const buzzer_pattern_t *pattern, buzzer_burst_t *bursts)
+{
+    uint32_t steps = buzzer_pattern_render(pattern, bursts, BUZZER_PATTERN_MAX_STEPS);
+
+    if (steps == 0U) {
+        return 0U;
+    }
+
+    if (pattern->loop) {
+        bursts[steps] = bursts[0];
+        return steps;
+    }
+
+    const buzzer_step_t rest = BUZZER_REST(1);
+    buzzer_pattern_step_to_burst(&rest, &bursts[steps]);
+    bursts[steps + 1U] = bursts[steps];
+    return steps + 1U;
+}
+
+/**
+ * @brief  Length of one pass through the pattern as actually played, i.e.
+ *         after rounding every step to whole tone periods.
+ * @retval Duration [ms].
+ */
+uint32_t buzzer_pattern_duration_ms(const buzzer_pattern_t *pattern)
+{
+    uint32_t total_us = 0U;
+    buzzer_burst_t burst;
+
+    for (uint32_t i = 0; i < pattern->count; i++) {
+        buzzer_pattern_step_to_burst(&pattern->steps[i], &burst);
+        total_us += ((uint32_t)burst.arr + 1U) * ((uint32_t)burst.rcr + 1U);
+    }
+
+    return total_us / 1000U;
+}
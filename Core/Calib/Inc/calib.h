@@ -0,0 +1,63 @@
+#ifndef _CALIB_H
+#define _CALIB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define CALIB_SHIFT        9U            /**< Breakpoint every 512 us of echo (~8.8 cm) */
+#define CALIB_POINTS       48U           /**< Breakpoints 0..24064 us, past HS_SR04_ECHO_MAX_US */
+#define CALIB_MAX_REFS     8U            /**< Reference targets per calibration */
+#define CALIB_MAGIC        0x43414C31U   /**< "CAL1" */
+#define CALIB_VERSION      1U
+
+/* Distance [0.01 cm] to echo time [us], inverse of POLICY_ECHO_TO_CM100 */
+#define CALIB_CM100_TO_ECHO(cm100)   (((uint32_t)(cm100) * 200U + 171U) / 343U)
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+/* Reference target: echo measured by this unit, echo of the true distance */
+typedef struct {
+    uint32_t raw_us;
+    uint32_t true_us;
+} calib_ref_t;
+
+/* Correction table: offset to add to the echo at every breakpoint, linear
+ * in between. Stored as is in flash, the CRC covers everything before it. */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t refs;                       /**< Reference targets of the fit, 0 = identity */
+    int16_t  corr_us[CALIB_POINTS];
+    uint32_t crc;
+} calib_table_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void calib_identity(calib_table_t *table);
+bool calib_fit(calib_table_t *table, const calib_ref_t *refs, uint32_t count);
+uint32_t calib_apply(const calib_table_t *table, uint32_t raw_us);
+void calib_seal(calib_table_t *table);
+bool calib_valid(const calib_table_t *table);
+
+/* Persistent copy (calib_flash.c) */
+bool calib_load(calib_table_t *table);
+bool calib_store(const calib_table_t *table);
+bool calib_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CALIB_H */
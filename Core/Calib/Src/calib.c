@@ -0,0 +1,138 @@
+/**
+ * @file    calib.c
+ * @brief   Parking-Sensor project.
+ * @details Per-unit distance calibration. Echoes of targets at known
+ *          distances are fitted to a piecewise-linear correction of the
+ *          echo time, kept as offsets at fixed breakpoints, so applying
+ *          it is one shift for the index and one interpolation. It happens
+ *          in the echo domain, ahead of the policy table and the display.
+ *          No HAL here; the flash copy is in calib_flash.c.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "calib.h"
+#include <stddef.h>
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void calib_identity(calib_table_t *table)
+{
+    table->magic   = CALIB_MAGIC;
+    table->version = CALIB_VERSION;
+    table->refs    = 0;
+    for (uint32_t i = 0; i < CALIB_POINTS; i++) {
+        table->corr_us[i] = 0;
+    }
+    calib_seal(table);
+}
+
+/* Line through two references, evaluated at x */
+static int32_t calib_line(const calib_ref_t *a, const calib_ref_t *b, int32_t x)
+{
+    int32_t dx = (int32_t)b->raw_us - (int32_t)a->raw_us;
+    int32_t dy = (int32_t)b->true_us - (int32_t)a->true_us;
+
+    return (int32_t)a->true_us + (int32_t)(((int64_t)dy * (x - (int32_t)a->raw_us)) / dx);
+}
+
+/* One reference is an offset. Two or more are joined by straight lines,
+ * and the first and last line continue outside them. References must not
+ * repeat a raw echo and must keep their order in both columns; false
+ * leaves the table as it was. */
+bool calib_fit(calib_table_t *table, const calib_ref_t *refs, uint32_t count)
+{
+    calib_ref_t sorted[CALIB_MAX_REFS];
+
+    if ((count == 0) || (count > CALIB_MAX_REFS)) {
+        return false;
+    }
+
+    /* Insertion sort by raw echo */
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t j = i;
+        while ((j > 0) && (sorted[j - 1].raw_us > refs[i].raw_us)) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = refs[i];
+    }
+    for (uint32_t i = 1; i < count; i++) {
+        if ((sorted[i].raw_us == sorted[i - 1].raw_us) || (sorted[i].true_us <= sorted[i - 1].true_us)) {
+            return false;
+        }
+    }
+
+    calib_table_t fit;
+    fit.magic   = CALIB_MAGIC;
+    fit.version = CALIB_VERSION;
+    fit.refs    = (uint16_t)count;
+
+    uint32_t seg = 0;
+    for (uint32_t i = 0; i < CALIB_POINTS; i++) {
+        int32_t x = (int32_t)(i << CALIB_SHIFT);
+        int32_t y;
+
+        if (count == 1) {
+            y = x + (int32_t)sorted[0].true_us - (int32_t)sorted[0].raw_us;
+        } else {
+            while ((seg + 2U < count) && (x > (int32_t)sorted[seg + 1U].raw_us)) {
+                seg++;
+            }
+            y = calib_line(&sorted[seg], &sorted[seg + 1U], x);
+        }
+        y -= x;
+        fit.corr_us[i] = (y < INT16_MIN) ? INT16_MIN : (y > INT16_MAX) ? INT16_MAX : (int16_t)y;
+    }
+
+    calib_seal(&fit);
+    *table = fit;
+    return true;
+}
+
+/* Corrected echo time. Past the last breakpoint the last segment goes on. */
+uint32_t calib_apply(const calib_table_t *table, uint32_t raw_us)
+{
+    uint32_t i = raw_us >> CALIB_SHIFT;
+
+    if (i > CALIB_POINTS - 2U) {
+        i = CALIB_POINTS - 2U;
+    }
+
+    int32_t c0 = table->corr_us[i];
+    int32_t c1 = table->corr_us[i + 1U];
+    int32_t dx = (int32_t)(raw_us - (i << CALIB_SHIFT));
+    int32_t y  = (int32_t)raw_us + c0 + ((c1 - c0) * dx) / (int32_t)(1U << CALIB_SHIFT);
+
+    return (y < 0) ? 0U : (uint32_t)y;
+}
+
+/* CRC-32 (IEEE 802.3), bitwise: runs once per load or store */
+static uint32_t calib_crc32(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    while (size--) {
+        crc ^= *data++;
+        for (uint32_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+void calib_seal(calib_table_t *table)
+{
+    table->crc = calib_crc32((const uint8_t*)table, offsetof(calib_table_t, crc));
+}
+
+bool calib_valid(const calib_table_t *table)
+{
+    return (table->magic == CALIB_MAGIC) && (table->version == CALIB_VERSION) &&
+           (table->crc == calib_crc32((const uint8_t*)table, offsetof(calib_table_t, crc)));
+}
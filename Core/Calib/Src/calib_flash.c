@@ -0,0 +1,81 @@
+/**
+ * @file    calib_flash.c
+ * @brief   Parking-Sensor project.
+ * @details Calibration table in the last 2 KB flash page (bank 2), kept out
+ *          of the FLASH region by the linker script. The program runs from
+ *          bank 1, so erasing and programming it never stalls the CPU.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "calib.h"
+#include "stm32l4xx_hal.h"
+#include <string.h>
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CALIB_FLASH_ADDR   0x080FF800U   /**< CALIB region of STM32L476RGTx_FLASH.ld */
+#define CALIB_FLASH_PAGE   255U          /**< Last page of bank 2 (1 MB part, 2 KB pages) */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+/* False (table untouched) if the page is erased or does not check out */
+bool calib_load(calib_table_t *table)
+{
+    const calib_table_t *stored = (const calib_table_t*)CALIB_FLASH_ADDR;
+
+    if (!calib_valid(stored)) {
+        return false;
+    }
+    *table = *stored;
+    return true;
+}
+
+static HAL_StatusTypeDef calib_flash_erase(void)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t page_error;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks     = FLASH_BANK_2;
+    erase.Page      = CALIB_FLASH_PAGE;
+    erase.NbPages   = 1;
+
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    return HAL_FLASHEx_Erase(&erase, &page_error);
+}
+
+/* Erase the page and program the table a double word at a time (~25 ms) */
+bool calib_store(const calib_table_t *table)
+{
+    const uint8_t *src = (const uint8_t*)table;
+
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = calib_flash_erase();
+
+    for (uint32_t offset = 0; (status == HAL_OK) && (offset < sizeof(*table)); offset += 8U) {
+        uint64_t dword = UINT64_MAX;
+        uint32_t size  = sizeof(*table) - offset;
+        memcpy(&dword, src + offset, (size < 8U) ? size : 8U);
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, CALIB_FLASH_ADDR + offset, dword);
+    }
+    HAL_FLASH_Lock();
+
+    return (status == HAL_OK) && calib_valid((const calib_table_t*)CALIB_FLASH_ADDR);
+}
+
+/* Back to the uncalibrated state after the next reset */
+bool calib_erase(void)
+{
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = calib_flash_erase();
+    HAL_FLASH_Lock();
+
+    return status == HAL_OK;
+}
@@ -8,7 +8,8 @@ extern "C" {
 /****************************************************************
  * Includes
 ****************************************************************/
-#include "stm32l4xx_hal_gpio.h"
+#include <stdbool.h>
+#include "stm32l4xx_hal.h"
 
 /****************************************************************
  * Defines
@@ -17,11 +18,29 @@ extern "C" {
 #define HS_SR04_ECHO_PIN  GPIO_PIN_0
 #define HS_SR04_TRIG_PORT GPIOA
 #define HS_SR04_TRIG_PIN  GPIO_PIN_6
+#define HS_SR04_ECHO_RING       4U       // Completed echoes in flight, power of 2
+
+// Echo validation
+#define HS_SR04_ECHO_MIN_US     116U     // 2 cm, closer is below the sensor's range
+#define HS_SR04_ECHO_MAX_US     23300U   // 400 cm, longer is the no-object pulse
+#define HS_SR04_RISE_MIN_US     100U     // Trigger end -> echo rise: the 40 kHz burst
+#define HS_SR04_RISE_MAX_US     3000U    //   goes out first, slow clones take ~2 ms
+#define HS_SR04_LONG_MARGIN_US  1000U    // Past the longest echo, to see a LONG pulse end
+// Longest wait for an echo [us]: the latest rise, the longest echo and the margin
+#define HS_SR04_ECHO_TIMEOUT_US (HS_SR04_RISE_MAX_US + HS_SR04_ECHO_MAX_US + HS_SR04_LONG_MARGIN_US)
+#define HS_SR04_JUMP_US         1750U    // ~30 cm between consecutive echoes
+#define HS_SR04_MIN_CONFIDENCE  70U      // Lower confidence is dropped [%]
+#define HS_SR04_CONFIRM_US      290U     // ~5 cm: echoes on the same level (level tracking)
+#define HS_SR04_AGREE_US        150U     // ~2.5 cm: an earlier echo agrees (confirm mode)
+#define HS_SR04_AGREE_OFFSET_US 600U     // ... only from a ping this far off in its jitter
+#define HS_SR04_AGREE_VOTES     5U       // Earlier echoes that must agree
+#define HS_SR04_AGREE_DEPTH     24U      // Recent echoes kept to agree with
+#define HS_SR04_EXCURSION_MAX   3U       // Echoes off the level and back = false accepts
 
 /****************************************************************
  * Typedefs
 ****************************************************************/
-typedef uint32_t timer_tick_t;
+typedef uint32_t timer_tick_t;   // timebase_now32() [us]
 typedef float hcsr04_distance_t;
 
 typedef enum {
@@ -29,22 +48,68 @@ typedef enum {
     ECHO_CAPTURED = 1
 } echo_t;
 
-typedef enum{
-    WAITING_RISING_EDGE  = 0,
-    WAITING_FALLING_EDGE = 1,
-    MEASURING_ECHO_DATA  = 2,
-    VALIDATE_MEASURE     = 3,
-    UNKNOWN_ECHO_SPIKES  = 4
-} echo_state_t;
+typedef enum {
+    HCSR04_ECHO_OK       = 0,   // Rising then falling edge
+    HCSR04_ECHO_UNPAIRED = 1    // Falling edge without a rising one (rise_us = fall_us)
+} hcsr04_echo_status_t;
+
+// Completed echo, published by the EXTI ISR
+typedef struct {
+    uint32_t     seq;           // Trigger the echo belongs to
+    timer_tick_t rise_us;
+    timer_tick_t fall_us;
+    uint8_t      status;        // hcsr04_echo_status_t
+    uint8_t      edges;         // Edges since the trigger, 2 for a clean echo
+} hcsr04_echo_t;
+
+// Why a measurement lost confidence, in order of severity
+typedef enum {
+    HCSR04_REASON_OK = 0,       // Clean echo
+    HCSR04_REASON_TIMEOUT,      // No echo within HS_SR04_ECHO_TIMEOUT_US
+    HCSR04_REASON_UNPAIRED,     // Falling edge without a rising one
+    HCSR04_REASON_SHORT,        // Pulse below HS_SR04_ECHO_MIN_US
+    HCSR04_REASON_LONG,         // Pulse above HS_SR04_ECHO_MAX_US
+    HCSR04_REASON_RISE,         // Trigger -> rise delay out of window
+    HCSR04_REASON_JUMP,         // Disagrees with the previous echo
+    HCSR04_REASON_UNCONFIRMED,  // Confirm mode: too few earlier echoes agree
+    HCSR04_REASON_EDGES,        // Extra edges (glitch) before the echo
+    HCSR04_REASON_COUNT
+} hcsr04_reason_t;
+
+// Validated measurement of one trigger
+typedef struct {
+    timer_tick_t echo_us;       // Pulse width, 0 if dropped
+    timer_tick_t capture_us;    // Falling edge of the echo, or when the ping timed out
+    uint8_t      confidence;    // [%]
+    uint8_t      reason;        // hcsr04_reason_t, main deduction (may be set when accepted)
+} hcsr04_result_t;
+
+typedef struct {
+    uint32_t records;           // Published by the ISR
+    uint32_t dropped;           // Ring full, not published
+    uint32_t stale;             // Read but not for the last trigger
+    uint32_t accepted;          // Measurements at or above HS_SR04_MIN_CONFIDENCE
+    uint32_t false_accepts;     // Accepted, then the echoes went back to the level before
+    uint32_t reasons[HCSR04_REASON_COUNT];  // Measurements per final reason
+} hcsr04_echo_stats_t;
 
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
 HAL_StatusTypeDef HCSR04_Init(void);
-void HCSR04_Trigger(void);
+timer_tick_t HCSR04_Trigger(void);
 float HCSR04_measure_distance_cm(void);
+timer_tick_t HCSR04_measure_echo_us(void);
+hcsr04_distance_t HCSR04_echo_to_cm(timer_tick_t echo_us);
 void delay_us(uint32_t us);
 
+void HCSR04_EchoEdge(timer_tick_t now, GPIO_PinState level);
+bool HCSR04_ReadEcho(hcsr04_echo_t *echo);
+bool HCSR04_PollEcho(hcsr04_result_t *result, bool timed_out);
+void HCSR04_SetConfirm(bool enable);
+void HCSR04_SetPingOffset(timer_tick_t offset_us);
+void HCSR04_GetEchoStats(hcsr04_echo_stats_t *stats);
+
 
 #ifdef __cplusplus
 }
@@ -12,6 +12,8 @@
  ******************************************************************************/
 #include "main.h"
 #include "hcsr04.h"
+#include "timebase.h"
+#include "irq_conf.h"
 
 /*******************************************************************************
  * Defines
@@ -20,15 +22,50 @@
 /*******************************************************************************
  * Typedefs
  ******************************************************************************/
-extern TIM_HandleTypeDef htim2;
-
 
 /*******************************************************************************
  * Variables
  ******************************************************************************/
-extern volatile timer_tick_t start_time;
-extern volatile timer_tick_t end_time;
-extern volatile echo_state_t echo_state;
+/* Single producer (EXTI ISR), single consumer (main loop) ring of completed
+ * echoes. Each index has one writer and the consumer never masks
+ * interrupts: a record is written before head moves past it and read
+ * before tail releases it. */
+static hcsr04_echo_t     echo_ring[HS_SR04_ECHO_RING];
+static volatile uint32_t echo_head    = 0;   // Written by the ISR only
+static volatile uint32_t echo_tail    = 0;   // Written by the consumer only
+static volatile uint32_t echo_records = 0;   // ISR
+static volatile uint32_t echo_dropped = 0;   // ISR
+static uint32_t          echo_stale   = 0;   // Consumer
+static uint32_t          echo_accepted = 0;  // Consumer
+static uint32_t          echo_reasons[HCSR04_REASON_COUNT];
+
+static volatile uint32_t echo_trigger_seq = 0;  // Written by HCSR04_Trigger only
+
+/* ISR private edge state */
+static bool              echo_high     = false;
+static timer_tick_t      echo_rise_us  = 0;
+static uint32_t          echo_rise_seq = 0;
+static uint32_t          echo_edge_seq = 0;
+static uint8_t           echo_edges    = 0;
+
+/* Validation state (consumer) */
+static timer_tick_t      echo_trigger_us = 0;  // End of the last trigger pulse
+static timer_tick_t      echo_prev_us    = 0;  // Last in-window echo, accepted or not
+static bool              echo_prev_valid = false;
+static bool              echo_confirm    = false;  // Accept only echoes earlier ones agree with
+static timer_tick_t      echo_offset_us  = 0;      // Caller's jitter ahead of the last trigger
+static timer_tick_t      echo_hist_us[HS_SR04_AGREE_DEPTH];         // Recent in-window echoes
+static timer_tick_t      echo_hist_offset_us[HS_SR04_AGREE_DEPTH];  // and the offsets of their pings
+static uint32_t          echo_hist_count = 0;
+static uint32_t          echo_hist_next  = 0;
+static timer_tick_t      echo_level_us   = 0;      // Width before the current excursion
+static bool              echo_level_valid = false;
+static uint8_t           echo_excursion  = 0;      // Echoes off the level so far
+static uint8_t           echo_excursion_accepts = 0;
+static uint32_t          echo_false_accepts = 0;
+static uint32_t          echo_poll_seq   = 0;  // Trigger being validated
+static bool              echo_decided    = false;
+static hcsr04_result_t   echo_best;            // Best rejected echo of that trigger
 
 
 /*******************************************************************************
@@ -61,61 +98,354 @@ HAL_StatusTypeDef HCSR04_Init(void)
     
 
     // Omogući EXTI prekid
-    HAL_NVIC_SetPriority(EXTI0_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(EXTI0_IRQn, IRQ_PRIO_ECHO, 0);
     HAL_NVIC_EnableIRQ(EXTI0_IRQn);
 
 
     return HAL_OK;
 }
 
-// Funkcija koja meri udaljenost (u cm)
-float HCSR04_measure_distance_cm(void)
+// Echo edge from the EXTI ISR: now = timestamp taken on entry, level = pin after the edge
+void HCSR04_EchoEdge(timer_tick_t now, GPIO_PinState level)
+{
+    hcsr04_echo_t echo;
+
+    uint32_t seq = echo_trigger_seq;
+    if(seq != echo_edge_seq)
+    {
+        echo_edge_seq = seq;
+        echo_edges    = 0;
+    }
+    if(echo_edges < UINT8_MAX)
+    {
+        echo_edges++;
+    }
+
+    if(level == GPIO_PIN_SET)
+    {
+        echo_high     = true;
+        echo_rise_us  = now;
+        echo_rise_seq = seq;
+        return;
+    }
+
+    if(echo_high)
+    {
+        echo.seq     = echo_rise_seq;
+        echo.rise_us = echo_rise_us;
+        echo.status  = HCSR04_ECHO_OK;
+    }
+    else
+    {
+        echo.seq     = seq;
+        echo.rise_us = now;
+        echo.status  = HCSR04_ECHO_UNPAIRED;
+    }
+    echo.fall_us = now;
+    echo.edges   = echo_edges;
+    echo_high    = false;
+
+    uint32_t head = echo_head;
+    if(head - echo_tail >= HS_SR04_ECHO_RING)
+    {
+        echo_dropped++;    // Consumer fell behind; keep the older records
+        return;
+    }
+    echo_ring[head & (HS_SR04_ECHO_RING - 1U)] = echo;
+    __DMB();               // Record complete before it is published
+    echo_head = head + 1U;
+    echo_records++;
+}
+
+// Oldest unread echo, false if none. Never blocks, never masks interrupts.
+bool HCSR04_ReadEcho(hcsr04_echo_t *echo)
+{
+    uint32_t tail = echo_tail;
+
+    if(tail == echo_head)
+    {
+        return false;
+    }
+    __DMB();               // Head seen before the record is read
+    *echo = echo_ring[tail & (HS_SR04_ECHO_RING - 1U)];
+    __DMB();               // Record copied before the slot is released
+    echo_tail = tail + 1U;
+    return true;
+}
+
+void HCSR04_GetEchoStats(hcsr04_echo_stats_t *stats)
 {
-    if(echo_state == MEASURING_ECHO_DATA)
+    stats->records  = echo_records;
+    stats->dropped  = echo_dropped;
+    stats->stale    = echo_stale;
+    stats->accepted = echo_accepted;
+    stats->false_accepts = echo_false_accepts;
+    for(uint32_t i = 0; i < HCSR04_REASON_COUNT; i++)
     {
-        uint32_t duration;
+        stats->reasons[i] = echo_reasons[i];
+    }
+}
+
+/* Interference with pings jittered by the caller: an echo is accepted
+ * only when enough earlier ones, pinged at other offsets, agree with it
+ * (HCSR04_Confirmed). Call before the first trigger. */
+void HCSR04_SetConfirm(bool enable)
+{
+    echo_confirm = enable;
+}
+
+/* The caller's jitter ahead of the next trigger */
+void HCSR04_SetPingOffset(timer_tick_t offset_us)
+{
+    echo_offset_us = offset_us;
+}
+
+static timer_tick_t HCSR04_Diff(timer_tick_t a, timer_tick_t b)
+{
+    return (a > b) ? a - b : b - a;
+}
 
-        if(end_time >= start_time)
-            duration = end_time - start_time;
-        else
-            duration = (0xFFFFFFFF - start_time) + end_time + 1;
+/* A foreign burst lands at the same time after our trigger only for the
+ * same ping offset: echoes it cuts agree with each other at one offset,
+ * our own echoes at every offset. Votes come from earlier echoes at an
+ * offset at least HS_SR04_AGREE_OFFSET_US away. The echo joins the history
+ * either way. */
+static bool HCSR04_Confirmed(timer_tick_t width)
+{
+    uint32_t votes = 0;
 
-        if(duration == 0){
-            return -1.0f;
+    for(uint32_t i = 0; i < echo_hist_count; i++)
+    {
+        if((HCSR04_Diff(width, echo_hist_us[i]) <= HS_SR04_AGREE_US) &&
+           (HCSR04_Diff(echo_offset_us, echo_hist_offset_us[i]) >= HS_SR04_AGREE_OFFSET_US))
+        {
+            votes++;
         }
-        echo_state = VALIDATE_MEASURE;
+    }
+    echo_hist_us[echo_hist_next]        = width;
+    echo_hist_offset_us[echo_hist_next] = echo_offset_us;
+    echo_hist_next = (echo_hist_next + 1U) % HS_SR04_AGREE_DEPTH;
+    if(echo_hist_count < HS_SR04_AGREE_DEPTH)
+    {
+        echo_hist_count++;
+    }
+    return votes >= HS_SR04_AGREE_VOTES;
+}
 
-        // brzina zvuka ~343 m/s => 0.0343 cm/us
-        // udaljenost = (vreme u us) * brzina / 2
-        float distance = (duration * 0.0343f) / 2.0f;
+/* No ground truth on the target: an accepted echo counts as false when the
+ * echoes leave the level and come back to it within HS_SR04_EXCURSION_MAX
+ * echoes. A longer excursion is a real change and becomes the new level. */
+static void HCSR04_TrackLevel(timer_tick_t width, bool accepted)
+{
+    if(!echo_level_valid || (HCSR04_Diff(width, echo_level_us) <= HS_SR04_CONFIRM_US))
+    {
+        echo_false_accepts += echo_excursion_accepts;
+        echo_level_us          = width;
+        echo_level_valid       = true;
+        echo_excursion         = 0;
+        echo_excursion_accepts = 0;
+        return;
+    }
 
-        return distance;
+    echo_excursion++;
+    echo_excursion_accepts += accepted ? 1U : 0U;
+    if(echo_excursion > HS_SR04_EXCURSION_MAX)
+    {
+        echo_level_us          = width;
+        echo_excursion         = 0;
+        echo_excursion_accepts = 0;
+    }
+}
+
+/* Confidence of one echo: out-of-window pulses are worthless, a late rise,
+ * a jump from the previous echo or glitch edges each cost some of it. Two
+ * echoes in a row that agree after a jump bring it back, so a real step
+ * in distance is accepted one measurement later. In confirm mode an echo
+ * the earlier ones at other ping offsets do not agree with is dropped. */
+static void HCSR04_Validate(const hcsr04_echo_t *echo, hcsr04_result_t *result)
+{
+    // Low words of the timebase: the differences are right across a wrap
+    timer_tick_t width = echo->fall_us - echo->rise_us;
+    timer_tick_t rise  = echo->rise_us - echo_trigger_us;
+    int32_t confidence = 100;
+    uint8_t reason     = HCSR04_REASON_OK;
+
+    result->echo_us    = width;
+    result->capture_us = echo->fall_us;
+
+    if(echo->status != HCSR04_ECHO_OK)
+    {
+        confidence = 0;
+        reason     = HCSR04_REASON_UNPAIRED;
+    }
+    else if(width < HS_SR04_ECHO_MIN_US)
+    {
+        confidence = 0;
+        reason     = HCSR04_REASON_SHORT;
+    }
+    else if(width > HS_SR04_ECHO_MAX_US)
+    {
+        confidence = 0;
+        reason     = HCSR04_REASON_LONG;
     }
     else
+    {
+        if((rise < HS_SR04_RISE_MIN_US) || (rise > HS_SR04_RISE_MAX_US))
+        {
+            confidence -= 50;
+            reason      = HCSR04_REASON_RISE;
+        }
+        if(echo_confirm)
+        {
+            if(!HCSR04_Confirmed(width))
+            {
+                confidence  = 0;
+                reason      = (reason == HCSR04_REASON_OK) ? HCSR04_REASON_UNCONFIRMED : reason;
+            }
+        }
+        else if(echo_prev_valid && (HCSR04_Diff(width, echo_prev_us) > HS_SR04_JUMP_US))
+        {
+            confidence -= 40;
+            reason      = (reason == HCSR04_REASON_OK) ? HCSR04_REASON_JUMP : reason;
+        }
+        if(echo->edges > 2U)
+        {
+            confidence -= 30;
+            reason      = (reason == HCSR04_REASON_OK) ? HCSR04_REASON_EDGES : reason;
+        }
+        echo_prev_us    = width;
+        echo_prev_valid = true;
+        HCSR04_TrackLevel(width, confidence >= (int32_t)HS_SR04_MIN_CONFIDENCE);
+    }
+
+    result->confidence = (confidence > 0) ? (uint8_t)confidence : 0U;
+    result->reason     = reason;
+}
+
+static void HCSR04_Count(const hcsr04_result_t *result)
+{
+    echo_reasons[result->reason]++;
+    if(result->confidence >= HS_SR04_MIN_CONFIDENCE)
+    {
+        echo_accepted++;
+    }
+}
+
+/* Validated result of the last trigger. Returns true once, when it is
+ * decided: an echo reached HS_SR04_MIN_CONFIDENCE, or the echo pin fell
+ * at the end of a pulse of at least HS_SR04_ECHO_MIN_US (the sensor does
+ * not raise it again for this trigger), or the caller's timeout ran out.
+ * A rejected result is the best echo with echo_us = 0, or TIMEOUT. A
+ * shorter pulse is a glitch ahead of the echo, so the wait goes on.
+ * Never blocks. */
+bool HCSR04_PollEcho(hcsr04_result_t *result, bool timed_out)
+{
+    hcsr04_echo_t echo;
+    uint32_t seq = echo_trigger_seq;
+    bool ended = false;
+
+    if(echo_poll_seq != seq)
+    {
+        echo_poll_seq        = seq;
+        echo_decided         = false;
+        echo_best.echo_us    = 0;
+        echo_best.confidence = 0;
+        echo_best.reason     = HCSR04_REASON_TIMEOUT;
+    }
+
+    while(HCSR04_ReadEcho(&echo))
+    {
+        if((echo.seq != seq) || echo_decided)
+        {
+            echo_stale++;
+            continue;
+        }
+
+        HCSR04_Validate(&echo, result);
+        if(result->confidence >= HS_SR04_MIN_CONFIDENCE)
+        {
+            HCSR04_Count(result);
+            echo_decided = true;
+            return true;
+        }
+        if((echo_best.reason == HCSR04_REASON_TIMEOUT) || (result->confidence > echo_best.confidence))
+        {
+            echo_best = *result;
+        }
+        if((echo.status == HCSR04_ECHO_OK) && (result->echo_us >= HS_SR04_ECHO_MIN_US))
+        {
+            ended = true;      // Later records of this trigger are stale
+            break;
+        }
+    }
+
+    if((!timed_out && !ended) || echo_decided)
+    {
+        return false;
+    }
+    *result         = echo_best;
+    result->echo_us = 0;             // Dropped before it reaches the buzzer
+    if(result->reason == HCSR04_REASON_TIMEOUT)
+    {
+        result->capture_us = timebase_now32();   // No echo: known from now on
+    }
+    HCSR04_Count(result);
+    echo_decided    = true;
+    return true;
+}
+
+// Funkcija koja vraca trajanje echo impulsa (u us) za poslednji trigger, 0 ako merenje nije gotovo
+timer_tick_t HCSR04_measure_echo_us(void)
+{
+    hcsr04_result_t result;
+
+    if(HCSR04_PollEcho(&result, false))
+    {
+        return result.echo_us;
+    }
+    return 0; // Nema validnog merenja
+}
+
+hcsr04_distance_t HCSR04_echo_to_cm(timer_tick_t echo_us)
+{
+    // brzina zvuka ~343 m/s => 0.0343 cm/us
+    // udaljenost = (vreme u us) * brzina / 2
+    return (echo_us * 0.0343f) / 2.0f;
+}
+
+// Funkcija koja meri udaljenost (u cm)
+float HCSR04_measure_distance_cm(void)
+{
+    timer_tick_t echo_us = HCSR04_measure_echo_us();
+
+    if(echo_us == 0)
     {
         return -1.0f; // Nema validnog merenja
     }
+
+    return HCSR04_echo_to_cm(echo_us);
 }
 
 void delay_us(uint32_t us)
 {
-    __HAL_TIM_SET_COUNTER(&htim3, 0);  // reset counter
-    HAL_TIM_Base_Start(&htim3);
-    while (__HAL_TIM_GET_COUNTER(&htim3) < us);
-    HAL_TIM_Base_Stop(&htim3);
+    timebase_delay_us(us + 1U);  // tick in progress does not count
 }
 
 
-void HCSR04_Trigger(void)
+// Returns the end of the trigger pulse, the reference of the echo rise window
+timer_tick_t HCSR04_Trigger(void)
 {
-    HAL_GPIO_WritePin(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_RESET); // resetuj za svaki slučaj
+    echo_trigger_seq++;   // Edges from here on belong to this trigger
+    IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_RESET); // resetuj za svaki slučaj
     delay_us(2); // mini delay da se očisti
     // Set TRIG pin HIGH to start the ultrasonic burst
-    HAL_GPIO_WritePin(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_SET);
+    IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_SET);
     
     // Wait for 20 microseconds (pulse duration required by HC-SR04)
     delay_us(10);
     
     // Set TRIG pin LOW to finish the pulse
-    HAL_GPIO_WritePin(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_RESET);
+    IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_RESET);
+    echo_trigger_us = timebase_now32();   // The burst starts here
+    return echo_trigger_us;
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef _I2C_BUS_H
+#define _I2C_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32l4xx_hal.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define I2C_XFER_REG_INCREMENT   0x01U   /**< Register address advances with every chunk
+                                              (auto-incrementing memories) */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+/* Lower value = more urgent. A transfer is never interrupted in the middle
+ * of a chunk, only between chunks. */
+typedef enum {
+    I2C_PRIO_HIGH = 0,                  /**< Short sensor reads */
+    I2C_PRIO_NORMAL,                    /**< Commands, blocking calls */
+    I2C_PRIO_BULK,                      /**< Framebuffer pushes, EEPROM pages */
+    I2C_PRIO_COUNT
+} i2c_prio_t;
+
+typedef enum {
+    I2C_XFER_WRITE = 0,
+    I2C_XFER_READ
+} i2c_xfer_dir_t;
+
+typedef enum {
+    I2C_XFER_IDLE = 0,                  /**< Not queued; status holds the last result */
+    I2C_XFER_QUEUED                     /**< Waiting, on the bus or between chunks */
+} i2c_xfer_state_t;
+
+typedef struct {
+    uint32_t xfers;                     /**< Completed transfers */
+    uint32_t errors;                    /**< Failed transfers */
+    uint32_t bytes;                     /**< Payload bytes moved */
+    uint32_t busy_us;                   /**< Bus time of this device's chunks */
+    uint32_t wait_max_us;               /**< Longest submit -> first chunk on the bus */
+} i2c_dev_stats_t;
+
+typedef struct i2c_bus i2c_bus_t;
+typedef struct i2c_xfer i2c_xfer_t;
+
+/* One slave on a bus */
+typedef struct i2c_dev {
+    i2c_bus_t      *bus;
+    uint16_t        address;            /**< Shifted 8-bit address */
+    const char     *name;
+    i2c_dev_stats_t stats;
+    struct i2c_dev *next;
+} i2c_dev_t;
+
+typedef void (*i2c_xfer_done_t)(i2c_xfer_t *xfer);
+
+/* Transaction descriptor. The owner fills in the request fields and keeps
+ * the descriptor and its buffer alive until it is idle again. */
+struct i2c_xfer {
+    i2c_dev_t        *dev;
+    i2c_xfer_dir_t    dir;
+    i2c_prio_t        prio;
+    uint8_t           flags;            /**< I2C_XFER_* */
+    uint8_t           reg_size;         /**< 0 = no register address, 1 or 2 bytes */
+    uint16_t          reg;              /**< Register address or control byte */
+    uint8_t          *data;
+    uint16_t          size;
+    uint16_t          chunk;            /**< Longest bus transaction, 0 = whole transfer */
+    i2c_xfer_done_t   done;             /**< Completion callback (I2C ISR), may be NULL */
+    void             *context;          /**< For the owner's callback */
+
+    /* Managed by the bus */
+    volatile uint8_t  state;            /**< i2c_xfer_state_t */
+    HAL_StatusTypeDef status;           /**< Result once idle */
+    uint16_t          offset;           /**< Bytes already moved */
+    uint32_t          submit_us;
+    i2c_xfer_t       *next;
+};
+
+/* Transaction manager of one I2C peripheral: a FIFO per priority, run back
+ * to back by DMA from the completion interrupts */
+struct i2c_bus {
+    I2C_HandleTypeDef *hi2c;
+    i2c_xfer_t        *queue[I2C_PRIO_COUNT];
+    i2c_xfer_t        *active;          /**< Transfer with a chunk on the bus */
+    i2c_xfer_t        *resume;          /**< Transfer interrupted between chunks */
+    uint16_t           chunk_len;
+    uint32_t           chunk_start_us;
+    uint32_t           preemptions;     /**< Chunked transfers overtaken by a more urgent one */
+    i2c_dev_t         *devices;
+    struct i2c_bus    *next;
+};
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void i2c_bus_init(i2c_bus_t *bus, I2C_HandleTypeDef *hi2c);
+i2c_bus_t *i2c_bus_find(I2C_HandleTypeDef *hi2c);
+void i2c_dev_init(i2c_dev_t *dev, i2c_bus_t *bus, uint16_t address, const char *name);
+
+HAL_StatusTypeDef i2c_bus_submit(i2c_xfer_t *xfer);
+bool i2c_bus_cancel(i2c_xfer_t *xfer);
+bool i2c_bus_busy(const i2c_bus_t *bus);
+bool i2c_bus_wait_idle(const i2c_bus_t *bus, uint32_t timeout_ms);
+void i2c_bus_abort(i2c_bus_t *bus);
+
+HAL_StatusTypeDef i2c_dev_write(i2c_dev_t *dev, uint16_t reg, uint8_t reg_size,
+                                uint8_t *data, uint16_t size, uint32_t timeout_ms);
+HAL_StatusTypeDef i2c_dev_read(i2c_dev_t *dev, uint16_t reg, uint8_t reg_size,
+                               uint8_t *data, uint16_t size, uint32_t timeout_ms);
+void i2c_dev_get_stats(const i2c_dev_t *dev, i2c_dev_stats_t *stats);
+void i2c_dev_clear_stats(i2c_dev_t *dev);
+
+/* Weak hooks */
+uint32_t i2c_bus_time_us(void);
+void i2c_bus_on_error(i2c_bus_t *bus, uint32_t error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _I2C_BUS_H */
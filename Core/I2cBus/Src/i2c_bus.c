@@ -0,0 +1,434 @@
+/**
+ * @file    i2c_bus.c
+ * @brief   Parking-Sensor project.
+ * @details I2C transaction manager. Every device on a bus submits transfer
+ *          descriptors; the bus runs them back to back from the completion
+ *          interrupts, by DMA where the HAL handle has a channel linked and
+ *          by interrupt otherwise. Long transfers are split into chunks and
+ *          a more urgent transfer goes on the bus at the next chunk
+ *          boundary, so a sensor read waits for at most one chunk of a
+ *          framebuffer push. The HAL is only touched through the four
+ *          start calls and the completion callbacks, so the manager runs
+ *          unchanged against a host stand-in of those.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "i2c_bus.h"
+#include <stddef.h>
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static i2c_bus_t *i2c_buses;   /**< Buses with a manager, linked through next */
+
+/*******************************************************************************
+ * Weak hooks
+ ******************************************************************************/
+/* Time base for the bus statistics; the application can override it with
+ * a microsecond timer */
+__weak uint32_t i2c_bus_time_us(void)
+{
+    return HAL_GetTick() * 1000U;
+}
+
+/* A transfer failed (error: HAL_I2C_ERROR_*) or a wait for the bus ran out
+ * of time (HAL_I2C_ERROR_TIMEOUT). May run from the I2C ISR. */
+__weak void i2c_bus_on_error(i2c_bus_t *bus, uint32_t error)
+{
+    (void)bus;
+    (void)error;
+}
+
+/*******************************************************************************
+ * Scheduler (runs from the I2C ISR or with interrupts masked)
+ ******************************************************************************/
+static i2c_xfer_t *i2c_bus_next(const i2c_bus_t *bus)
+{
+    for (uint32_t prio = 0; prio < I2C_PRIO_COUNT; prio++) {
+        if (bus->queue[prio] != NULL) {
+            return bus->queue[prio];
+        }
+    }
+    return NULL;
+}
+
+static HAL_StatusTypeDef i2c_bus_start(i2c_bus_t *bus, i2c_xfer_t *xfer, uint16_t len)
+{
+    I2C_HandleTypeDef *hi2c = bus->hi2c;
+    uint16_t address = xfer->dev->address;
+    uint8_t *data = &xfer->data[xfer->offset];
+    uint16_t reg = xfer->reg + ((xfer->flags & I2C_XFER_REG_INCREMENT) ? xfer->offset : 0U);
+    uint16_t reg_size = (xfer->reg_size == 2U) ? I2C_MEMADD_SIZE_16BIT : I2C_MEMADD_SIZE_8BIT;
+
+    if (xfer->dir == I2C_XFER_WRITE) {
+        if (xfer->reg_size == 0U) {
+            return (hi2c->hdmatx != NULL) ? HAL_I2C_Master_Transmit_DMA(hi2c, address, data, len)
+                                          : HAL_I2C_Master_Transmit_IT(hi2c, address, data, len);
+        }
+        return (hi2c->hdmatx != NULL) ? HAL_I2C_Mem_Write_DMA(hi2c, address, reg, reg_size, data, len)
+                                      : HAL_I2C_Mem_Write_IT(hi2c, address, reg, reg_size, data, len);
+    }
+
+    if (xfer->reg_size == 0U) {
+        return (hi2c->hdmarx != NULL) ? HAL_I2C_Master_Receive_DMA(hi2c, address, data, len)
+                                      : HAL_I2C_Master_Receive_IT(hi2c, address, data, len);
+    }
+    return (hi2c->hdmarx != NULL) ? HAL_I2C_Mem_Read_DMA(hi2c, address, reg, reg_size, data, len)
+                                  : HAL_I2C_Mem_Read_IT(hi2c, address, reg, reg_size, data, len);
+}
+
+/* The transfer is the head of its queue: unlink it and tell the owner */
+static void i2c_bus_finish(i2c_bus_t *bus, i2c_xfer_t *xfer, HAL_StatusTypeDef status)
+{
+    bus->queue[xfer->prio] = xfer->next;
+    if (bus->resume == xfer) {
+        bus->resume = NULL;
+    }
+    xfer->next = NULL;
+    xfer->status = status;
+    if (status == HAL_OK) {
+        xfer->dev->stats.xfers++;
+    } else {
+        xfer->dev->stats.errors++;
+    }
+    xfer->state = I2C_XFER_IDLE;
+
+    if (xfer->done != NULL) {
+        xfer->done(xfer);
+    }
+}
+
+/* Put the next chunk on the bus if it is free */
+static void i2c_bus_dispatch(i2c_bus_t *bus)
+{
+    i2c_xfer_t *xfer;
+
+    while (bus->active == NULL && (xfer = i2c_bus_next(bus)) != NULL) {
+        uint32_t now = i2c_bus_time_us();
+        uint16_t len = xfer->size - xfer->offset;
+
+        if (xfer->chunk != 0U && len > xfer->chunk) {
+            len = xfer->chunk;
+        }
+        if (bus->resume != NULL && bus->resume != xfer) {
+            bus->preemptions++;
+            bus->resume = NULL;
+        }
+        if (xfer->offset == 0U && now - xfer->submit_us > xfer->dev->stats.wait_max_us) {
+            xfer->dev->stats.wait_max_us = now - xfer->submit_us;
+        }
+
+        bus->active = xfer;
+        bus->chunk_len = len;
+        bus->chunk_start_us = now;
+        if (i2c_bus_start(bus, xfer, len) == HAL_OK) {
+            return;
+        }
+        bus->active = NULL;
+        i2c_bus_finish(bus, xfer, HAL_ERROR);
+    }
+}
+
+static void i2c_bus_complete(I2C_HandleTypeDef *hi2c, HAL_StatusTypeDef status)
+{
+    i2c_bus_t *bus = i2c_bus_find(hi2c);
+    if (bus == NULL || bus->active == NULL) {
+        return;   /* Late completion after an abort */
+    }
+
+    i2c_xfer_t *xfer = bus->active;
+    bus->active = NULL;
+    xfer->dev->stats.busy_us += i2c_bus_time_us() - bus->chunk_start_us;
+    if (status == HAL_OK) {
+        xfer->offset += bus->chunk_len;
+        xfer->dev->stats.bytes += bus->chunk_len;
+    }
+
+    if (status != HAL_OK || xfer->offset >= xfer->size) {
+        i2c_bus_finish(bus, xfer, status);
+    } else {
+        bus->resume = xfer;
+    }
+    i2c_bus_dispatch(bus);
+}
+
+/*******************************************************************************
+ * HAL callbacks
+ ******************************************************************************/
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2c_bus_complete(hi2c, HAL_OK);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2c_bus_complete(hi2c, HAL_OK);
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2c_bus_complete(hi2c, HAL_OK);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2c_bus_complete(hi2c, HAL_OK);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2c_bus_t *bus = i2c_bus_find(hi2c);
+    if (bus == NULL) {
+        return;
+    }
+
+    i2c_bus_on_error(bus, hi2c->ErrorCode);
+    i2c_bus_complete(hi2c, HAL_ERROR);
+}
+
+/*******************************************************************************
+ * Setup
+ ******************************************************************************/
+void i2c_bus_init(i2c_bus_t *bus, I2C_HandleTypeDef *hi2c)
+{
+    bus->hi2c = hi2c;
+    for (uint32_t prio = 0; prio < I2C_PRIO_COUNT; prio++) {
+        bus->queue[prio] = NULL;
+    }
+    bus->active = NULL;
+    bus->resume = NULL;
+    bus->preemptions = 0;
+
+    if (i2c_bus_find(hi2c) != bus) {
+        bus->devices = NULL;
+        bus->next = i2c_buses;
+        i2c_buses = bus;
+    }
+}
+
+i2c_bus_t *i2c_bus_find(I2C_HandleTypeDef *hi2c)
+{
+    for (i2c_bus_t *bus = i2c_buses; bus != NULL; bus = bus->next) {
+        if (bus->hi2c == hi2c) {
+            return bus;
+        }
+    }
+    return NULL;
+}
+
+/* Devices are listed in the order they are added; adding one again (e.g.
+ * on a re-init) keeps its place and statistics */
+void i2c_dev_init(i2c_dev_t *dev, i2c_bus_t *bus, uint16_t address, const char *name)
+{
+    i2c_dev_t **link = &bus->devices;
+
+    dev->address = address;
+    dev->name = name;
+    while (*link != NULL) {
+        if (*link == dev) {
+            return;
+        }
+        link = &(*link)->next;
+    }
+
+    dev->bus = bus;
+    dev->stats = (i2c_dev_stats_t){ 0 };
+    dev->next = NULL;
+    *link = dev;
+}
+
+/*******************************************************************************
+ * Asynchronous transfers
+ ******************************************************************************/
+/**
+ * @brief  Queue a transfer behind others of the same priority. The done
+ *         callback runs from the I2C ISR (or from here if the transfer
+ *         cannot be started).
+ * @retval HAL_BUSY if the descriptor is still queued, HAL_ERROR if it is
+ *         malformed, HAL_OK otherwise.
+ */
+HAL_StatusTypeDef i2c_bus_submit(i2c_xfer_t *xfer)
+{
+    if (xfer->state != I2C_XFER_IDLE) {
+        return HAL_BUSY;
+    }
+    if (xfer->size == 0U || xfer->data == NULL || xfer->prio >= I2C_PRIO_COUNT) {
+        return HAL_ERROR;
+    }
+
+    i2c_bus_t *bus = xfer->dev->bus;
+    xfer->offset = 0;
+    xfer->next = NULL;
+    xfer->submit_us = i2c_bus_time_us();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    i2c_xfer_t **link = &bus->queue[xfer->prio];
+    while (*link != NULL) {
+        link = &(*link)->next;
+    }
+    *link = xfer;
+    xfer->state = I2C_XFER_QUEUED;
+    i2c_bus_dispatch(bus);
+    __set_PRIMASK(primask);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Take a transfer off the queue without calling its callback.
+ * @retval false if it has a chunk on the bus right now.
+ */
+bool i2c_bus_cancel(i2c_xfer_t *xfer)
+{
+    i2c_bus_t *bus = xfer->dev->bus;
+    bool idle = true;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (xfer->state != I2C_XFER_IDLE) {
+        if (bus->active == xfer) {
+            idle = false;
+        } else {
+            i2c_xfer_t **link = &bus->queue[xfer->prio];
+            while (*link != NULL && *link != xfer) {
+                link = &(*link)->next;
+            }
+            if (*link == xfer) {
+                *link = xfer->next;
+            }
+            if (bus->resume == xfer) {
+                bus->resume = NULL;
+            }
+            xfer->next = NULL;
+            xfer->status = HAL_ERROR;
+            xfer->dev->stats.errors++;
+            xfer->state = I2C_XFER_IDLE;
+        }
+    }
+    __set_PRIMASK(primask);
+
+    return idle;
+}
+
+bool i2c_bus_busy(const i2c_bus_t *bus)
+{
+    return bus->active != NULL || i2c_bus_next(bus) != NULL;
+}
+
+bool i2c_bus_wait_idle(const i2c_bus_t *bus, uint32_t timeout_ms)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (i2c_bus_busy(bus)) {
+        if (HAL_GetTick() - start >= timeout_ms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Stop the DMA and drop every queued transfer as failed, without
+ *        callbacks. The I2C peripheral itself must be reset by the caller
+ *        (MX_I2C2_Recover); a late completion is ignored.
+ */
+void i2c_bus_abort(i2c_bus_t *bus)
+{
+    if (bus->hi2c->hdmatx != NULL) {
+        HAL_DMA_Abort(bus->hi2c->hdmatx);
+    }
+    if (bus->hi2c->hdmarx != NULL) {
+        HAL_DMA_Abort(bus->hi2c->hdmarx);
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (uint32_t prio = 0; prio < I2C_PRIO_COUNT; prio++) {
+        i2c_xfer_t *xfer = bus->queue[prio];
+        while (xfer != NULL) {
+            i2c_xfer_t *next = xfer->next;
+            xfer->next = NULL;
+            xfer->status = HAL_ERROR;
+            xfer->dev->stats.errors++;
+            xfer->state = I2C_XFER_IDLE;
+            xfer = next;
+        }
+        bus->queue[prio] = NULL;
+    }
+    bus->active = NULL;
+    bus->resume = NULL;
+    __set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+ * Blocking transfers
+ ******************************************************************************/
+/* Queued at normal priority, so it overtakes bulk transfers at their next
+ * chunk boundary. The timeout has to cover that chunk as well. */
+static HAL_StatusTypeDef i2c_dev_transfer(i2c_dev_t *dev, i2c_xfer_dir_t dir, uint16_t reg,
+                                          uint8_t reg_size, uint8_t *data, uint16_t size,
+                                          uint32_t timeout_ms)
+{
+    i2c_xfer_t xfer = {
+        .dev      = dev,
+        .dir      = dir,
+        .prio     = I2C_PRIO_NORMAL,
+        .reg_size = reg_size,
+        .reg      = reg,
+        .data     = data,
+        .size     = size,
+    };
+    uint32_t start = HAL_GetTick();
+
+    if (i2c_bus_submit(&xfer) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    while (xfer.state != I2C_XFER_IDLE) {
+        if (HAL_GetTick() - start >= timeout_ms) {
+            if (!i2c_bus_cancel(&xfer)) {
+                i2c_bus_abort(dev->bus);   /* The descriptor lives on this stack */
+            }
+            i2c_bus_on_error(dev->bus, HAL_I2C_ERROR_TIMEOUT);
+            return HAL_TIMEOUT;
+        }
+    }
+    return xfer.status;
+}
+
+HAL_StatusTypeDef i2c_dev_write(i2c_dev_t *dev, uint16_t reg, uint8_t reg_size,
+                                uint8_t *data, uint16_t size, uint32_t timeout_ms)
+{
+    return i2c_dev_transfer(dev, I2C_XFER_WRITE, reg, reg_size, data, size, timeout_ms);
+}
+
+HAL_StatusTypeDef i2c_dev_read(i2c_dev_t *dev, uint16_t reg, uint8_t reg_size,
+                               uint8_t *data, uint16_t size, uint32_t timeout_ms)
+{
+    return i2c_dev_transfer(dev, I2C_XFER_READ, reg, reg_size, data, size, timeout_ms);
+}
+
+/*******************************************************************************
+ * Statistics
+ ******************************************************************************/
+void i2c_dev_get_stats(const i2c_dev_t *dev, i2c_dev_stats_t *stats)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = dev->stats;
+    __set_PRIMASK(primask);
+}
+
+void i2c_dev_clear_stats(i2c_dev_t *dev)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    dev->stats = (i2c_dev_stats_t){ 0 };
+    __set_PRIMASK(primask);
+}
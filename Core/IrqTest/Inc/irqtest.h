@@ -0,0 +1,74 @@
+#ifndef _IRQTEST_H
+#define _IRQTEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "irq_conf.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define IRQTEST_SAMPLES            256U     /**< Entries measured per row */
+#define IRQTEST_BIN_CYCLES         8U       /**< Histogram bin width [cycles] */
+#define IRQTEST_BINS               32U      /**< The last bin counts everything above it */
+#define IRQTEST_TIMEOUT_CYCLES     100000U  /**< No entry after this is a miss */
+
+/* Stand-in for every IRQ of the plan: a free basic timer, so that its
+ * counter tells how long ago the interrupt was raised */
+#define IRQTEST_PROBE_TIM          TIM7
+#define IRQTEST_PROBE_IRQn         TIM7_IRQn
+#define IRQTEST_PROBE_PERIOD_MIN   1000U    /**< Raised after a random 1000..4999 cycles */
+#define IRQTEST_PROBE_PERIOD_SPAN  4000U
+
+/* Synthetic load: a handler as long as a display DMA completion at the
+ * display bus level, and the main loop's masked sections between */
+#define IRQTEST_LOAD_TIM           TIM6
+#define IRQTEST_LOAD_IRQn          TIM6_DAC_IRQn
+#define IRQTEST_LOAD_PRIO          IRQ_PRIO_I2C_DMA
+#define IRQTEST_LOAD_PERIOD_CYCLES 8000U    /**< 100 us at 80 MHz */
+#define IRQTEST_LOAD_BUSY_CYCLES   800U     /**< Handler length [cycles] */
+#define IRQTEST_MASKED_CYCLES      32U      /**< About one trace_put() */
+
+#define IRQTEST_COUNT_ROW(name, prio)  + 1U
+#define IRQTEST_ROWS               (1U IRQ_PLAN(IRQTEST_COUNT_ROW))  /**< EXTI0 itself, then the plan */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+/* Entry latency of one interrupt: from the event that raises it to the
+ * first instruction of its handler */
+typedef struct {
+    const char *name;
+    const char *via;                     /**< "pin", "swi" or "tim7" */
+    uint8_t     prio;
+    uint32_t    count;
+    uint32_t    missed;                  /**< No entry within IRQTEST_TIMEOUT_CYCLES */
+    uint32_t    min;                     /**< [cycles] */
+    uint32_t    max;
+    uint32_t    sum;
+    uint16_t    hist[IRQTEST_BINS];
+} irqtest_row_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void irqtest_run(irqtest_row_t rows[IRQTEST_ROWS]);
+bool irqtest_active(void);
+uint32_t irqtest_percentile(const irqtest_row_t *row, uint32_t pct);
+
+void irqtest_echo_edge(uint32_t entry_cycles);
+void irqtest_probe_irq_handler(void);
+void irqtest_load_irq_handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IRQTEST_H */
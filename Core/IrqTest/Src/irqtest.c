@@ -0,0 +1,273 @@
+/**
+ * @file    irqtest.c
+ * @brief   Parking-Sensor project.
+ * @details Interrupt entry latency self-test for the priority plan in
+ *          irq_conf.h, in DWT cycles. The first row is EXTI0 itself: the
+ *          trigger pin, jumpered to the echo pin with the sensor
+ *          unplugged, is driven with a DWT stamp just before the store
+ *          (or the line is raised by software, without the jumper). Each
+ *          row after it puts TIM7 on one priority of the plan and lets it
+ *          fire at a random moment; the counter, read first in the
+ *          handler, is the time since the interrupt was raised. All rows
+ *          run under the same load: TIM6 interrupts as long as a display
+ *          DMA completion at the display bus level, and a main loop
+ *          doing masked timebase reads, trace-sized masked sections and
+ *          memory copies. Runs once at boot, before the first ping.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "irqtest.h"
+#include "main.h"
+#include "app_conf.h"
+#include "hcsr04.h"
+#include "timebase.h"
+#include <string.h>
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static volatile bool     irqtest_running = false;
+static volatile bool     irqtest_hit     = false;  /**< The measured handler ran */
+static volatile uint32_t irqtest_t0      = 0;      /**< DWT stamp of the EXTI0 trigger */
+static volatile uint32_t irqtest_cycles  = 0;      /**< Entry latency of the last hit */
+static uint32_t          irqtest_scale   = 1U;     /**< CPU cycles per timer tick */
+static uint32_t          irqtest_seed    = 0x2545F491U;
+static uint32_t          irqtest_copy[2][64];      /**< Bus traffic for the load */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static uint32_t irqtest_random(void)
+{
+    irqtest_seed ^= irqtest_seed << 13;
+    irqtest_seed ^= irqtest_seed >> 17;
+    irqtest_seed ^= irqtest_seed << 5;
+    return irqtest_seed;
+}
+
+/* TIM6 and TIM7 count at PCLK1, doubled when APB1 is divided */
+static uint32_t irqtest_tim_scale(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    uint32_t tim_hz = ((RCC->CFGR & RCC_CFGR_PPRE1) == RCC_HCLK_DIV1) ? pclk1 : 2U * pclk1;
+    uint32_t scale = HAL_RCC_GetHCLKFreq() / tim_hz;
+
+    return (scale != 0U) ? scale : 1U;
+}
+
+static void irqtest_tim_init(TIM_TypeDef *tim, IRQn_Type irqn, uint32_t prio)
+{
+    tim->CR1  = TIM_CR1_URS;             // UG below is not an update interrupt
+    tim->PSC  = 0U;
+    tim->EGR  = TIM_EGR_UG;
+    tim->SR   = 0U;
+    tim->DIER = TIM_DIER_UIE;
+    HAL_NVIC_SetPriority(irqn, prio, 0);
+    HAL_NVIC_EnableIRQ(irqn);
+}
+
+static void irqtest_tim_stop(TIM_TypeDef *tim, IRQn_Type irqn)
+{
+    tim->CR1  = 0U;
+    tim->DIER = 0U;
+    tim->SR   = 0U;
+    HAL_NVIC_DisableIRQ(irqn);
+    HAL_NVIC_ClearPendingIRQ(irqn);
+}
+
+/* One slice of main loop work */
+static void irqtest_load_step(uint32_t step)
+{
+    switch (step % 3U) {
+    case 0:
+        (void)timebase_now_us();
+        break;
+    case 1: {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t t0 = DWT->CYCCNT;
+        while ((DWT->CYCCNT - t0) < IRQTEST_MASKED_CYCLES) {
+        }
+        __set_PRIMASK(primask);
+        break;
+    }
+    default:
+        memcpy(irqtest_copy[0], irqtest_copy[1], sizeof(irqtest_copy[0]));
+        break;
+    }
+}
+
+static void irqtest_add(irqtest_row_t *row, uint32_t cycles)
+{
+    uint32_t bin = cycles / IRQTEST_BIN_CYCLES;
+
+    if (row->count == 0U || cycles < row->min) {
+        row->min = cycles;
+    }
+    if (cycles > row->max) {
+        row->max = cycles;
+    }
+    row->sum += cycles;
+    row->count++;
+    row->hist[(bin < IRQTEST_BINS) ? bin : IRQTEST_BINS - 1U]++;
+}
+
+static bool irqtest_wait(uint32_t *step)
+{
+    uint32_t t0 = DWT->CYCCNT;
+
+    while (!irqtest_hit) {
+        if ((DWT->CYCCNT - t0) >= IRQTEST_TIMEOUT_CYCLES) {
+            return false;
+        }
+        irqtest_load_step((*step)++);
+    }
+    return true;
+}
+
+/* EXTI0 through the echo pin's own path */
+static void irqtest_run_exti(irqtest_row_t *row, uint32_t *step)
+{
+    GPIO_PinState level = GPIO_PIN_RESET;
+
+    row->via = APP_IRQ_SELFTEST_LOOPBACK ? "pin" : "swi";
+    for (uint32_t i = 0; i < IRQTEST_SAMPLES; i++) {
+        /* A random amount of load first, so that the trigger falls
+         * anywhere in the TIM6 period */
+        for (uint32_t n = irqtest_random() % 64U; n > 0U; n--) {
+            irqtest_load_step((*step)++);
+        }
+
+        irqtest_hit = false;
+        irqtest_t0  = DWT->CYCCNT;
+#if APP_IRQ_SELFTEST_LOOPBACK
+        level = (level == GPIO_PIN_RESET) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+        IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, level);
+#else
+        EXTI->SWIER1 = EXTI_SWIER1_SWI0;
+#endif
+        if (irqtest_wait(step)) {
+            irqtest_add(row, irqtest_cycles);
+        } else {
+            row->missed++;
+        }
+    }
+    IO_PinWrite(HS_SR04_TRIG_PORT, HS_SR04_TRIG_PIN, GPIO_PIN_RESET);
+    (void)level;
+}
+
+/* TIM7 at prio, raised while the main loop load runs */
+static void irqtest_run_probe(irqtest_row_t *row, uint32_t *step)
+{
+    row->via = "tim7";
+    HAL_NVIC_SetPriority(IRQTEST_PROBE_IRQn, row->prio, 0);
+    for (uint32_t i = 0; i < IRQTEST_SAMPLES; i++) {
+        uint32_t period = IRQTEST_PROBE_PERIOD_MIN + irqtest_random() % IRQTEST_PROBE_PERIOD_SPAN;
+
+        irqtest_hit = false;
+        IRQTEST_PROBE_TIM->CNT = 0U;
+        IRQTEST_PROBE_TIM->ARR = period / irqtest_scale - 1U;
+        IRQTEST_PROBE_TIM->CR1 |= TIM_CR1_CEN;
+        if (irqtest_wait(step)) {
+            irqtest_add(row, irqtest_cycles);
+        } else {
+            IRQTEST_PROBE_TIM->CR1 &= ~TIM_CR1_CEN;
+            row->missed++;
+        }
+    }
+}
+
+/* Blocking, about 0.2 s at 80 MHz. Needs the DWT counter and HCSR04_Init
+ * (the echo pin on EXTI0); leaves TIM6 and TIM7 off. */
+void irqtest_run(irqtest_row_t rows[IRQTEST_ROWS])
+{
+    static const struct { const char *name; uint8_t prio; } plan[] = {
+#define IRQTEST_PLAN_ROW(name, prio)  { name, (uint8_t)(prio) },
+        IRQ_PLAN(IRQTEST_PLAN_ROW)
+#undef IRQTEST_PLAN_ROW
+    };
+    uint32_t step = 0;
+
+    memset(rows, 0, IRQTEST_ROWS * sizeof(rows[0]));
+    rows[0].name = "exti0 echo";
+    rows[0].prio = IRQ_PRIO_ECHO;
+    for (uint32_t i = 0; i < IRQTEST_ROWS - 1U; i++) {
+        rows[i + 1U].name = plan[i].name;
+        rows[i + 1U].prio = plan[i].prio;
+    }
+
+    __HAL_RCC_TIM6_CLK_ENABLE();
+    __HAL_RCC_TIM7_CLK_ENABLE();
+    irqtest_scale = irqtest_tim_scale();
+    irqtest_running = true;
+
+    irqtest_tim_init(IRQTEST_LOAD_TIM, IRQTEST_LOAD_IRQn, IRQTEST_LOAD_PRIO);
+    IRQTEST_LOAD_TIM->ARR = IRQTEST_LOAD_PERIOD_CYCLES / irqtest_scale - 1U;
+    IRQTEST_LOAD_TIM->CR1 |= TIM_CR1_CEN;
+    irqtest_tim_init(IRQTEST_PROBE_TIM, IRQTEST_PROBE_IRQn, IRQ_PRIO_SYSTICK);
+
+    irqtest_run_exti(&rows[0], &step);
+    for (uint32_t i = 1; i < IRQTEST_ROWS; i++) {
+        irqtest_run_probe(&rows[i], &step);
+    }
+
+    irqtest_tim_stop(IRQTEST_PROBE_TIM, IRQTEST_PROBE_IRQn);
+    irqtest_tim_stop(IRQTEST_LOAD_TIM, IRQTEST_LOAD_IRQn);
+    __HAL_RCC_TIM6_CLK_DISABLE();
+    __HAL_RCC_TIM7_CLK_DISABLE();
+    irqtest_running = false;
+}
+
+bool irqtest_active(void)
+{
+    return irqtest_running;
+}
+
+/* Upper edge of the bin holding the pct-th percentile [cycles] */
+uint32_t irqtest_percentile(const irqtest_row_t *row, uint32_t pct)
+{
+    uint32_t rank = (row->count * pct + 99U) / 100U;
+    uint32_t seen = 0;
+
+    for (uint32_t bin = 0; bin < IRQTEST_BINS; bin++) {
+        seen += row->hist[bin];
+        if (seen >= rank && seen > 0U) {
+            return (bin < IRQTEST_BINS - 1U) ? (bin + 1U) * IRQTEST_BIN_CYCLES : row->max;
+        }
+    }
+    return row->max;
+}
+
+/* From the EXTI callback while the test runs: entry_cycles is the DWT stamp
+ * taken first in EXTI0_IRQHandler */
+void irqtest_echo_edge(uint32_t entry_cycles)
+{
+    irqtest_cycles = entry_cycles - irqtest_t0;
+    irqtest_hit = true;
+}
+
+/* TIM7: the counter restarted from 0 when the interrupt was raised */
+void irqtest_probe_irq_handler(void)
+{
+    uint32_t ticks = IRQTEST_PROBE_TIM->CNT;
+
+    IRQTEST_PROBE_TIM->CR1 &= ~TIM_CR1_CEN;
+    IRQTEST_PROBE_TIM->SR = 0U;
+    irqtest_cycles = ticks * irqtest_scale;
+    irqtest_hit = true;
+}
+
+/* TIM6: the synthetic handler */
+void irqtest_load_irq_handler(void)
+{
+    uint32_t t0 = DWT->CYCCNT;
+
+    IRQTEST_LOAD_TIM->SR = 0U;
+    while ((DWT->CYCCNT - t0) < IRQTEST_LOAD_BUSY_CYCLES) {
+    }
+}
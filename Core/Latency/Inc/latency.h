@@ -0,0 +1,58 @@
+#ifndef _LATENCY_H
+#define _LATENCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include "policy.h"
+#include "stats.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define LATENCY_NONE         0U            /**< Tag: no change waiting for its output */
+#define LATENCY_KEY_NONE     0xFFFFFFFFU   /**< Key before the first decision */
+#define LATENCY_KEY_INVALID  0xFFFFFFFEU   /**< Readout key of "no distance" */
+
+/* What the buzzer plays: a change of it is audible */
+#define LATENCY_KEY_BUZZER(policy) \
+    (((uint32_t)(policy)->tone_hz << 16) | (uint32_t)(policy)->cadence_ms)
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef enum {
+    LATENCY_OUT_BUZZER = 0,              /**< TIM1 reprogrammed */
+    LATENCY_OUT_DASH,                    /**< Dashboard frame on the panel */
+    LATENCY_OUT_REAR,                    /**< Rear panel frame */
+    LATENCY_OUT_COUNT
+} latency_out_t;
+
+/* One output: the state it was last told to show, the capture time of the
+ * measurement that changed it until the output shows it, and the echo to
+ * output times */
+typedef struct {
+    uint32_t       key;                  /**< Output state last decided */
+    uint32_t       tag_us;               /**< Capture of the oldest change not yet out, or LATENCY_NONE */
+    uint32_t       worst_us;             /**< Longest since boot */
+    stats_stream_t hist;                 /**< [us] */
+} latency_channel_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void latency_init(latency_channel_t *channel, float32_t range_us);
+void latency_decide(latency_channel_t *channel, uint32_t key, uint32_t capture_us);
+uint32_t latency_take(latency_channel_t *channel);
+void latency_add(latency_channel_t *channel, uint32_t latency_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LATENCY_H */
@@ -0,0 +1,62 @@
+/**
+ * @file    latency.c
+ * @brief   Parking-Sensor project.
+ * @details End-to-end latency per output, from the echo edge that changed
+ *          what an output should show to the moment it shows it. The
+ *          decision tags the change with the measurement's capture time;
+ *          the output takes the tag when it goes out and the difference is
+ *          one sample of the channel's histogram (stats.c). A change that
+ *          is overtaken by another before it goes out keeps the older
+ *          tag: the driver waited for both. No HAL and no time source, so
+ *          the host replay simulates the same channels.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "latency.h"
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void latency_init(latency_channel_t *channel, float32_t range_us)
+{
+    channel->key      = LATENCY_KEY_NONE;
+    channel->tag_us   = LATENCY_NONE;
+    channel->worst_us = 0;
+    stats_init(&channel->hist, 0.0f, range_us);
+}
+
+/* The output should now show key, decided from the echo captured at
+ * capture_us */
+void latency_decide(latency_channel_t *channel, uint32_t key, uint32_t capture_us)
+{
+    if (key == channel->key) {
+        return;
+    }
+    channel->key = key;
+    if (channel->tag_us == LATENCY_NONE) {
+        channel->tag_us = (capture_us != LATENCY_NONE) ? capture_us : 1U;
+    }
+}
+
+/* The output goes out now: the tag of the change it carries, LATENCY_NONE
+ * if nothing changed */
+uint32_t latency_take(latency_channel_t *channel)
+{
+    uint32_t tag = channel->tag_us;
+
+    channel->tag_us = LATENCY_NONE;
+    return tag;
+}
+
+void latency_add(latency_channel_t *channel, uint32_t latency_us)
+{
+    if (latency_us > channel->worst_us) {
+        channel->worst_us = latency_us;
+    }
+    stats_add(&channel->hist, (float32_t)latency_us);
+}
@@ -0,0 +1,79 @@
+#ifndef _OCCUPANCY_H
+#define _OCCUPANCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define OCCUPANCY_NO_TARGET    0xFFFFFFFFU   /**< Sample: pinged, nothing in range */
+#define OCCUPANCY_NO_SAMPLE    0xFFFFFFFEU   /**< Sample: no usable reading this pass */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef enum {
+    OCCUPANCY_UNKNOWN = 0,               /**< Since boot, until the first decision */
+    OCCUPANCY_FREE,
+    OCCUPANCY_OCCUPIED,
+} occupancy_state_t;
+
+typedef enum {
+    OCCUPANCY_EVENT_FREE = 0,            /**< Bay left; closest and duration of the stay */
+    OCCUPANCY_EVENT_OCCUPIED,            /**< Vehicle parked; settled distance */
+    OCCUPANCY_EVENT_HEARTBEAT,           /**< No change for heartbeat_ms */
+} occupancy_event_type_t;
+
+/* Distances in 0.01 cm. Entry below enter_cm100, exit above exit_cm100
+ * or nothing in range; in between the state holds. */
+typedef struct {
+    uint32_t enter_cm100;
+    uint32_t exit_cm100;
+    uint32_t enter_dwell_ms;             /**< Candidate state must hold this long... */
+    uint32_t exit_dwell_ms;
+    uint32_t debounce;                   /**< ...for at least this many samples in a row */
+    uint32_t heartbeat_ms;               /**< Longest silence between events */
+} occupancy_conf_t;
+
+typedef struct {
+    uint8_t  type;                       /**< occupancy_event_type_t */
+    uint8_t  state;                      /**< occupancy_state_t after the event */
+    uint16_t seq;                        /**< Per event, lets a receiver count losses */
+    uint16_t distance_cm;                /**< Parked distance while occupied, else 0 */
+    uint16_t closest_cm;                 /**< Closest distance of the stay, else 0 */
+    uint32_t duration_s;                 /**< Time in the state that ended, or in the current one */
+} occupancy_event_t;
+
+typedef struct {
+    occupancy_conf_t conf;
+    uint8_t  state;                      /**< occupancy_state_t */
+    uint8_t  candidate;                  /**< State the samples point to, == state if none */
+    uint16_t seq;
+    uint32_t agree;                      /**< Samples in a row for the candidate */
+    uint32_t candidate_ms;               /**< First of them */
+    uint32_t filtered_cm100;             /**< Recent distance (EMA), 0 = none yet */
+    uint32_t closest_cm100;              /**< Since the vehicle came in */
+    uint32_t last_ms;                    /**< Previous update */
+    uint32_t event_ms;                   /**< Previous event */
+    uint64_t state_age_ms;               /**< Time in the current state, no 49-day wrap */
+} occupancy_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void occupancy_init(occupancy_t *occ, const occupancy_conf_t *conf, uint32_t now_ms);
+bool occupancy_update(occupancy_t *occ, uint32_t cm100, uint32_t now_ms, occupancy_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OCCUPANCY_H */
@@ -0,0 +1,153 @@
+/**
+ * @file    occupancy.c
+ * @brief   Parking-Sensor project.
+ * @details Bay occupancy from the distance stream. A state change needs
+ *          the samples to agree for the debounce count and the dwell time,
+ *          and the entry and exit thresholds leave a band in which the
+ *          state holds, so a vehicle moving about in the bay or a missed
+ *          echo does not toggle it. Events come out only on a change and
+ *          as a heartbeat. No HAL here; the caller passes the time.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "occupancy.h"
+#include <string.h>
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define OCCUPANCY_EMA_SHIFT    3U       /**< Distance filter weight 1/8 */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void occupancy_init(occupancy_t *occ, const occupancy_conf_t *conf, uint32_t now_ms)
+{
+    memset(occ, 0, sizeof(*occ));
+    occ->conf      = *conf;
+    occ->state     = OCCUPANCY_UNKNOWN;
+    occ->candidate = OCCUPANCY_UNKNOWN;
+    occ->last_ms   = now_ms;
+    occ->event_ms  = now_ms;
+}
+
+/* State one sample points to. Until the first decision there is no state
+ * to hold, so the band is split in the middle. */
+static uint8_t occupancy_classify(const occupancy_t *occ, uint32_t cm100)
+{
+    if (cm100 == OCCUPANCY_NO_TARGET) {
+        return OCCUPANCY_FREE;
+    }
+    if (occ->state == OCCUPANCY_UNKNOWN) {
+        return (cm100 < (occ->conf.enter_cm100 + occ->conf.exit_cm100) / 2U) ? OCCUPANCY_OCCUPIED
+                                                                              : OCCUPANCY_FREE;
+    }
+    if (cm100 < occ->conf.enter_cm100) {
+        return OCCUPANCY_OCCUPIED;
+    }
+    if (cm100 > occ->conf.exit_cm100) {
+        return OCCUPANCY_FREE;
+    }
+    return occ->state;
+}
+
+static uint16_t occupancy_cm(uint32_t cm100)
+{
+    uint32_t cm = (cm100 + 50U) / 100U;
+
+    return (cm > UINT16_MAX) ? UINT16_MAX : (uint16_t)cm;
+}
+
+/* Distances of the stay go with the event while it lasts and when it ends */
+static void occupancy_event(occupancy_t *occ, uint8_t type, bool stay, uint64_t duration_ms,
+                            uint32_t now_ms, occupancy_event_t *event)
+{
+    bool occupied = (occ->state == OCCUPANCY_OCCUPIED);
+
+    event->type        = type;
+    event->state       = occ->state;
+    event->seq         = occ->seq++;
+    event->distance_cm = occupied ? occupancy_cm(occ->filtered_cm100) : 0U;
+    event->closest_cm  = stay ? occupancy_cm(occ->closest_cm100) : 0U;
+    event->duration_s  = (uint32_t)(duration_ms / 1000U);
+    occ->event_ms      = now_ms;
+}
+
+/* The new state started with the first sample of the candidate: that time
+ * goes to it, not to the state that ends */
+static void occupancy_change(occupancy_t *occ, uint32_t now_ms, occupancy_event_t *event)
+{
+    uint32_t pending_ms = now_ms - occ->candidate_ms;
+    uint64_t ended_ms   = (occ->state_age_ms > pending_ms) ? occ->state_age_ms - pending_ms : 0U;
+    bool     left       = (occ->state == OCCUPANCY_OCCUPIED);
+
+    occ->state        = occ->candidate;
+    occ->state_age_ms = pending_ms;
+    if (occ->state == OCCUPANCY_OCCUPIED) {
+        occupancy_event(occ, OCCUPANCY_EVENT_OCCUPIED, true, ended_ms, now_ms, event);
+    } else {
+        occupancy_event(occ, OCCUPANCY_EVENT_FREE, left, ended_ms, now_ms, event);
+    }
+}
+
+/**
+ * @brief  Feed one sample (or none) and check for a due event.
+ * @param  cm100  Distance [0.01 cm], OCCUPANCY_NO_TARGET or OCCUPANCY_NO_SAMPLE.
+ * @return true when *event was filled and should be sent.
+ */
+bool occupancy_update(occupancy_t *occ, uint32_t cm100, uint32_t now_ms, occupancy_event_t *event)
+{
+    occ->state_age_ms += now_ms - occ->last_ms;
+    occ->last_ms = now_ms;
+
+    if (cm100 != OCCUPANCY_NO_SAMPLE) {
+        uint8_t target = occupancy_classify(occ, cm100);
+
+        if (target == occ->state) {
+            occ->candidate = occ->state;            /* A pending change starts over */
+        } else {
+            if (target != occ->candidate) {
+                occ->candidate    = target;
+                occ->agree        = 0;
+                occ->candidate_ms = now_ms;
+                if (target == OCCUPANCY_OCCUPIED) {
+                    occ->closest_cm100  = UINT32_MAX;
+                    occ->filtered_cm100 = 0U;
+                }
+            }
+            occ->agree++;
+        }
+
+        /* Parked distance: only samples that see the vehicle, so a missed
+         * or stray echo does not pull it away */
+        if (target == OCCUPANCY_OCCUPIED) {
+            occ->filtered_cm100 = (occ->filtered_cm100 == 0U) ? cm100 :
+                occ->filtered_cm100 - (occ->filtered_cm100 >> OCCUPANCY_EMA_SHIFT) + (cm100 >> OCCUPANCY_EMA_SHIFT);
+        }
+
+        /* NO_TARGET is never the closest */
+        if (((occ->state == OCCUPANCY_OCCUPIED) || (occ->candidate == OCCUPANCY_OCCUPIED)) &&
+            (cm100 < occ->closest_cm100)) {
+            occ->closest_cm100 = cm100;
+        }
+
+        uint32_t dwell_ms = (target == OCCUPANCY_OCCUPIED) ? occ->conf.enter_dwell_ms : occ->conf.exit_dwell_ms;
+        if ((occ->candidate != occ->state) && (occ->agree >= occ->conf.debounce) &&
+            (now_ms - occ->candidate_ms >= dwell_ms)) {
+            occupancy_change(occ, now_ms, event);
+            return true;
+        }
+    }
+
+    if (now_ms - occ->event_ms >= occ->conf.heartbeat_ms) {
+        occupancy_event(occ, OCCUPANCY_EVENT_HEARTBEAT, occ->state == OCCUPANCY_OCCUPIED,
+                        occ->state_age_ms, now_ms, event);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,35 @@
+#ifndef _DMA_H
+#define _DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include "main.h"
+#include "stm32l4xx_hal.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+/* DMA1 request mapping (RM0351, table "DMA1 requests for each channel") */
+#define DMA_TIM1_UP_CHANNEL     DMA1_Channel6
+#define DMA_TIM1_UP_REQUEST     DMA_REQUEST_7
+#define DMA_I2C2_TX_CHANNEL     DMA1_Channel4
+#define DMA_I2C2_TX_REQUEST     DMA_REQUEST_3
+#define DMA_TIM4_CH1_CHANNEL    DMA1_Channel1
+#define DMA_TIM4_CH1_REQUEST    DMA_REQUEST_6
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void MX_DMA_Init(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DMA_H */
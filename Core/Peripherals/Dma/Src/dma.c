@@ -0,0 +1,39 @@
+/**
+ * @file    dma.c
+ * @brief   Parking-Sensor project.
+ * @details Implemented parking sensor with HC-SR04 sensor
+ *          value is displayed on OLED and also we use buzzer
+ *          to realize the distance.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "main.h"
+#include "stm32l4xx_hal.h"
+#include "dma.h"
+#include "irq_conf.h"
+
+/*******************************************************************************
+ * DMA Initialization
+ ******************************************************************************/
+/**
+ * @brief Enable the DMA controller clock. Must run before the peripheral
+ *        init functions, whose MspInit callbacks configure the channels.
+ * @note  TIM1_UP (DMA1 channel 6) streams buzzer patterns and needs no
+ *        interrupt: the player polls the channel counter instead.
+ *        TIM4_CH1 (DMA1 channel 1) resets TIM1 at the end of every beep,
+ *        also without an interrupt.
+ */
+void MX_DMA_Init(void)
+{
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Channel4_IRQn interrupt configuration (I2C2_TX) */
+  HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, IRQ_PRIO_I2C_DMA, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+}
@@ -14,6 +14,31 @@ extern "C" {
 /****************************************************************
  * Defines
 ****************************************************************/
+#define I2C2_SPEED_DEFAULT    I2C_SPEED_FAST   /**< I2C2 profile used by MX_I2C2_Init */
+#define I2C2_KERNEL_CLOCK_HZ  HSI_VALUE        /**< I2C2 kernel clock (HSI16) [Hz] */
+
+/* Errors after which the bus may be stuck and needs a recovery */
+#define I2C2_BUS_ERRORS       (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO | \
+                               HAL_I2C_ERROR_TIMEOUT | HAL_I2C_ERROR_DMA)
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+/** I2C speed profiles (UM10204 bus modes) */
+typedef enum {
+    I2C_SPEED_STANDARD  = 0,   /**< 100 kHz */
+    I2C_SPEED_FAST      = 1,   /**< 400 kHz */
+    I2C_SPEED_FAST_PLUS = 2,   /**< 1 MHz, 20 mA Fm+ drive on the I2C2 pins */
+    I2C_SPEED_COUNT
+} i2c_speed_t;
+
+/** I2C2 transfer errors and recoveries */
+typedef struct {
+    uint32_t errors;       /**< Failed transfers, blocking and DMA */
+    uint32_t timeouts;     /**< Transfers that missed their deadline */
+    uint32_t recoveries;   /**< Bus recoveries performed */
+    uint32_t stuck;        /**< Recoveries that found SDA held low */
+} i2c_bus_stats_t;
 
 /*******************************************************************************
  * Function Prototypes
@@ -21,6 +46,16 @@ extern "C" {
 void HAL_I2C_MspDeInit(I2C_HandleTypeDef* i2cHandle);
 void HAL_I2C_MspInit(I2C_HandleTypeDef* i2cHandle);
 void MX_I2C2_Init(void);
+void MX_I2C2_UpdateClock(void);
+uint32_t I2C_ComputeTiming(uint32_t i2c_clk_hz, uint32_t bus_hz);
+uint32_t I2C_SpeedHz(i2c_speed_t speed);
+HAL_StatusTypeDef MX_I2C2_SetSpeed(i2c_speed_t speed);
+i2c_speed_t MX_I2C2_GetSpeed(void);
+void MX_I2C2_ReportError(uint32_t error_code);
+uint8_t MX_I2C2_RecoveryPending(void);
+HAL_StatusTypeDef MX_I2C2_Recover(void);
+void MX_I2C2_InjectFault(void);
+void MX_I2C2_GetStats(i2c_bus_stats_t *stats);
 
 
 #ifdef __cplusplus
@@ -16,7 +16,147 @@
 #include "stm32l4xx_hal.h"
 #include "stm32l4xx_hal_i2c.h"
 
+#include "i2c.h"
+#include "dma.h"
+#include "irq_conf.h"
+
 extern I2C_HandleTypeDef hi2c2;
+extern DMA_HandleTypeDef hdma_i2c2_tx;
+
+/*******************************************************************************
+ * Typedefs
+ ******************************************************************************/
+/** I2C bus characteristics (UM10204, minimum values unless noted) [ns] */
+typedef struct {
+  uint32_t bus_hz;      /**< Maximum SCL frequency of the mode */
+  uint16_t low_ns;      /**< tLOW */
+  uint16_t high_ns;     /**< tHIGH */
+  uint16_t su_dat_ns;   /**< tSU;DAT */
+  uint16_t hd_dat_ns;   /**< tHD;DAT */
+  uint16_t rise_ns;     /**< tr (maximum) */
+  uint16_t fall_ns;     /**< tf (maximum) */
+} i2c_mode_spec_t;
+
+/*******************************************************************************
+ * Constants
+ ******************************************************************************/
+/* Indexed by i2c_speed_t */
+static const i2c_mode_spec_t i2c_mode_specs[I2C_SPEED_COUNT] = {
+  {  100000U, 4700U, 4000U, 250U, 0U, 1000U, 300U },  /* Standard-mode  */
+  {  400000U, 1300U,  600U, 100U, 0U,  300U, 300U },  /* Fast-mode      */
+  { 1000000U,  500U,  260U,  50U, 0U,  120U, 120U },  /* Fast-mode Plus */
+};
+
+#define I2C_ANALOG_FILTER_MIN_NS   50U          /**< tAF(min) of the analog filter */
+#define I2C_TIMINGR_MASK           0xF0FFFFFFU  /**< Valid TIMINGR bits */
+
+#define I2C2_SCL_PIN               GPIO_PIN_13  /**< PB13 */
+#define I2C2_SDA_PIN               GPIO_PIN_14  /**< PB14 */
+#define I2C2_RECOVERY_CLOCKS       9U           /**< SCL pulses that free a slave stuck mid-byte */
+#define I2C2_RECOVERY_HALF_US      5U           /**< Half SCL period while bit-banging (100 kHz) */
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static i2c_speed_t i2c2_speed = I2C2_SPEED_DEFAULT;  /**< Active I2C2 profile */
+static i2c_bus_stats_t i2c2_stats;                  /**< Errors and recoveries */
+static volatile uint8_t i2c2_recover_pending;       /**< Set on a bus error, cleared by MX_I2C2_Recover */
+
+/*******************************************************************************
+ * I2C timing computation
+ ******************************************************************************/
+/**
+ * @brief  Compute the TIMINGR value for a given I2C kernel clock and SCL rate.
+ * @note   Picks the smallest prescaler for which SCLL/SCLH/SCLDEL/SDADEL all
+ *         fit their fields. SCL low/high never go below the mode minimums, so
+ *         on slow kernel clocks the bus runs somewhat below bus_hz.
+ * @param  i2c_clk_hz I2C kernel clock [Hz]
+ * @param  bus_hz     Requested SCL frequency [Hz]
+ * @retval TIMINGR register value, 0 if no valid setting exists.
+ */
+uint32_t I2C_ComputeTiming(uint32_t i2c_clk_hz, uint32_t bus_hz)
+{
+  const i2c_mode_spec_t *spec = &i2c_mode_specs[0];
+
+  for (uint32_t i = 0; i < sizeof(i2c_mode_specs) / sizeof(i2c_mode_specs[0]); i++)
+  {
+    spec = &i2c_mode_specs[i];
+    if (bus_hz <= spec->bus_hz)
+    {
+      break;
+    }
+  }
+
+  uint64_t clk_ps    = 1000000000000ULL / i2c_clk_hz;
+  uint64_t period_ps = 1000000000000ULL / bus_hz;
+  /* Rise/fall plus two SCL synchronisation stages of ~3 kernel clocks */
+  uint64_t sync_ps   = (uint64_t)(spec->rise_ns + spec->fall_ns) * 1000U + 6U * clk_ps;
+
+  for (uint32_t presc = 0; presc < 16U; presc++)
+  {
+    uint64_t tick_ps = clk_ps * (presc + 1U);
+
+    uint32_t scldel = (uint32_t)(((spec->rise_ns + spec->su_dat_ns) * 1000ULL + tick_ps - 1U) / tick_ps);
+    if (scldel == 0U)
+    {
+      scldel = 1U;
+    }
+
+    int64_t sdadel_ps = (int64_t)(spec->fall_ns + spec->hd_dat_ns - I2C_ANALOG_FILTER_MIN_NS) * 1000
+                      - 3 * (int64_t)clk_ps;
+    uint32_t sdadel = (sdadel_ps > 0) ? (uint32_t)(((uint64_t)sdadel_ps + tick_ps - 1U) / tick_ps) : 0U;
+
+    uint32_t scll = (uint32_t)((spec->low_ns * 1000ULL + tick_ps - 1U) / tick_ps);
+    uint32_t sclh = (uint32_t)((spec->high_ns * 1000ULL + tick_ps - 1U) / tick_ps);
+
+    /* Spread any remaining period evenly over low and high phase */
+    if (period_ps > sync_ps)
+    {
+      uint32_t total = (uint32_t)((period_ps - sync_ps) / tick_ps);
+      if (total > scll + sclh)
+      {
+        uint32_t extra = total - scll - sclh;
+        scll += extra - extra / 2U;
+        sclh += extra / 2U;
+      }
+    }
+
+    if (scldel > 16U || sdadel > 15U || scll > 256U || sclh > 256U)
+    {
+      continue;
+    }
+
+    return (presc << I2C_TIMINGR_PRESC_Pos)
+         | ((scldel - 1U) << I2C_TIMINGR_SCLDEL_Pos)
+         | (sdadel << I2C_TIMINGR_SDADEL_Pos)
+         | ((sclh - 1U) << I2C_TIMINGR_SCLH_Pos)
+         | ((scll - 1U) << I2C_TIMINGR_SCLL_Pos);
+  }
+
+  return 0U;
+}
+
+uint32_t I2C_SpeedHz(i2c_speed_t speed)
+{
+  if (speed >= I2C_SPEED_COUNT)
+  {
+    return 0U;
+  }
+  return i2c_mode_specs[speed].bus_hz;
+}
+
+/* Fm+ needs the SYSCFG high-drive setting on the I2C2 pins */
+static void I2C2_ConfigFastModePlus(i2c_speed_t speed)
+{
+  if (speed == I2C_SPEED_FAST_PLUS)
+  {
+    HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_I2C2);
+  }
+  else
+  {
+    HAL_I2CEx_DisableFastModePlus(I2C_FASTMODEPLUS_I2C2);
+  }
+}
 
 /*******************************************************************************
  * I2C Initialization
@@ -33,7 +173,8 @@ void MX_I2C2_Init(void)
 
   /* USER CODE END I2C2_Init 1 */
   hi2c2.Instance = I2C2;
-  hi2c2.Init.Timing = 0x00F12981;
+  /* Kernel clock source is selected in HAL_I2C_MspInit, called below */
+  hi2c2.Init.Timing = I2C_ComputeTiming(I2C2_KERNEL_CLOCK_HZ, I2C_SpeedHz(i2c2_speed));
   hi2c2.Init.OwnAddress1 = 0;
   hi2c2.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
   hi2c2.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
@@ -60,7 +201,7 @@ void MX_I2C2_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN I2C2_Init 2 */
-
+  I2C2_ConfigFastModePlus(i2c2_speed);
   /* USER CODE END I2C2_Init 2 */
 
 }
@@ -79,7 +220,7 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* i2cHandle)
   /** Initializes the peripherals clock
   */
     PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_I2C2;
-    PeriphClkInit.I2c2ClockSelection = RCC_I2C2CLKSOURCE_PCLK1;
+    PeriphClkInit.I2c2ClockSelection = RCC_I2C2CLKSOURCE_HSI;    // Nezavisno od SYSCLK profila
     if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
     {
       Error_Handler();
@@ -99,6 +240,30 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* i2cHandle)
 
     /* I2C2 clock enable */
     __HAL_RCC_I2C2_CLK_ENABLE();
+
+    /* I2C2 DMA Init */
+    /* I2C2_TX Init */
+    hdma_i2c2_tx.Instance = DMA_I2C2_TX_CHANNEL;
+    hdma_i2c2_tx.Init.Request = DMA_I2C2_TX_REQUEST;
+    hdma_i2c2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_i2c2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_i2c2_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_i2c2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_i2c2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_i2c2_tx.Init.Mode = DMA_NORMAL;
+    hdma_i2c2_tx.Init.Priority = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_i2c2_tx) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(i2cHandle,hdmatx,hdma_i2c2_tx);
+
+    /* I2C2 interrupt Init */
+    HAL_NVIC_SetPriority(I2C2_EV_IRQn, IRQ_PRIO_I2C, 0);
+    HAL_NVIC_EnableIRQ(I2C2_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C2_ER_IRQn, IRQ_PRIO_I2C, 0);
+    HAL_NVIC_EnableIRQ(I2C2_ER_IRQn);
   /* USER CODE BEGIN I2C2_MspInit 1 */
 
   /* USER CODE END I2C2_MspInit 1 */
@@ -124,8 +289,203 @@ void HAL_I2C_MspDeInit(I2C_HandleTypeDef* i2cHandle)
 
     HAL_GPIO_DeInit(GPIOB, GPIO_PIN_14);
 
+    /* I2C2 DMA DeInit */
+    HAL_DMA_DeInit(i2cHandle->hdmatx);
+
+    /* I2C2 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(I2C2_EV_IRQn);
+    HAL_NVIC_DisableIRQ(I2C2_ER_IRQn);
+
   /* USER CODE BEGIN I2C2_MspDeInit 1 */
 
   /* USER CODE END I2C2_MspDeInit 1 */
   }
 }
+
+/*******************************************************************************
+ * Clock change handling
+ ******************************************************************************/
+/**
+ * @brief Recompute I2C2 TIMINGR from the current kernel clock.
+ *        Called after every system clock profile switch. I2C2 runs from
+ *        HSI16, so the timing normally stays the same and the peripheral
+ *        (and any transfer in flight) is left alone.
+ */
+void MX_I2C2_UpdateClock(void)
+{
+  if (hi2c2.Instance == NULL)
+  {
+    return;
+  }
+
+  uint32_t timing = I2C_ComputeTiming(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C2), I2C_SpeedHz(i2c2_speed));
+  if (timing == hi2c2.Init.Timing)
+  {
+    return;
+  }
+  hi2c2.Init.Timing = timing;
+
+  __HAL_I2C_DISABLE(&hi2c2);
+  hi2c2.Instance->TIMINGR = hi2c2.Init.Timing & I2C_TIMINGR_MASK;
+  __HAL_I2C_ENABLE(&hi2c2);
+}
+
+/*******************************************************************************
+ * Speed profiles
+ ******************************************************************************/
+/**
+ * @brief  Switch I2C2 to another speed profile at run time.
+ * @note   The bus must be idle. TIMINGR is derived from the I2C2 kernel
+ *         clock, so the profile is kept across clock profile switches.
+ */
+HAL_StatusTypeDef MX_I2C2_SetSpeed(i2c_speed_t speed)
+{
+  if (speed >= I2C_SPEED_COUNT)
+  {
+    return HAL_ERROR;
+  }
+
+  uint32_t timing = I2C_ComputeTiming(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C2), I2C_SpeedHz(speed));
+  if (timing == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  i2c2_speed = speed;
+
+  if (hi2c2.Instance == NULL)
+  {
+    return HAL_OK;    // Primenice se u MX_I2C2_Init
+  }
+
+  hi2c2.Init.Timing = timing;
+
+  __HAL_I2C_DISABLE(&hi2c2);
+  I2C2_ConfigFastModePlus(speed);
+  hi2c2.Instance->TIMINGR = timing & I2C_TIMINGR_MASK;
+  __HAL_I2C_ENABLE(&hi2c2);
+
+  return HAL_OK;
+}
+
+i2c_speed_t MX_I2C2_GetSpeed(void)
+{
+  return i2c2_speed;
+}
+
+/*******************************************************************************
+ * Error accounting and bus recovery
+ ******************************************************************************/
+/**
+ * @brief Count a failed transfer and request a recovery if the bus may be
+ *        stuck. A plain NACK only counts. Safe to call from the I2C ISR.
+ */
+void MX_I2C2_ReportError(uint32_t error_code)
+{
+  i2c2_stats.errors++;
+  if (error_code & HAL_I2C_ERROR_TIMEOUT)
+  {
+    i2c2_stats.timeouts++;
+  }
+  if (error_code & I2C2_BUS_ERRORS)
+  {
+    i2c2_recover_pending = 1;
+  }
+}
+
+uint8_t MX_I2C2_RecoveryPending(void)
+{
+  return i2c2_recover_pending;
+}
+
+/* Debug aid: behave as if the last transfer had timed out */
+void MX_I2C2_InjectFault(void)
+{
+  MX_I2C2_ReportError(HAL_I2C_ERROR_TIMEOUT);
+}
+
+static void I2C2_HalfBitDelay(void)
+{
+  uint32_t cycles = (SystemCoreClock / 1000000U) * I2C2_RECOVERY_HALF_US;
+  uint32_t start = DWT->CYCCNT;
+
+  while ((DWT->CYCCNT - start) < cycles)
+  {
+  }
+}
+
+/**
+ * @brief  Bring a stuck bus back (UM10204 3.1.16): abort the DMA channel,
+ *         reset the peripheral, clock SCL by hand until a slave caught in
+ *         the middle of a byte releases SDA, send a STOP and initialize
+ *         I2C2 again with the active speed profile.
+ * @note   Call from the main loop with no transfer of interest in flight;
+ *         takes about 0.2 ms.
+ * @retval HAL_OK if both lines are high afterwards.
+ */
+HAL_StatusTypeDef MX_I2C2_Recover(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  i2c2_stats.recoveries++;
+
+  /* Stop the peripheral and its DMA channel, pins go back to analog */
+  if (hi2c2.hdmatx != NULL)
+  {
+    HAL_DMA_Abort(hi2c2.hdmatx);
+  }
+  HAL_I2C_DeInit(&hi2c2);
+  __HAL_RCC_I2C2_FORCE_RESET();
+  __HAL_RCC_I2C2_RELEASE_RESET();
+
+  /* SCL and SDA as released open-drain outputs */
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  HAL_GPIO_WritePin(GPIOB, I2C2_SCL_PIN | I2C2_SDA_PIN, GPIO_PIN_SET);
+  GPIO_InitStruct.Pin = I2C2_SCL_PIN | I2C2_SDA_PIN;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+  I2C2_HalfBitDelay();
+
+  if (HAL_GPIO_ReadPin(GPIOB, I2C2_SDA_PIN) == GPIO_PIN_RESET)
+  {
+    i2c2_stats.stuck++;
+  }
+
+  for (uint32_t i = 0; i < I2C2_RECOVERY_CLOCKS; i++)
+  {
+    if (HAL_GPIO_ReadPin(GPIOB, I2C2_SDA_PIN) == GPIO_PIN_SET)
+    {
+      break;
+    }
+    HAL_GPIO_WritePin(GPIOB, I2C2_SCL_PIN, GPIO_PIN_RESET);
+    I2C2_HalfBitDelay();
+    HAL_GPIO_WritePin(GPIOB, I2C2_SCL_PIN, GPIO_PIN_SET);
+    I2C2_HalfBitDelay();
+  }
+
+  /* STOP: SDA rises while SCL is high */
+  HAL_GPIO_WritePin(GPIOB, I2C2_SCL_PIN, GPIO_PIN_RESET);
+  I2C2_HalfBitDelay();
+  HAL_GPIO_WritePin(GPIOB, I2C2_SDA_PIN, GPIO_PIN_RESET);
+  I2C2_HalfBitDelay();
+  HAL_GPIO_WritePin(GPIOB, I2C2_SCL_PIN, GPIO_PIN_SET);
+  I2C2_HalfBitDelay();
+  HAL_GPIO_WritePin(GPIOB, I2C2_SDA_PIN, GPIO_PIN_SET);
+  I2C2_HalfBitDelay();
+
+  HAL_StatusTypeDef status = (HAL_GPIO_ReadPin(GPIOB, I2C2_SCL_PIN) == GPIO_PIN_SET &&
+                              HAL_GPIO_ReadPin(GPIOB, I2C2_SDA_PIN) == GPIO_PIN_SET) ? HAL_OK : HAL_ERROR;
+
+  /* Pins, DMA and interrupts are set up again by HAL_I2C_MspInit */
+  MX_I2C2_Init();
+  i2c2_recover_pending = 0;
+
+  return status;
+}
+
+void MX_I2C2_GetStats(i2c_bus_stats_t *stats)
+{
+  *stats = i2c2_stats;
+}
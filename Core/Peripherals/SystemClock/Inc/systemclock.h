@@ -14,15 +14,46 @@ extern "C" {
 /****************************************************************
  * Defines
 ****************************************************************/
+#define SYSCLK_FULL_HZ              80000000U        /**< HSI -> PLL system clock [Hz] */
+#define SYSCLK_LOW_HZ               16000000U        /**< MSI system clock [Hz] */
+#define SYSCLK_LOW_MSI_RANGE        RCC_MSIRANGE_8   /**< MSI range matching SYSCLK_LOW_HZ */
+
+/* Typical run currents from the STM32L476 datasheet (code in flash,
+ * peripherals in use), used only for the energy estimate. */
+#define SYSCLK_FULL_RUN_CURRENT_UA  10200U           /**< 80 MHz, range 1 [uA] */
+#define SYSCLK_LOW_RUN_CURRENT_UA   1750U            /**< 16 MHz, range 2 [uA] */
+#define SYSCLK_HSI16_CURRENT_UA     155U             /**< HSI16 kept on for I2C2/USART2 in LOW [uA] */
+#define SYSCLK_SUPPLY_MV            3300U            /**< VDD [mV] */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef enum {
+    SYSCLK_PROFILE_FULL = 0,   /**< 80 MHz PLL, voltage range 1 */
+    SYSCLK_PROFILE_LOW  = 1,   /**< 16 MHz MSI, voltage range 2, PLL off */
+    SYSCLK_PROFILE_COUNT
+} systemclock_profile_t;
+
+typedef struct {
+    uint32_t switches;                              /**< Number of profile switches */
+    uint32_t last_latency_us[SYSCLK_PROFILE_COUNT]; /**< Last switch latency into profile [us] */
+    uint32_t max_latency_us[SYSCLK_PROFILE_COUNT];  /**< Worst switch latency into profile [us] */
+    uint64_t residency_us[SYSCLK_PROFILE_COUNT];    /**< Time spent in each profile [us] */
+} systemclock_stats_t;
 
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
 void SystemClock_Config(void);
+void SystemClock_CycleCounterInit(void);
+HAL_StatusTypeDef SystemClock_SetProfile(systemclock_profile_t profile);
+systemclock_profile_t SystemClock_GetProfile(void);
+void SystemClock_GetStats(systemclock_stats_t *stats);
+uint32_t SystemClock_EnergyPerMeasurement_nJ(uint32_t measurements);
 
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* _SYSTEM_CLOCK_H */
\ No newline at end of file
+#endif /* _SYSTEM_CLOCK_H */
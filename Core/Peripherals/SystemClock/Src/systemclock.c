@@ -14,20 +14,33 @@
  ******************************************************************************/
 #include "main.h"
 #include "stm32l4xx_hal.h"
+#include "systemclock.h"
+#include "timer.h"
+#include "uart.h"
+#include "i2c.h"
+#include "timebase.h"
 
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static systemclock_profile_t current_profile = SYSCLK_PROFILE_FULL; /**< Active clock profile */
+static systemclock_stats_t   clock_stats;                           /**< Switch statistics */
+static uint32_t              profile_entry_cycles;                  /**< DWT stamp of last switch */
+static uint32_t              switch_source;                         /**< SYSCLK source for SystemClock_Mux */
 
 /*******************************************************************************
- * System clock Initialization
+ * Helpers
  ******************************************************************************/
-void SystemClock_Config(void)
+static uint32_t profile_hz(systemclock_profile_t profile)
 {
-  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+  return (profile == SYSCLK_PROFILE_LOW) ? SYSCLK_LOW_HZ : SYSCLK_FULL_HZ;
+}
 
-  // Podesi interni regulator napona
-  HAL_PWREx_ControlVoltageScaling(PWR_REGULATOR_VOLTAGE_SCALE1);
+/* HSI 16 MHz -> PLL (M=1, N=10, R=2) -> 80 MHz */
+static HAL_StatusTypeDef SystemClock_EnablePll(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
 
-  // Podesi HSI oscilator i PLL
   RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSI;
   RCC_OscInitStruct.HSIState = RCC_HSI_ON;
   RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
@@ -39,15 +52,235 @@ void SystemClock_Config(void)
   RCC_OscInitStruct.PLL.PLLQ = RCC_PLLQ_DIV2;
   RCC_OscInitStruct.PLL.PLLR = RCC_PLLR_DIV2;
 
-  HAL_RCC_OscConfig(&RCC_OscInitStruct);
+  return HAL_RCC_OscConfig(&RCC_OscInitStruct);
+}
+
+static HAL_StatusTypeDef SystemClock_SelectSource(uint32_t source, uint32_t flash_latency)
+{
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
 
-  // Podesi clock izvore i delioce
   RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
                               | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.SYSCLKSource = source;
   RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
   RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
   RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
 
-  HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_4);
-}
\ No newline at end of file
+  return HAL_RCC_ClockConfig(&RCC_ClkInitStruct, flash_latency);
+}
+
+/* SYSCLK mux, called by timebase_switch_clock() at the TIM2 update that
+ * loads the new prescaler. Both clocks are running, so SWS follows within
+ * a few cycles of each. */
+static void SystemClock_Mux(void)
+{
+  __HAL_RCC_SYSCLK_CONFIG(switch_source);
+  while (__HAL_RCC_GET_SYSCLK_SOURCE() != (switch_source << RCC_CFGR_SWS_Pos))
+  {
+  }
+}
+
+/* Run-time switch between two running clocks. Unlike HAL_RCC_ClockConfig
+ * the mux is switched together with the TIM2 prescaler, so the timebase
+ * keeps its 1 us tick. AHB/APB dividers stay /1 from SystemClock_Config. */
+static HAL_StatusTypeDef SystemClock_SwitchSource(uint32_t source, uint32_t flash_latency, uint32_t hz)
+{
+  /* More wait states before speeding up, fewer only after slowing down */
+  if (flash_latency > __HAL_FLASH_GET_LATENCY())
+  {
+    __HAL_FLASH_SET_LATENCY(flash_latency);
+    if (__HAL_FLASH_GET_LATENCY() != flash_latency)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  switch_source = source;
+  timebase_switch_clock((hz / 1000000U) - 1U, SystemClock_Mux);
+
+  if (flash_latency < __HAL_FLASH_GET_LATENCY())
+  {
+    __HAL_FLASH_SET_LATENCY(flash_latency);
+  }
+
+  SystemCoreClockUpdate();
+  return HAL_InitTick(uwTickPrio);
+}
+
+/* 80 MHz PLL -> 16 MHz MSI, then drop to range 2 and stop the PLL.
+ * Range 2 allows 6/12/18 MHz at 0/1/2 wait states, so 16 MHz needs
+ * FLASH_LATENCY_2 (1 wait state is only enough in range 1). HSI16
+ * stays on as the I2C2 and USART2 kernel clock, so a display transfer
+ * or a byte on the UART in flight is not disturbed by the switch. */
+static HAL_StatusTypeDef SystemClock_EnterLow(void)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_MSI;
+  RCC_OscInitStruct.MSIState = RCC_MSI_ON;
+  RCC_OscInitStruct.MSICalibrationValue = RCC_MSICALIBRATION_DEFAULT;
+  RCC_OscInitStruct.MSIClockRange = SYSCLK_LOW_MSI_RANGE;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  if (SystemClock_SwitchSource(RCC_SYSCLKSOURCE_MSI, FLASH_LATENCY_2, SYSCLK_LOW_HZ) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  /* PLL is no longer needed */
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_OFF;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  return HAL_PWREx_ControlVoltageScaling(PWR_REGULATOR_VOLTAGE_SCALE2);
+}
+
+/* Range 1 first, then PLL back on and switch SYSCLK to it */
+static HAL_StatusTypeDef SystemClock_EnterFull(void)
+{
+  if (HAL_PWREx_ControlVoltageScaling(PWR_REGULATOR_VOLTAGE_SCALE1) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  if (SystemClock_EnablePll() != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  return SystemClock_SwitchSource(RCC_SYSCLKSOURCE_PLLCLK, FLASH_LATENCY_4, SYSCLK_FULL_HZ);
+}
+
+/*******************************************************************************
+ * System clock Initialization
+ ******************************************************************************/
+void SystemClock_Config(void)
+{
+  // Podesi interni regulator napona
+  HAL_PWREx_ControlVoltageScaling(PWR_REGULATOR_VOLTAGE_SCALE1);
+
+  // Podesi HSI oscilator i PLL
+  SystemClock_EnablePll();
+
+  // Podesi clock izvore i delioce
+  SystemClock_SelectSource(RCC_SYSCLKSOURCE_PLLCLK, FLASH_LATENCY_4);
+
+  current_profile = SYSCLK_PROFILE_FULL;
+}
+
+/*******************************************************************************
+ * DWT cycle counter (used for latency measurements)
+ ******************************************************************************/
+void SystemClock_CycleCounterInit(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  profile_entry_cycles = 0;
+}
+
+/*******************************************************************************
+ * Run-time frequency scaling
+ ******************************************************************************/
+/**
+ * @brief  Switch the system clock profile and re-derive every clock dependent
+ *         peripheral setting (TIM prescalers, USART2 BRR, I2C2 TIMINGR).
+ *         The TIM2 prescaler is switched together with SYSCLK.
+ * @note   The transition latency is measured with the DWT cycle counter. The
+ *         RCC switch itself runs partly on each clock, so it is converted
+ *         with the slower of the two frequencies (upper bound).
+ */
+HAL_StatusTypeDef SystemClock_SetProfile(systemclock_profile_t profile)
+{
+  HAL_StatusTypeDef status;
+  systemclock_profile_t previous = current_profile;
+
+  if (profile == current_profile || profile >= SYSCLK_PROFILE_COUNT)
+  {
+    return HAL_OK;
+  }
+
+  uint32_t t0 = DWT->CYCCNT;
+  uint32_t old_mhz = profile_hz(previous) / 1000000U;
+  uint32_t new_mhz = profile_hz(profile) / 1000000U;
+
+  /* Residency of the profile we are leaving */
+  clock_stats.residency_us[previous] += (t0 - profile_entry_cycles) / old_mhz;
+
+  status = (profile == SYSCLK_PROFILE_LOW) ? SystemClock_EnterLow()
+                                           : SystemClock_EnterFull();
+  uint32_t t1 = DWT->CYCCNT;
+
+  /* SystemCoreClock is already updated by SystemClock_SwitchSource */
+  MX_TIM_UpdateClock();
+  MX_USART2_UpdateClock(); // No-op while USART2 runs from HSI16
+  MX_I2C2_UpdateClock();   // No-op while I2C2 runs from HSI16
+  uint32_t t2 = DWT->CYCCNT;
+
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  current_profile = profile;
+  profile_entry_cycles = t2;
+
+  uint32_t slow_mhz = (old_mhz < new_mhz) ? old_mhz : new_mhz;
+  uint32_t latency_us = (t1 - t0) / slow_mhz + (t2 - t1) / new_mhz;
+
+  clock_stats.switches++;
+  clock_stats.last_latency_us[profile] = latency_us;
+  if (latency_us > clock_stats.max_latency_us[profile])
+  {
+    clock_stats.max_latency_us[profile] = latency_us;
+  }
+
+  return status;
+}
+
+systemclock_profile_t SystemClock_GetProfile(void)
+{
+  return current_profile;
+}
+
+void SystemClock_GetStats(systemclock_stats_t *stats)
+{
+  *stats = clock_stats;
+
+  /* Include time spent in the current profile so far */
+  uint32_t mhz = profile_hz(current_profile) / 1000000U;
+  stats->residency_us[current_profile] += (DWT->CYCCNT - profile_entry_cycles) / mhz;
+}
+
+/**
+ * @brief  Estimated energy per measurement from profile residency and the
+ *         datasheet run currents: E = VDD * sum(t_profile * I_profile) / n.
+ * @param  measurements Number of measurements taken over the residency window.
+ * @retval Energy per measurement [nJ].
+ */
+uint32_t SystemClock_EnergyPerMeasurement_nJ(uint32_t measurements)
+{
+  systemclock_stats_t stats;
+
+  if (measurements == 0)
+  {
+    return 0;
+  }
+
+  SystemClock_GetStats(&stats);
+
+  /* us * uA = pC; pC * mV = fJ; fJ / 1e6 = nJ */
+  uint64_t charge_pc = stats.residency_us[SYSCLK_PROFILE_FULL] * SYSCLK_FULL_RUN_CURRENT_UA
+                     + stats.residency_us[SYSCLK_PROFILE_LOW]  * (SYSCLK_LOW_RUN_CURRENT_UA
+                                                                  + SYSCLK_HSI16_CURRENT_UA);
+  uint64_t energy_nj = (charge_pc * SYSCLK_SUPPLY_MV) / 1000000U;
+
+  return (uint32_t)(energy_nj / measurements);
+}
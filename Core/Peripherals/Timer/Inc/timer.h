@@ -14,13 +14,15 @@ extern "C" {
 /****************************************************************
  * Defines
 ****************************************************************/
+#define TIM4_TICK_HZ    10000U   /**< Buzzer cadence timer tick [Hz] */
 
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
 void MX_TIM1_Init(void);
 void MX_TIM2_Init(void);
-void MX_TIM3_Init(void);
+void MX_TIM4_Init(void);
+void MX_TIM_UpdateClock(void);
 
 
 #ifdef __cplusplus
@@ -14,10 +14,14 @@
  ******************************************************************************/
 #include "main.h"
 #include "stm32l4xx_hal.h"
+#include "timer.h"
+#include "dma.h"
 
 extern TIM_HandleTypeDef htim1;
 extern TIM_HandleTypeDef htim2;
-extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
+extern DMA_HandleTypeDef hdma_tim1_up;
+extern DMA_HandleTypeDef hdma_tim4_ch1;
 /*******************************************************************************
  * Timer Initialization
  ******************************************************************************/
@@ -45,21 +49,6 @@ void MX_TIM2_Init(void)
     }
 }
 
-void MX_TIM3_Init(void)
-{
-    __HAL_RCC_TIM3_CLK_ENABLE();
-
-    htim3.Instance = TIM3;
-    htim3.Init.Prescaler = (SystemCoreClock / 1000000) - 1;;  // Prescaler da bi TIM3 kucao na 1 MHz (1 us tick)
-    htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
-    htim3.Init.Period = 0xFFFF;  // Max period, tajmer radi slobodno kao merač
-    htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-    htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-    if (HAL_TIM_Base_Init(&htim3) != HAL_OK)
-    {
-        Error_Handler();
-    }
-}
 void MX_TIM1_Init(void)
 {
     __HAL_RCC_TIM1_CLK_ENABLE();
@@ -102,6 +91,87 @@ void MX_TIM1_Init(void)
     HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_4);
 }
 
+/**
+ * @brief TIM4 - buzzer cadence master.
+ *        10 kHz tick, OC1REF (PWM1) is high for the beep ON time and is
+ *        routed to TRGO, which gates TIM1 through ITR3. The CC1 event at
+ *        the end of the ON time is a DMA request (see HAL_TIM_PWM_MspInit).
+ */
+void MX_TIM4_Init(void)
+{
+    __HAL_RCC_TIM4_CLK_ENABLE();
+    TIM_MasterConfigTypeDef sMasterConfig = {0};
+    TIM_OC_InitTypeDef sConfigOC = {0};
+
+    htim4.Instance = TIM4;
+    htim4.Init.Prescaler = (SystemCoreClock / TIM4_TICK_HZ) - 1;  // 100 us tick
+    htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim4.Init.Period = TIM4_TICK_HZ - 1;                          // 1 s kadenca inicijalno
+    htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE; // Nova kadenca tek od sledeceg perioda
+    if (HAL_TIM_PWM_Init(&htim4) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    sConfigOC.OCMode = TIM_OCMODE_PWM1;
+    sConfigOC.Pulse = 0;                  // Gate zatvoren
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    if (HAL_TIM_PWM_ConfigChannel(&htim4, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+    {
+        Error_Handler();
+    }
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_OC1REF;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htim4, &sMasterConfig) != HAL_OK)
+    {
+        Error_Handler();
+    }
+}
+
+void HAL_TIM_PWM_MspInit(TIM_HandleTypeDef *htim)
+{
+    if(htim->Instance == TIM1)
+    {
+        /* TIM1_UP DMA: burst writes of ARR..CCR4 for buzzer patterns */
+        hdma_tim1_up.Instance = DMA_TIM1_UP_CHANNEL;
+        hdma_tim1_up.Init.Request = DMA_TIM1_UP_REQUEST;
+        hdma_tim1_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        hdma_tim1_up.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_tim1_up.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_tim1_up.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+        hdma_tim1_up.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+        hdma_tim1_up.Init.Mode = DMA_NORMAL;
+        hdma_tim1_up.Init.Priority = DMA_PRIORITY_MEDIUM;
+        if (HAL_DMA_Init(&hdma_tim1_up) != HAL_OK)
+        {
+            Error_Handler();
+        }
+
+        __HAL_LINKDMA(htim, hdma[TIM_DMA_ID_UPDATE], hdma_tim1_up);
+    }
+    else if(htim->Instance == TIM4)
+    {
+        /* TIM4_CH1 DMA: writes UG to TIM1 when the beep ends (buzzer.c) */
+        hdma_tim4_ch1.Instance = DMA_TIM4_CH1_CHANNEL;
+        hdma_tim4_ch1.Init.Request = DMA_TIM4_CH1_REQUEST;
+        hdma_tim4_ch1.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        hdma_tim4_ch1.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_tim4_ch1.Init.MemInc = DMA_MINC_DISABLE;
+        hdma_tim4_ch1.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+        hdma_tim4_ch1.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+        hdma_tim4_ch1.Init.Mode = DMA_CIRCULAR;
+        hdma_tim4_ch1.Init.Priority = DMA_PRIORITY_HIGH;
+        if (HAL_DMA_Init(&hdma_tim4_ch1) != HAL_OK)
+        {
+            Error_Handler();
+        }
+
+        __HAL_LINKDMA(htim, hdma[TIM_DMA_ID_CC1], hdma_tim4_ch1);
+    }
+}
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim)
 {
@@ -122,3 +192,71 @@ void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim)
         HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
     }
 }
+
+/*******************************************************************************
+ * Clock change handling
+ ******************************************************************************/
+/* TIM1: the new prescaler is only preloaded and taken at the next update,
+ * one tone period later while the counter runs. A closed cadence gate
+ * stops the counter and holds that update back, and until it comes the
+ * tone plays at the wrong pitch, so main.c keeps the full speed profile
+ * while the hardware cadence sounds. */
+static void TIM_PreloadPrescaler(TIM_HandleTypeDef *htim, uint32_t prescaler)
+{
+    if (htim->Instance == NULL)
+    {
+        return;     // Tajmer jos nije inicijalizovan
+    }
+
+    htim->Instance->PSC = prescaler;
+    htim->Init.Prescaler = prescaler;
+}
+
+/* TIM4: the cadence period runs for up to seconds, too long to wait for
+ * its update, so the prescaler is loaded at once and the count written
+ * back. The prescaler restarts, which delays the cadence by less than one
+ * 100 us tick per switch. */
+static void TIM_ReloadPrescaler(TIM_HandleTypeDef *htim, uint32_t prescaler)
+{
+    TIM_TypeDef *tim = htim->Instance;
+
+    if (tim == NULL)
+    {
+        return;     // Tajmer jos nije inicijalizovan
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t cr1 = tim->CR1;
+
+    tim->SR  = ~TIM_SR_UIF;
+    uint32_t cnt = tim->CNT;
+
+    tim->CR1 = cr1 | TIM_CR1_URS;   // UG ne sme da postavi UIF
+    tim->PSC = prescaler;
+    tim->EGR = TIM_EGR_UG;          // Prenesi PSC iz preload registra
+    if (!(tim->SR & TIM_SR_UIF))
+    {
+        tim->CNT = cnt;             // Preko ARR u medjuvremenu: ostaje 0
+    }
+    tim->CR1 = cr1;
+
+    __set_PRIMASK(primask);
+
+    htim->Init.Prescaler = prescaler;
+}
+
+/**
+ * @brief Re-derive all timer prescalers from the current SystemCoreClock.
+ *        Called after every system clock profile switch. TIM2 is already
+ *        switched by timebase_switch_clock() together with SYSCLK.
+ */
+void MX_TIM_UpdateClock(void)
+{
+    uint32_t prescaler = (SystemCoreClock / 1000000) - 1;   // 1 us tick
+
+    TIM_PreloadPrescaler(&htim1, prescaler);
+    htim2.Init.Prescaler = prescaler;
+    TIM_ReloadPrescaler(&htim4, (SystemCoreClock / TIM4_TICK_HZ) - 1);
+}
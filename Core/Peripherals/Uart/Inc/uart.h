@@ -10,16 +10,25 @@ extern "C" {
 ****************************************************************/
 #include "main.h"
 #include "stm32l4xx_hal.h"
+#include <stdbool.h>
 
 /****************************************************************
  * Defines
 ****************************************************************/
+#define USART2_RX_BUFFER_LEN   64U   /**< Received bytes not yet read, power of 2 */
+#define USART2_IDLE_TIMEOUT_MS 2U    /**< Wait for an idle line before a BRR change [ms] */
 
 
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
 void MX_USART2_UART_Init(void);
+void MX_USART2_UpdateClock(void);
+HAL_StatusTypeDef MX_USART2_Write(const uint8_t *data, uint16_t size);
+uint32_t MX_USART2_GetDrops(void);
+void MX_USART2_StartRx(void);
+bool MX_USART2_Read(uint8_t *byte);
+void MX_USART2_IRQHandler(void);
 
 
 #ifdef __cplusplus
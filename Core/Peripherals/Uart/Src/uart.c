@@ -14,9 +14,21 @@
  ******************************************************************************/
 #include "main.h"
 #include "stm32l4xx_hal.h"
+#include "uart.h"
+#include "irq_conf.h"
 
 extern UART_HandleTypeDef huart2;
 
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint32_t usart2_drops;   /**< Messages not sent within their deadline */
+
+/* Receive ring: written by the USART2 ISR, read by the main loop */
+static volatile uint8_t  usart2_rx[USART2_RX_BUFFER_LEN];
+static volatile uint32_t usart2_rx_head;
+static volatile uint32_t usart2_rx_tail;
+
 /*******************************************************************************
  * Uart Initialization
  ******************************************************************************/
@@ -35,4 +47,119 @@ void MX_USART2_UART_Init(void)
   huart2.AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
 
   HAL_UART_Init(&huart2);
-}
\ No newline at end of file
+}
+/*******************************************************************************
+ * Clock change handling
+ ******************************************************************************/
+/**
+ * @brief Recompute the USART2 baud rate divider from its kernel clock.
+ *        Called after every system clock profile switch. USART2 runs from
+ *        HSI16, so the divider normally stays the same and the peripheral
+ *        is left enabled; clearing UE would drop a byte being received.
+ *        Should the clock ever change, the rewrite waits for the line to
+ *        go idle first.
+ */
+void MX_USART2_UpdateClock(void)
+{
+  if (huart2.Instance == NULL)
+  {
+    return;
+  }
+
+  uint32_t brr = UART_DIV_SAMPLING16(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_USART2), huart2.Init.BaudRate);
+  if (brr == huart2.Instance->BRR)
+  {
+    return;
+  }
+
+  /* One frame at the old rate at most: 87 us at 115200 */
+  uint32_t t0 = HAL_GetTick();
+  while ((!__HAL_UART_GET_FLAG(&huart2, UART_FLAG_TC) || __HAL_UART_GET_FLAG(&huart2, UART_FLAG_BUSY))
+         && (HAL_GetTick() - t0) < USART2_IDLE_TIMEOUT_MS)
+  {
+  }
+
+  __HAL_UART_DISABLE(&huart2);
+  huart2.Instance->BRR = brr;
+  __HAL_UART_ENABLE(&huart2);
+}
+
+/*******************************************************************************
+ * Bounded transmit
+ ******************************************************************************/
+/**
+ * @brief  Transmit with a deadline of twice the message time at the
+ *         configured baud rate (10 bits per byte) instead of HAL_MAX_DELAY.
+ *         A message that does not get out in time is dropped and counted.
+ */
+HAL_StatusTypeDef MX_USART2_Write(const uint8_t *data, uint16_t size)
+{
+  uint32_t timeout_ms = (2U * size * 10U * 1000U) / huart2.Init.BaudRate + 2U;
+
+  HAL_StatusTypeDef status = HAL_UART_Transmit(&huart2, (uint8_t*)data, size, timeout_ms);
+  if (status != HAL_OK)
+  {
+    usart2_drops++;
+  }
+
+  return status;
+}
+
+uint32_t MX_USART2_GetDrops(void)
+{
+  return usart2_drops;
+}
+
+/*******************************************************************************
+ * Interrupt-driven receive
+ ******************************************************************************/
+/**
+ * @brief Receive into a ring by the RXNE interrupt. Transmit stays polled,
+ *        so the HAL receive state machine is not used.
+ */
+void MX_USART2_StartRx(void)
+{
+  usart2_rx_head = 0;
+  usart2_rx_tail = 0;
+  __HAL_UART_CLEAR_FLAG(&huart2, UART_CLEAR_OREF);
+  __HAL_UART_ENABLE_IT(&huart2, UART_IT_RXNE);
+  HAL_NVIC_SetPriority(USART2_IRQn, IRQ_PRIO_UART_RX, 0);
+  HAL_NVIC_EnableIRQ(USART2_IRQn);
+}
+
+/**
+ * @brief Oldest received byte, false if none.
+ */
+bool MX_USART2_Read(uint8_t *byte)
+{
+  uint32_t tail = usart2_rx_tail;
+
+  if (tail == usart2_rx_head)
+  {
+    return false;
+  }
+  *byte = usart2_rx[tail & (USART2_RX_BUFFER_LEN - 1U)];
+  usart2_rx_tail = tail + 1U;
+  return true;
+}
+
+void MX_USART2_IRQHandler(void)
+{
+  uint32_t isr = huart2.Instance->ISR;
+
+  if (isr & USART_ISR_ORE)
+  {
+    __HAL_UART_CLEAR_FLAG(&huart2, UART_CLEAR_OREF);
+  }
+  if (isr & USART_ISR_RXNE)
+  {
+    uint8_t  byte = (uint8_t)huart2.Instance->RDR;   // Clears RXNE
+    uint32_t head = usart2_rx_head;
+
+    if (head - usart2_rx_tail < USART2_RX_BUFFER_LEN)  // Full: drop the byte
+    {
+      usart2_rx[head & (USART2_RX_BUFFER_LEN - 1U)] = byte;
+      usart2_rx_head = head + 1U;
+    }
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_conf.h"
+#include "hcsr04.h"
+#include "calib.h"
+#include "policy.h"
+#include "occupancy.h"
+#include "stats.h"
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+/* Everything decided from the validated pings, in the order main.c and
+ * the host replay (Tools/replay) run it */
+typedef struct {
+    timer_tick_t          raw_us;        /**< Last accepted echo before calibration, 0 = none yet */
+    timer_tick_t          echo_us;       /**< Same, calibrated; held over missed pings */
+    hcsr04_distance_t     distance;      /**< From echo_us [cm], -1 = none yet */
+    timer_tick_t          capture_us;    /**< Echo edge of the last ping, the decisions' latency tag */
+    bool                  pinged;        /**< A ping was decided in this pass */
+    bool                  fresh;         /**< It was accepted: raw_us is new */
+    bool                  valid;         /**< The last ping was accepted */
+    uint8_t               reason;        /**< hcsr04_reason_t of the last ping */
+    const policy_entry_t *policy;        /**< Buzzer and display decision */
+#if APP_OCCUPANCY
+    occupancy_t           bay;
+    int32_t               shown_cm100;   /**< Readout on the panels, -1 = none */
+#endif
+#if APP_STATS
+    stats_stream_t        stats_distance; /**< [cm], accepted echoes */
+    stats_stream_t        stats_latency;  /**< [us], every ping */
+#endif
+} pipeline_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void pipeline_init(pipeline_t *pipe, uint32_t now_ms);
+void pipeline_echo(pipeline_t *pipe, const hcsr04_result_t *result, const calib_table_t *calib);
+float pipeline_readout(pipeline_t *pipe);
+#if APP_STATS
+void pipeline_stats(pipeline_t *pipe, uint32_t latency_us);
+#endif
+#if APP_OCCUPANCY
+bool pipeline_occupancy(pipeline_t *pipe, uint32_t now_ms, occupancy_event_t *event);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PIPELINE_H */
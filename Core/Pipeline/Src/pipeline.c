@@ -0,0 +1,124 @@
+/**
+ * @file    pipeline.c
+ * @brief   Parking-Sensor project.
+ * @details From a validated ping to the buzzer, display, occupancy and
+ *          statistics decisions. No HAL and no time source of its own,
+ *          so the host replay (Tools/replay) runs the same code on
+ *          recorded field traces that the main loop runs on the sensor.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "pipeline.h"
+#include <stdlib.h>
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void pipeline_init(pipeline_t *pipe, uint32_t now_ms)
+{
+    pipe->raw_us     = 0;
+    pipe->echo_us    = 0;
+    pipe->distance   = -1.0f;
+    pipe->capture_us = 0;
+    pipe->pinged     = false;
+    pipe->fresh      = false;
+    pipe->valid      = false;
+    pipe->reason     = HCSR04_REASON_TIMEOUT;
+    pipe->policy     = Policy_Lookup(0);
+#if APP_OCCUPANCY
+    static const occupancy_conf_t conf = {
+        .enter_cm100    = APP_OCC_ENTER_CM * 100U,
+        .exit_cm100     = APP_OCC_EXIT_CM * 100U,
+        .enter_dwell_ms = APP_OCC_ENTER_DWELL_MS,
+        .exit_dwell_ms  = APP_OCC_EXIT_DWELL_MS,
+        .debounce       = APP_OCC_DEBOUNCE,
+        .heartbeat_ms   = APP_OCC_HEARTBEAT_MS,
+    };
+
+    occupancy_init(&pipe->bay, &conf, now_ms);
+    pipe->shown_cm100 = -1;
+#else
+    (void)now_ms;
+#endif
+#if APP_STATS
+    stats_init(&pipe->stats_distance, 0.0f, APP_STATS_RANGE_CM);
+    stats_init(&pipe->stats_latency, 0.0f, (float)(HS_SR04_ECHO_TIMEOUT_US + 1000U));
+#endif
+}
+
+/**
+ * @brief  One main loop pass.
+ * @param  result  Validated ping of this pass, NULL if none was sent.
+ * @param  calib   Per-unit correction, NULL for none.
+ */
+void pipeline_echo(pipeline_t *pipe, const hcsr04_result_t *result, const calib_table_t *calib)
+{
+    pipe->pinged = (result != NULL);
+    pipe->fresh  = false;
+
+    if (result != NULL) {
+        pipe->reason     = result->reason;
+        pipe->capture_us = result->capture_us;
+        pipe->valid      = (result->echo_us != 0); /* 0 = low confidence or none */
+        if (pipe->valid) {
+            pipe->fresh  = true;
+            pipe->raw_us = result->echo_us;
+        }
+    }
+
+    /* The last known echo holds the buzzer over a missed ping */
+    pipe->echo_us  = ((pipe->raw_us != 0) && (calib != NULL)) ? calib_apply(calib, pipe->raw_us) : pipe->raw_us;
+    pipe->distance = (pipe->echo_us != 0) ? HCSR04_echo_to_cm(pipe->echo_us) : -1.0f;
+    pipe->policy   = Policy_Lookup(pipe->echo_us);
+}
+
+#if APP_STATS
+void pipeline_stats(pipeline_t *pipe, uint32_t latency_us)
+{
+    if (pipe->fresh) {
+        stats_add(&pipe->stats_distance, pipe->distance);
+    }
+    if (pipe->pinged) {
+        stats_add(&pipe->stats_latency, (float)latency_us);
+    }
+}
+#endif
+
+#if APP_OCCUPANCY
+/* Every ping is a sample: an accepted echo is a distance, no echo or one
+ * past the range is an empty bay, a rejected echo tells nothing */
+bool pipeline_occupancy(pipeline_t *pipe, uint32_t now_ms, occupancy_event_t *event)
+{
+    uint32_t cm100 = OCCUPANCY_NO_SAMPLE;
+
+    if (pipe->fresh) {
+        cm100 = POLICY_ECHO_TO_CM100(pipe->echo_us);
+    } else if (pipe->pinged && ((pipe->reason == HCSR04_REASON_TIMEOUT) ||
+                                (pipe->reason == HCSR04_REASON_LONG))) {
+        cm100 = OCCUPANCY_NO_TARGET;
+    }
+    return occupancy_update(&pipe->bay, cm100, now_ms, event);
+}
+#endif
+
+/* Distance for the panels. In event mode it holds until the distance moves
+ * by APP_OCC_DISPLAY_STEP_CM, so a parked vehicle redraws nothing. */
+float pipeline_readout(pipeline_t *pipe)
+{
+#if APP_OCCUPANCY
+    int32_t cm100 = pipe->valid ? (int32_t)(pipe->distance * 100.0f) : -1;
+
+    if ((cm100 < 0) || (pipe->shown_cm100 < 0) ||
+        (abs(cm100 - pipe->shown_cm100) >= (int32_t)APP_OCC_DISPLAY_STEP_CM * 100)) {
+        pipe->shown_cm100 = cm100;
+    }
+    return (pipe->shown_cm100 < 0) ? pipe->distance : (float)pipe->shown_cm100 / 100.0f;
+#else
+    return pipe->distance;
+#endif
+}
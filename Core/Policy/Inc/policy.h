@@ -0,0 +1,91 @@
+#ifndef _POLICY_H
+#define _POLICY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define POLICY_TICK_SHIFT          4U      /**< Bin width = 16 us of echo (~0.27 cm) */
+#define POLICY_BINS                256U    /**< Table covers echoes up to 4096 us (~70 cm) */
+#define POLICY_RANGE_END_CM100     0xFFFFU /**< Upper bound of the last zone */
+
+#define POLICY_TONE_HZ             2000U   /**< Default buzzer tone [Hz] */
+#define POLICY_CADENCE_STEP_MS     25U     /**< Cadence quantization [ms] */
+#define POLICY_CADENCE_SILENT      0U      /**< cadence_ms: buzzer off */
+#define POLICY_CADENCE_CONTINUOUS  0xFFFFU /**< cadence_ms: steady tone / alarm */
+
+/* Echo time [us] to distance [0.01 cm]: 0.0343 cm/us / 2 * 100 = 343 / 200 */
+#define POLICY_ECHO_TO_CM100(us)   (((uint32_t)(us) * 343U) / 200U)
+
+/**
+ * Zone description, ordered by distance. Bounds in 0.01 cm, lower inclusive.
+ * Cadence is the beep (and pause) length, interpolated linearly from
+ * `near` at the lower bound to `far` at the upper bound.
+ *
+ *   X(name,     lower, upper,                  tone [Hz],      near [ms],                 far [ms],                  display style)
+ */
+#define POLICY_ZONE_TABLE(X, arg) \
+    X(CONTACT,   0,     250,                    POLICY_TONE_HZ, POLICY_CADENCE_CONTINUOUS, POLICY_CADENCE_CONTINUOUS, POLICY_STYLE_OUT_OF_RANGE, arg) \
+    X(APPROACH,  250,   4000,                   POLICY_TONE_HZ, 50,                        500,                       POLICY_STYLE_DISTANCE,     arg) \
+    X(CLEAR,     4000,  POLICY_RANGE_END_CM100, 0,              POLICY_CADENCE_SILENT,     POLICY_CADENCE_SILENT,     POLICY_STYLE_OUT_OF_RANGE, arg)
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef enum {
+#define POLICY_ZONE_ENUM(name, lower, upper, tone, near, far, style, arg) POLICY_ZONE_##name,
+    POLICY_ZONE_TABLE(POLICY_ZONE_ENUM, 0)
+#undef POLICY_ZONE_ENUM
+    POLICY_ZONE_COUNT,
+    POLICY_ZONE_INVALID = POLICY_ZONE_COUNT   /**< No valid echo */
+} policy_zone_t;
+
+typedef enum {
+    POLICY_STYLE_DISTANCE = 0,    /**< Show the measured distance */
+    POLICY_STYLE_OUT_OF_RANGE,    /**< Show "Distance: Invalid" */
+} policy_style_t;
+
+typedef struct {
+    uint8_t  zone;        /**< policy_zone_t */
+    uint8_t  style;       /**< policy_style_t */
+    uint16_t tone_hz;     /**< Buzzer tone [Hz], 0 = silent */
+    uint16_t cadence_ms;  /**< Beep length [ms], or SILENT / CONTINUOUS */
+} policy_entry_t;
+
+/****************************************************************
+ * Table
+****************************************************************/
+extern const policy_entry_t policy_table[POLICY_BINS];
+extern const policy_entry_t policy_invalid;
+
+/**
+ * @brief  O(1) policy lookup, indexed directly by the echo pulse width.
+ * @param  echo_us Echo pulse width [us], 0 when no valid echo was captured.
+ */
+static inline const policy_entry_t *Policy_Lookup(uint32_t echo_us)
+{
+    uint32_t bin = echo_us >> POLICY_TICK_SHIFT;
+
+    if (echo_us == 0U) {
+        return &policy_invalid;
+    }
+    if (bin >= POLICY_BINS) {
+        bin = POLICY_BINS - 1U;
+    }
+    return &policy_table[bin];
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _POLICY_H */
@@ -0,0 +1,86 @@
+/**
+ * @file    policy.c
+ * @brief   Parking-Sensor project.
+ * @details Distance policy table. Every bin of quantized echo time gets the
+ *          zone, buzzer tone, cadence and display style of the distance at
+ *          its centre. The whole table is expanded by the preprocessor from
+ *          POLICY_ZONE_TABLE, so it lives in flash and costs nothing at run
+ *          time beyond one indexed load.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "policy.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+/* Distance at the centre of bin i [0.01 cm] */
+#define POLICY_BIN_CM100(i) \
+    POLICY_ECHO_TO_CM100(((uint32_t)(i) << POLICY_TICK_SHIFT) + (1U << (POLICY_TICK_SHIFT - 1U)))
+
+/* Linear cadence inside a zone, rounded down to the cadence step */
+#define POLICY_LERP(lower, upper, near, far, d) \
+    ((int32_t)(near) + ((int32_t)(far) - (int32_t)(near)) * ((int32_t)(d) - (int32_t)(lower)) \
+                       / ((int32_t)(upper) - (int32_t)(lower)))
+#define POLICY_QUANTIZE(ms)  ((ms) - (ms) % (int32_t)POLICY_CADENCE_STEP_MS)
+#define POLICY_CADENCE(lower, upper, near, far, d) \
+    (((near) == (far)) ? (near) : POLICY_QUANTIZE(POLICY_LERP(lower, upper, near, far, d)))
+
+/* One link of the "first zone whose upper bound lies above d" chain per field */
+#define POLICY_PICK_ZONE(name, lower, upper, tone, near, far, style, d) \
+    ((d) < (upper)) ? POLICY_ZONE_##name :
+#define POLICY_PICK_STYLE(name, lower, upper, tone, near, far, style, d) \
+    ((d) < (upper)) ? (style) :
+#define POLICY_PICK_TONE(name, lower, upper, tone, near, far, style, d) \
+    ((d) < (upper)) ? (tone) :
+#define POLICY_PICK_CADENCE(name, lower, upper, tone, near, far, style, d) \
+    ((d) < (upper)) ? POLICY_CADENCE(lower, upper, near, far, d) :
+
+#define POLICY_ENTRY(i) {                                                                       \
+    .zone       = (uint8_t)(POLICY_ZONE_TABLE(POLICY_PICK_ZONE, POLICY_BIN_CM100(i))             \
+                            POLICY_ZONE_INVALID),                                               \
+    .style      = (uint8_t)(POLICY_ZONE_TABLE(POLICY_PICK_STYLE, POLICY_BIN_CM100(i))            \
+                            POLICY_STYLE_OUT_OF_RANGE),                                         \
+    .tone_hz    = (uint16_t)(POLICY_ZONE_TABLE(POLICY_PICK_TONE, POLICY_BIN_CM100(i)) 0U),       \
+    .cadence_ms = (uint16_t)(POLICY_ZONE_TABLE(POLICY_PICK_CADENCE, POLICY_BIN_CM100(i))         \
+                             POLICY_CADENCE_SILENT),                                            \
+}
+
+#define POLICY_R1(i)    POLICY_ENTRY(i),
+#define POLICY_R4(i)    POLICY_R1(i)   POLICY_R1((i) + 1)   POLICY_R1((i) + 2)   POLICY_R1((i) + 3)
+#define POLICY_R16(i)   POLICY_R4(i)   POLICY_R4((i) + 4)   POLICY_R4((i) + 8)   POLICY_R4((i) + 12)
+#define POLICY_R64(i)   POLICY_R16(i)  POLICY_R16((i) + 16) POLICY_R16((i) + 32) POLICY_R16((i) + 48)
+#define POLICY_R256(i)  POLICY_R64(i)  POLICY_R64((i) + 64) POLICY_R64((i) + 128) POLICY_R64((i) + 192)
+
+/*******************************************************************************
+ * Build-time checks
+ ******************************************************************************/
+_Static_assert(POLICY_BINS == 256U, "POLICY_R256 must match POLICY_BINS");
+
+#define POLICY_CHECK_ZONE(name, lower, upper, tone, near, far, style, arg) \
+    _Static_assert((lower) < (upper), "policy zone " #name " is empty");
+POLICY_ZONE_TABLE(POLICY_CHECK_ZONE, 0)
+
+/* Echoes past the table are clamped to the last bin, which must be silent */
+_Static_assert((POLICY_ZONE_TABLE(POLICY_PICK_CADENCE, POLICY_BIN_CM100(POLICY_BINS - 1U))
+                POLICY_CADENCE_SILENT) == POLICY_CADENCE_SILENT,
+               "last policy bin must be silent");
+
+/*******************************************************************************
+ * Tables
+ ******************************************************************************/
+const policy_entry_t policy_table[POLICY_BINS] = {
+    POLICY_R256(0)
+};
+
+const policy_entry_t policy_invalid = {
+    .zone       = POLICY_ZONE_INVALID,
+    .style      = POLICY_STYLE_OUT_OF_RANGE,
+    .tone_hz    = 0U,
+    .cadence_ms = POLICY_CADENCE_SILENT,
+};
@@ -99,6 +99,7 @@ _BEGIN_STD_C
 /* ^^^ SPI config ^^^ */
 
 #if defined(SSD1306_USE_I2C)
+#include "i2c_bus.h"   // All I2C traffic goes through the bus manager
 extern I2C_HandleTypeDef SSD1306_I2C_PORT;
 #elif defined(SSD1306_USE_SPI)
 extern SPI_HandleTypeDef SSD1306_SPI_PORT;
@@ -120,6 +121,31 @@ extern SPI_HandleTypeDef SSD1306_SPI_PORT;
 #define SSD1306_BUFFER_SIZE   SSD1306_WIDTH * SSD1306_HEIGHT / 8
 #endif
 
+// Time from reset until the controller takes commands
+#ifndef SSD1306_POWER_UP_MS
+#define SSD1306_POWER_UP_MS     100
+#endif
+
+// Deadline of a blocking I2C write: 9 bits per byte at 100 kHz plus slack
+#ifndef SSD1306_I2C_TIMEOUT_MS
+#define SSD1306_I2C_TIMEOUT_MS(bytes)  (2U + ((bytes) * 9U) / 100U)
+#endif
+
+// Longest a wait for queued or in-flight DMA frames may take before they
+// are abandoned (two full frames at 100 kHz)
+#ifndef SSD1306_XFER_TIMEOUT_MS
+#define SSD1306_XFER_TIMEOUT_MS 250U
+#endif
+
+// Frame data goes out in chunks of this size, so other devices on the bus
+// wait for at most one chunk (one page by default)
+#ifndef SSD1306_DMA_CHUNK
+#define SSD1306_DMA_CHUNK       SSD1306_WIDTH
+#endif
+
+// Init command table: 28 setup bytes and the 6 byte full-screen window
+#define SSD1306_INIT_CMDS_MAX   34
+
 //Clients enums for returning values of functions
 typedef enum{
 	UNINITIALIZED_OLED_INIT = 0,
@@ -147,18 +173,76 @@ typedef enum {
     SSD1306_ERR = 0x01  // Generic error.
 } SSD1306_Error_t;
 
-// Struct to store transformations
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+} SSD1306_VERTEX;
+
+// Render vs. transfer timing, all in microseconds (see ssd1306_GetTimeUs)
 typedef struct {
+    uint32_t frames;            // Frames presented
+    uint32_t render_us;         // ssd1306_BeginFrame -> ssd1306_Present
+    uint32_t render_max_us;
+    uint32_t transfer_us;       // Present -> last byte on the bus
+    uint32_t transfer_max_us;
+    uint32_t wait_us;           // Present blocked on the previous frame
+    uint32_t wait_max_us;
+    uint32_t errors;            // Failed transfers
+} SSD1306_FrameStats_t;
+
+// Frame transfer state of one panel
+typedef enum {
+    SSD1306_XFER_IDLE = 0,
+    SSD1306_XFER_WINDOW,    // Command phase (window or init table) queued or in flight
+    SSD1306_XFER_DATA       // Frame data queued or in flight
+} SSD1306_XferState_t;
+
+// Panel handle: bus, address, geometry, framebuffers and transformations
+typedef struct SSD1306_Panel {
+#if defined(SSD1306_USE_I2C)
+    I2C_HandleTypeDef *Bus;
+    uint16_t Address;               // Shifted 8-bit I2C address
+    i2c_dev_t Dev;                  // Bus manager device
+    i2c_xfer_t Xfer;                // Current phase of the frame transfer
+#endif
+    uint8_t Width;                  // 128 or less
+    uint8_t Height;                 // 32, 64 or 128
+    uint8_t XOffset;                // First visible column
+    uint8_t *Buffer;                // Back buffer, Width * Height / 8 bytes
+    uint8_t *FrontBuffer;           // Buffer being sent; NULL = blocking updates
     uint16_t CurrentX;
     uint16_t CurrentY;
     uint8_t Initialized;
     uint8_t DisplayOn;
+    volatile uint8_t XferState;     // SSD1306_XferState_t
+    uint8_t Window[6];              // Full-screen window sent ahead of a frame
+    uint8_t InitCmds[SSD1306_INIT_CMDS_MAX]; // Init table for ssd1306_InitPanelAsync
+    uint32_t XferStart;
+    uint32_t RenderStart;
+    uint32_t Tag;                   // Caller's tag of the frame being drawn, 0 = none
+    uint32_t FrontTag;              // Tag of the frame being sent
+    SSD1306_FrameStats_t Stats;
+    struct SSD1306_Panel *Next;     // Next initialized panel
 } SSD1306_t;
 
-typedef struct {
-    uint8_t x;
-    uint8_t y;
-} SSD1306_VERTEX;
+/*
+ * Static panel description, e.g. a second screen on the same bus:
+ *   static uint8_t rear_fb[2][SSD1306_BUFFER_SIZE];
+ *   static SSD1306_t rear = SSD1306_PANEL_INIT(&hi2c2, 0x3D << 1, 128, 64, rear_fb[0], rear_fb[1]);
+ * Pass NULL as front buffer for a single-buffered panel.
+ */
+#if defined(SSD1306_USE_I2C)
+#define SSD1306_PANEL_INIT(bus, addr, width, height, back, front) {             \
+    .Bus = (bus), .Address = (addr), .Width = (width), .Height = (height),      \
+    .XOffset = (SSD1306_X_OFFSET_UPPER << 4) | SSD1306_X_OFFSET_LOWER,          \
+    .Buffer = (back), .FrontBuffer = (front) }
+#else
+#define SSD1306_PANEL_INIT(bus, addr, width, height, back, front) {             \
+    .Width = (width), .Height = (height),                                       \
+    .XOffset = (SSD1306_X_OFFSET_UPPER << 4) | SSD1306_X_OFFSET_LOWER,          \
+    .Buffer = (back), .FrontBuffer = (front) }
+#endif
 
 /** Font */
 typedef struct {
@@ -170,8 +254,42 @@ typedef struct {
 
 // Procedure definitions
 SSD1306_OLED_INIT_T ssd1306_Init(void);
+SSD1306_OLED_INIT_T ssd1306_InitAsync(void);
+SSD1306_OLED_INIT_T ssd1306_InitPanel(SSD1306_t *panel);
+SSD1306_OLED_INIT_T ssd1306_InitPanelAsync(SSD1306_t *panel);
+uint8_t ssd1306_IsPoweredUp(void);
+
+// Panel selection: every call below acts on the selected panel
+// (NULL selects the default panel from ssd1306_conf.h)
+void ssd1306_Select(SSD1306_t *panel);
+SSD1306_t *ssd1306_GetPanel(void);
+
 void ssd1306_Fill(SSD1306_COLOR color);
 SSD1306_OLED_UPRDATE_SCREEN_T ssd1306_UpdateScreen(void);
+SSD1306_Error_t ssd1306_UpdateWindow(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+
+// One-column content scroll (0x2C/0x2D); the controller needs two frame
+// periods after each scroll before it takes the next one
+#define SSD1306_SCROLL_SETTLE_MS  20
+SSD1306_Error_t ssd1306_ScrollColumnLeft(uint8_t x1, uint8_t x2, uint8_t page1, uint8_t page2);
+
+// Frame presentation (double-buffered with SSD1306_USE_DOUBLE_BUFFER)
+void ssd1306_BeginFrame(void);
+SSD1306_Error_t ssd1306_Present(void);
+SSD1306_Error_t ssd1306_PresentPages(uint8_t page1, uint8_t page2);
+uint8_t ssd1306_IsBusy(void);
+void ssd1306_WaitIdle(void);
+#if defined(SSD1306_USE_I2C)
+void ssd1306_AbortBus(I2C_HandleTypeDef *bus);
+#endif
+void ssd1306_GetFrameStats(SSD1306_FrameStats_t *stats);
+uint32_t ssd1306_GetTimeUs(void);
+
+// Frame tags, e.g. the capture time of the data a frame shows: the next
+// frame of the selected panel carries the tag, and ssd1306_FrameShown() gets
+// it back once the frame's last byte is on the bus (may run in the I2C ISR)
+void ssd1306_TagFrame(uint32_t tag);
+void ssd1306_FrameShown(SSD1306_t *panel, uint32_t tag, uint32_t shown_us);
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
 char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color);
 char ssd1306_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color);
@@ -184,6 +302,8 @@ void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
 void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD1306_COLOR color);
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_DrawHLine(uint8_t x1, uint8_t x2, uint8_t y, SSD1306_COLOR color);
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color);
 
 /**
  * @brief Invert color of pixels in rectangle (include border)
@@ -198,6 +318,13 @@ SSD1306_Error_t ssd1306_InvertRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint
 
 void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color);
 
+/**
+ * @brief Opaque copy of a bitmap in screenbuffer (page) format.
+ * @param pages (h + 7) / 8 pages of w bytes, LSB is the top pixel.
+ * @note  A destination y on a page boundary is a direct copy per page.
+ */
+void ssd1306_BlitPages(uint8_t x, uint8_t y, const uint8_t* pages, uint8_t w, uint8_t h);
+
 /**
  * @brief Sets the contrast of the display.
  * @param[in] value contrast to set.
@@ -222,6 +349,7 @@ uint8_t ssd1306_GetDisplayOn();
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
 
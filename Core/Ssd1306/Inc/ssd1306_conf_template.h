@@ -22,7 +22,8 @@
 #define SSD1306_USE_I2C
 //#define SSD1306_USE_SPI
 
-// I2C Configuration
+// I2C Configuration of the default panel (ssd1306_Init); further panels
+// are described with SSD1306_PANEL_INIT
 #define SSD1306_I2C_PORT        hi2c2
 #define SSD1306_I2C_ADDR        (0x3C << 1)
 
@@ -35,6 +36,10 @@
 //#define SSD1306_Reset_Port      OLED_Res_GPIO_Port
 //#define SSD1306_Reset_Pin       OLED_Res_Pin
 
+// Double-buffered framebuffer: draw the next frame while the previous one
+// is sent with I2C DMA (see ssd1306_Present)
+#define SSD1306_USE_DOUBLE_BUFFER
+
 // Mirror the screen if needed
 // #define SSD1306_MIRROR_VERT
 // #define SSD1306_MIRROR_HORIZ
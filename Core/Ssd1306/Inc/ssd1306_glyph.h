@@ -0,0 +1,56 @@
+#ifndef __SSD1306_GLYPH_H__
+#define __SSD1306_GLYPH_H__
+
+#include <stdint.h>
+#include <_ansi.h>
+
+_BEGIN_STD_C
+
+#include "ssd1306.h"
+
+#ifndef SSD1306_GLYPH_POOL_SIZE
+#define SSD1306_GLYPH_POOL_SIZE   512     // Bytes of pre-rendered glyphs per cache
+#endif
+
+#ifndef SSD1306_NUMFIELD_MAX
+#define SSD1306_NUMFIELD_MAX      8       // Characters in a numeric field
+#endif
+
+// Characters of one font pre-rendered in screenbuffer (page) format, so
+// drawing one is a ssd1306_BlitPages instead of a pixel loop over the font
+// bit rows. Glyphs are opaque: background pixels are cleared.
+typedef struct {
+    const SSD1306_Font_t *font;
+    uint8_t width;                  // Cell width [px]
+    uint8_t height;                 // Cell height [px]
+    uint8_t glyph_size;             // width * pages [bytes]
+    uint8_t index[95];              // Glyph number per printable char, 0xFF = not cached
+    uint8_t pool[SSD1306_GLYPH_POOL_SIZE];
+} ssd1306_GlyphCache_t;
+
+// Fixed-width text field that blits only the characters that changed and
+// remembers which columns still have to go to the panel.
+typedef struct {
+    const ssd1306_GlyphCache_t *cache;
+    uint8_t x;
+    uint8_t y;
+    uint8_t length;                         // Characters in the field
+    char shown[SSD1306_NUMFIELD_MAX];       // Text in the screenbuffer, 0 = unknown
+    int16_t dirty_x1;                       // Changed columns, -1 = none
+    int16_t dirty_x2;
+} ssd1306_NumField_t;
+
+SSD1306_Error_t ssd1306_GlyphCacheInit(ssd1306_GlyphCache_t *cache, const SSD1306_Font_t *font,
+                                       const char *chars);
+const uint8_t *ssd1306_GlyphGet(const ssd1306_GlyphCache_t *cache, char ch);
+uint8_t ssd1306_GlyphDrawString(const ssd1306_GlyphCache_t *cache, uint8_t x, uint8_t y, const char *str);
+
+void ssd1306_NumFieldInit(ssd1306_NumField_t *field, const ssd1306_GlyphCache_t *cache,
+                          uint8_t x, uint8_t y, uint8_t length);
+uint8_t ssd1306_NumFieldSet(ssd1306_NumField_t *field, const char *text);
+uint8_t ssd1306_NumFieldTakeDirty(ssd1306_NumField_t *field, uint8_t *x1, uint8_t *x2);
+SSD1306_Error_t ssd1306_NumFieldFlush(ssd1306_NumField_t *field);
+
+_END_STD_C
+
+#endif // __SSD1306_GLYPH_H__
@@ -0,0 +1,30 @@
+#ifndef __SSD1306_GRAPH_H__
+#define __SSD1306_GRAPH_H__
+
+#include <stdint.h>
+#include <_ansi.h>
+
+_BEGIN_STD_C
+
+#include "ssd1306.h"
+
+// Scrolling history plot inside a page-aligned window of the selected panel.
+// Every sample scrolls the window one column left on the panel itself
+// (ssd1306_ScrollColumnLeft) and sends only the new rightmost column.
+typedef struct {
+    uint8_t x;              // Left column of the plot
+    uint8_t width;          // Number of samples shown
+    uint8_t page1;          // First page (top row = 8 * page1)
+    uint8_t page2;          // Last page
+    int32_t full_scale;     // Value plotted on the top row
+    int16_t last_y;         // Row of the previous sample, -1 = gap
+} ssd1306_Graph_t;
+
+void ssd1306_GraphInit(ssd1306_Graph_t *graph, uint8_t x, uint8_t width,
+                       uint8_t page1, uint8_t page2, int32_t full_scale);
+void ssd1306_GraphClear(ssd1306_Graph_t *graph);
+SSD1306_Error_t ssd1306_GraphPush(ssd1306_Graph_t *graph, int32_t value);
+
+_END_STD_C
+
+#endif // __SSD1306_GRAPH_H__
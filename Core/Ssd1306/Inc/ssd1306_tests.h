@@ -5,10 +5,27 @@
 
 _BEGIN_STD_C
 
+#include <stdint.h>
+
+// Old (per-pixel) vs. new timing of one primitive, see ssd1306_TestBenchmark
+typedef struct {
+    const char *name;
+    uint32_t ref_us;        // Per-pixel reference, all runs [us]
+    uint32_t fast_us;       // Span/blit version, all runs [us]
+    uint8_t match;          // Both left the same screenbuffer
+} ssd1306_BenchResult_t;
+
+// Measured full-frame refresh rate, see ssd1306_TestFPS
+typedef struct {
+    uint32_t frames;        // Frames sent in the window
+    uint32_t elapsed_us;    // First frame start to last transfer end [us]
+    uint32_t fps_x100;      // frames / elapsed, in 1/100 FPS
+} ssd1306_FpsResult_t;
+
 void ssd1306_TestBorder(void);
 void ssd1306_TestFonts1(void);
 void ssd1306_TestFonts2(void);
-void ssd1306_TestFPS(void);
+void ssd1306_TestFPS(ssd1306_FpsResult_t *result);
 void ssd1306_TestAll(void);
 void ssd1306_TestLine(void);
 void ssd1306_TestRectangle(void);
@@ -18,6 +35,7 @@ void ssd1306_TestCircle(void);
 void ssd1306_TestArc(void);
 void ssd1306_TestPolyline(void);
 void ssd1306_TestDrawBitmap(void);
+int ssd1306_TestBenchmark(ssd1306_BenchResult_t *results, int max_results);
 
 _END_STD_C
 
@@ -1,23 +1,96 @@
 #include "ssd1306.h"
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>  // For memcpy
 
 
+#if defined(SSD1306_USE_DOUBLE_BUFFER) && !defined(SSD1306_USE_I2C)
+#error "SSD1306_USE_DOUBLE_BUFFER needs the I2C DMA transfer"
+#endif
+
+// Default panel, described by ssd1306_conf.h (used by ssd1306_Init)
+#if defined(SSD1306_USE_DOUBLE_BUFFER)
+// Drawing goes to the back buffer while the front buffer is on its way
+// to the panel; ssd1306_Present() swaps them.
+static uint8_t SSD1306_Buffers[2][SSD1306_BUFFER_SIZE];
+#define SSD1306_DEFAULT_FRONT_BUFFER  SSD1306_Buffers[1]
+#else
+static uint8_t SSD1306_Buffers[1][SSD1306_BUFFER_SIZE];
+#define SSD1306_DEFAULT_FRONT_BUFFER  NULL
+#endif
+
+static SSD1306_t SSD1306_Default = SSD1306_PANEL_INIT(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR,
+                                                      SSD1306_WIDTH, SSD1306_HEIGHT,
+                                                      SSD1306_Buffers[0], SSD1306_DEFAULT_FRONT_BUFFER);
+
+// Screen object: the panel all drawing and transfer calls act on
+static SSD1306_t *SSD1306 = &SSD1306_Default;
+
+// Initialized panels, linked through SSD1306_t.Next
+static SSD1306_t *SSD1306_Panels;
+
+// Gather buffer for windows narrower than the screen
+static uint8_t SSD1306_WindowBuffer[SSD1306_BUFFER_SIZE];
+
+
+static size_t ssd1306_BufferSize(const SSD1306_t *panel) {
+    return (size_t)panel->Width * panel->Height / 8;
+}
+
 #if defined(SSD1306_USE_I2C)
 
 void ssd1306_Reset(void) {
     /* for I2C - do nothing */
 }
 
+/*
+ * Blocking write of one control byte and its payload through the bus
+ * manager. Waits for this panel's own frame first, so the commands do not
+ * land in the middle of it; frames of other devices are overtaken at the
+ * next chunk boundary, which the deadline allows for.
+ */
+static void ssd1306_Write(uint8_t control, uint8_t* data, size_t size) {
+    ssd1306_WaitIdle();
+    if (i2c_dev_write(&SSD1306->Dev, control, 1, data, size,
+                      SSD1306_I2C_TIMEOUT_MS(size + 2 + SSD1306_DMA_CHUNK)) != HAL_OK) {
+        SSD1306->Stats.errors++;
+    }
+}
+
+/*
+ * Drop the frames of every panel on the bus and everything else queued on
+ * it, counting each frame as an error. The DMA is stopped; the I2C
+ * peripheral has to be reset by the caller.
+ */
+void ssd1306_AbortBus(I2C_HandleTypeDef *bus) {
+    i2c_bus_t *manager = i2c_bus_find(bus);
+    if (manager != NULL) {
+        i2c_bus_abort(manager);
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (SSD1306_t *panel = SSD1306_Panels; panel != NULL; panel = panel->Next) {
+        if (panel->Bus == bus && panel->XferState != SSD1306_XFER_IDLE) {
+            panel->XferState = SSD1306_XFER_IDLE;
+            panel->Stats.errors++;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, HAL_MAX_DELAY);
+    ssd1306_Write(0x00, &byte, 1);
+}
+
+// Send a sequence of command bytes in one transaction (Co = 0)
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+    ssd1306_Write(0x00, (uint8_t*)cmds, count);
 }
 
 // Send data
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size, HAL_MAX_DELAY);
+    ssd1306_Write(0x40, buffer, buff_size);
 }
 
 #elif defined(SSD1306_USE_SPI)
@@ -41,6 +114,14 @@ void ssd1306_WriteCommand(uint8_t byte) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
 }
 
+// Send a sequence of command bytes with one chip select
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
+    HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_RESET); // command
+    HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) cmds, count, HAL_MAX_DELAY);
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
+}
+
 // Send data
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
@@ -53,149 +134,632 @@ void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
 #error "You should define SSD1306_USE_SPI or SSD1306_USE_I2C macro"
 #endif
 
+/* Make a panel the target of all following drawing and transfer calls */
+void ssd1306_Select(SSD1306_t *panel) {
+    SSD1306 = (panel != NULL) ? panel : &SSD1306_Default;
+}
 
-// Screenbuffer
-static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE];
-
-// Screen object
-static SSD1306_t SSD1306;
+SSD1306_t *ssd1306_GetPanel(void) {
+    return SSD1306;
+}
 
 /* Fills the Screenbuffer with values from a given buffer of a fixed length */
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
     SSD1306_Error_t ret = SSD1306_ERR;
-    if (len <= SSD1306_BUFFER_SIZE) {
-        memcpy(SSD1306_Buffer,buf,len);
+    if (len <= ssd1306_BufferSize(SSD1306)) {
+        memcpy(SSD1306->Buffer,buf,len);
         ret = SSD1306_OK;
     }
     return ret;
 }
 
-/* Initialize the oled screen */
+/* Initialize the default panel from ssd1306_conf.h */
 SSD1306_OLED_INIT_T ssd1306_Init(void) {
-    // Reset OLED
-    ssd1306_Reset();
+    return ssd1306_InitPanel(&SSD1306_Default);
+}
 
-    // Wait for the screen to boot
-    HAL_Delay(100);
+/* Same, without waiting for the init transfer (see ssd1306_InitPanelAsync) */
+SSD1306_OLED_INIT_T ssd1306_InitAsync(void) {
+    return ssd1306_InitPanelAsync(&SSD1306_Default);
+}
 
-    // Init OLED
-    ssd1306_SetDisplayOn(0); //display off
+/* Power-up time since reset has passed, the controller takes commands */
+uint8_t ssd1306_IsPoweredUp(void) {
+    return HAL_GetTick() >= SSD1306_POWER_UP_MS;
+}
+
+/*
+ * Init sequence of a panel as one command table, ending with the
+ * full-screen window, so it goes out in a single transaction.
+ */
+static size_t ssd1306_InitTable(const SSD1306_t *panel, uint8_t *cmds) {
+    size_t n = 0;
 
-    ssd1306_WriteCommand(0x20); //Set Memory Addressing Mode
-    ssd1306_WriteCommand(0x00); // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
-                                // 10b,Page Addressing Mode (RESET); 11b,Invalid
+    cmds[n++] = 0xAE; // Display off
 
-    ssd1306_WriteCommand(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
+    cmds[n++] = 0x20; // Set Memory Addressing Mode
+    cmds[n++] = 0x00; // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
+                      // 10b,Page Addressing Mode (RESET); 11b,Invalid
+
+    cmds[n++] = 0xB0; // Set Page Start Address for Page Addressing Mode,0-7
 
 #ifdef SSD1306_MIRROR_VERT
-    ssd1306_WriteCommand(0xC0); // Mirror vertically
+    cmds[n++] = 0xC0; // Mirror vertically
 #else
-    ssd1306_WriteCommand(0xC8); //Set COM Output Scan Direction
+    cmds[n++] = 0xC8; // Set COM Output Scan Direction
 #endif
 
-    ssd1306_WriteCommand(0x00); //---set low column address
-    ssd1306_WriteCommand(0x10); //---set high column address
+    cmds[n++] = 0x00; // Set low column address
+    cmds[n++] = 0x10; // Set high column address
 
-    ssd1306_WriteCommand(0x40); //--set start line address - CHECK
+    cmds[n++] = 0x40; // Set start line address
 
-    ssd1306_SetContrast(0xFF);
+    cmds[n++] = 0x81; // Set contrast control register
+    cmds[n++] = 0xFF;
 
 #ifdef SSD1306_MIRROR_HORIZ
-    ssd1306_WriteCommand(0xA0); // Mirror horizontally
+    cmds[n++] = 0xA0; // Mirror horizontally
 #else
-    ssd1306_WriteCommand(0xA1); //--set segment re-map 0 to 127 - CHECK
+    cmds[n++] = 0xA1; // Set segment re-map 0 to 127
 #endif
 
 #ifdef SSD1306_INVERSE_COLOR
-    ssd1306_WriteCommand(0xA7); //--set inverse color
+    cmds[n++] = 0xA7; // Set inverse color
 #else
-    ssd1306_WriteCommand(0xA6); //--set normal color
+    cmds[n++] = 0xA6; // Set normal color
 #endif
 
-// Set multiplex ratio.
-#if (SSD1306_HEIGHT == 128)
-    // Found in the Luma Python lib for SH1106.
-    ssd1306_WriteCommand(0xFF);
-#else
-    ssd1306_WriteCommand(0xA8); //--set multiplex ratio(1 to 64) - CHECK
-#endif
+    // Set multiplex ratio.
+    if (panel->Height == 128) {
+        // Found in the Luma Python lib for SH1106.
+        cmds[n++] = 0xFF;
+    } else {
+        cmds[n++] = 0xA8; // Set multiplex ratio(1 to 64)
+    }
+    // 32 lines: 0x1F; 64 lines: 0x3F, seems to work for 128px high displays too.
+    cmds[n++] = (panel->Height == 32) ? 0x1F : 0x3F;
 
-#if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x1F); //
-#elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x3F); //
-#elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x3F); // Seems to work for 128px high displays too.
-#else
-#error "Only 32, 64, or 128 lines of height are supported!"
-#endif
+    cmds[n++] = 0xA4; // 0xa4,Output follows RAM content;0xa5,Output ignores RAM content
 
-    ssd1306_WriteCommand(0xA4); //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
+    cmds[n++] = 0xD3; // Set display offset
+    cmds[n++] = 0x00; // No offset
 
-    ssd1306_WriteCommand(0xD3); //-set display offset - CHECK
-    ssd1306_WriteCommand(0x00); //-not offset
+    cmds[n++] = 0xD5; // Set display clock divide ratio/oscillator frequency
+    cmds[n++] = 0xF0; // Set divide ratio
 
-    ssd1306_WriteCommand(0xD5); //--set display clock divide ratio/oscillator frequency
-    ssd1306_WriteCommand(0xF0); //--set divide ratio
+    cmds[n++] = 0xD9; // Set pre-charge period
+    cmds[n++] = 0x22;
 
-    ssd1306_WriteCommand(0xD9); //--set pre-charge period
-    ssd1306_WriteCommand(0x22); //
+    cmds[n++] = 0xDA; // Set com pins hardware configuration
+    cmds[n++] = (panel->Height == 32) ? 0x02 : 0x12;
 
-    ssd1306_WriteCommand(0xDA); //--set com pins hardware configuration - CHECK
-#if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x02);
-#elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x12);
-#elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x12);
-#else
-#error "Only 32, 64, or 128 lines of height are supported!"
+    cmds[n++] = 0xDB; // Set vcomh
+    cmds[n++] = 0x20; // 0x20,0.77xVcc
+
+    cmds[n++] = 0x8D; // Set DC-DC enable
+    cmds[n++] = 0x14;
+    cmds[n++] = 0xAF; // Turn on SSD1306 panel
+
+    memcpy(&cmds[n], panel->Window, sizeof(panel->Window));
+    return n + sizeof(panel->Window);
+}
+
+/*
+ * Checks shared by the blocking and the asynchronous init: geometry,
+ * power-up time and whether the panel answers. Selects and registers the
+ * panel; the init commands themselves are sent by the caller.
+ */
+static SSD1306_OLED_INIT_T ssd1306_InitPrepare(SSD1306_t *panel) {
+    if (panel->Height != 32 && panel->Height != 64 && panel->Height != 128) {
+        return UNINITIALIZED_OLED_INIT;
+    }
+
+    ssd1306_Select(panel);
+
+    // Reset OLED
+    ssd1306_Reset();
+
+    // Wait for the screen to boot (counted from reset, not from this call)
+    while (!ssd1306_IsPoweredUp()) {
+    }
+
+#if defined(SSD1306_USE_I2C)
+    i2c_bus_t *bus = i2c_bus_find(panel->Bus);
+    if (bus == NULL) {
+        return UNINITIALIZED_OLED_INIT;
+    }
+    i2c_dev_init(&panel->Dev, bus, panel->Address, "ssd1306");
+
+    // The probe is a blocking HAL call: nothing else may be on the bus
+    if (!i2c_bus_wait_idle(bus, SSD1306_XFER_TIMEOUT_MS) ||
+        HAL_I2C_IsDeviceReady(panel->Bus, panel->Address, 3, 10) != HAL_OK) {
+        return UNINITIALIZED_OLED_INIT;
+    }
 #endif
 
-    ssd1306_WriteCommand(0xDB); //--set vcomh
-    ssd1306_WriteCommand(0x20); //0x20,0.77xVcc
+    // Full-screen window sent ahead of every DMA frame
+    panel->Window[0] = 0x21;
+    panel->Window[1] = panel->XOffset;
+    panel->Window[2] = panel->XOffset + panel->Width - 1;
+    panel->Window[3] = 0x22;
+    panel->Window[4] = 0;
+    panel->Window[5] = panel->Height / 8 - 1;
 
-    ssd1306_WriteCommand(0x8D); //--set DC-DC enable
-    ssd1306_WriteCommand(0x14); //
-    ssd1306_SetDisplayOn(1); //--turn on SSD1306 panel
+    // Set default values for screen object
+    panel->CurrentX = 0;
+    panel->CurrentY = 0;
+    panel->DisplayOn = 1;
+    panel->XferState = SSD1306_XFER_IDLE;
+    panel->Tag = 0;                      // Frames of before the reset never arrive
+    panel->FrontTag = 0;
+
+    if (!panel->Initialized) {
+        panel->Next = SSD1306_Panels;
+        SSD1306_Panels = panel;
+    }
+    panel->Initialized = 1;
+
+    return INITIALIZED_OLED_INIT_SUCCESSFULLY;
+}
+
+/*
+ * Initialize a panel and select it. Panels sharing a bus must have
+ * different addresses. A panel that does not acknowledge its address is
+ * left uninitialized, so a missing rear panel does not stall the loop.
+ */
+SSD1306_OLED_INIT_T ssd1306_InitPanel(SSD1306_t *panel) {
+    if (ssd1306_InitPrepare(panel) != INITIALIZED_OLED_INIT_SUCCESSFULLY) {
+        return UNINITIALIZED_OLED_INIT;
+    }
+
+    // Init OLED: the whole table in one transaction
+    ssd1306_WriteCommands(panel->InitCmds, ssd1306_InitTable(panel, panel->InitCmds));
 
     // Clear screen
     ssd1306_Fill(Black);
     
     // Flush buffer to screen
     ssd1306_UpdateScreen();
-    
-    // Set default values for screen object
-    SSD1306.CurrentX = 0;
-    SSD1306.CurrentY = 0;
-    
-    SSD1306.Initialized = 1;
 
     return INITIALIZED_OLED_INIT_SUCCESSFULLY;
 }
 
 /* Fill the whole screen with the given color */
 void ssd1306_Fill(SSD1306_COLOR color) {
-    memset(SSD1306_Buffer, (color == Black) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
+    memset(SSD1306->Buffer, (color == Black) ? 0x00 : 0xFF, ssd1306_BufferSize(SSD1306));
 }
 
 /* Write the screenbuffer with changed to the screen */
 SSD1306_OLED_UPRDATE_SCREEN_T ssd1306_UpdateScreen(void) {
-    // Write data to each page of RAM. Number of pages
-    // depends on the screen height:
+#if defined(SSD1306_USE_DOUBLE_BUFFER)
+    if (SSD1306->FrontBuffer != NULL) {
+        // Synchronous flush: present and wait for the transfer
+        ssd1306_Present();
+        ssd1306_WaitIdle();
+        return INITIALIZED_OLED_UPDATE_SCREEN_SUCCESSFULLY;
+    }
+#endif
+    // Number of pages depends on the screen height:
     //
     //  * 32px   ==  4 pages
     //  * 64px   ==  8 pages
     //  * 128px  ==  16 pages
-    for(uint8_t i = 0; i < SSD1306_HEIGHT/8; i++) {
-        ssd1306_WriteCommand(0xB0 + i); // Set the current RAM page address.
-        ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
-        ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
-        ssd1306_WriteData(&SSD1306_Buffer[SSD1306_WIDTH*i],SSD1306_WIDTH);
-    }
+    ssd1306_UpdateWindow(0, 0, SSD1306->Width - 1, SSD1306->Height - 1);
     return INITIALIZED_OLED_UPDATE_SCREEN_SUCCESSFULLY;
 }
 
+/*
+ * Time base for the frame statistics. Weak default has 1 ms resolution;
+ * the application can override it with a microsecond timer.
+ */
+__weak uint32_t ssd1306_GetTimeUs(void) {
+    return HAL_GetTick() * 1000U;
+}
+
+/* Mark the start of rendering a frame (for the render time statistic) */
+void ssd1306_BeginFrame(void) {
+    SSD1306->RenderStart = ssd1306_GetTimeUs();
+}
+
+/* Tag the next frame of the selected panel; a tag not yet sent is kept */
+void ssd1306_TagFrame(uint32_t tag) {
+    if (SSD1306->Tag == 0) {
+        SSD1306->Tag = tag;
+    }
+}
+
+/* A tagged frame reached the panel. Weak default: nobody is interested. */
+__weak void ssd1306_FrameShown(SSD1306_t *panel, uint32_t tag, uint32_t shown_us) {
+    (void)panel;
+    (void)tag;
+    (void)shown_us;
+}
+
+static void ssd1306_TagDone(SSD1306_t *panel, uint32_t *tag) {
+    if (*tag != 0) {
+        ssd1306_FrameShown(panel, *tag, ssd1306_GetTimeUs());
+        *tag = 0;
+    }
+}
+
+static void ssd1306_StatsUpdate(uint32_t *last, uint32_t *max, uint32_t value) {
+    *last = value;
+    if (value > *max) {
+        *max = value;
+    }
+}
+
+/* Blocking update of whole pages of a single-buffered panel */
+static SSD1306_Error_t ssd1306_PresentBlocking(uint32_t t_present, uint8_t page1, uint8_t page2) {
+    ssd1306_UpdateWindow(0, page1 * 8, SSD1306->Width - 1, page2 * 8 + 7);
+
+    uint32_t elapsed = ssd1306_GetTimeUs() - t_present;
+    ssd1306_StatsUpdate(&SSD1306->Stats.transfer_us, &SSD1306->Stats.transfer_max_us, elapsed);
+    ssd1306_StatsUpdate(&SSD1306->Stats.wait_us, &SSD1306->Stats.wait_max_us, elapsed);
+    SSD1306->Stats.frames++;
+
+    SSD1306->RenderStart = ssd1306_GetTimeUs();
+    return SSD1306_OK;
+}
+
+#if defined(SSD1306_USE_DOUBLE_BUFFER)
+/*
+ * Frame transfers. A frame is two transfers on the bus manager of the
+ * panel's I2C bus: the command phase (window or init table) and the page
+ * data, the latter in chunks of SSD1306_DMA_CHUNK bytes so that more urgent
+ * transfers of other devices get on the bus in between. Frames of several
+ * panels are queued by the bus and sent back to back, all without the main
+ * loop waiting.
+ */
+static void ssd1306_XferDone(i2c_xfer_t *xfer);
+
+/* Queue one phase of the panel's frame. Runs from the main loop or from the
+ * completion of the previous phase (I2C ISR). */
+static uint8_t ssd1306_Submit(SSD1306_t *panel, uint8_t state, uint8_t control,
+                              const uint8_t *data, uint16_t size) {
+    i2c_xfer_t *xfer = &panel->Xfer;
+
+    xfer->dev      = &panel->Dev;
+    xfer->dir      = I2C_XFER_WRITE;
+    xfer->prio     = I2C_PRIO_BULK;
+    xfer->flags    = 0;
+    xfer->reg_size = 1;
+    xfer->reg      = control;
+    xfer->data     = (uint8_t*)data;
+    xfer->size     = size;
+    xfer->chunk    = (state == SSD1306_XFER_DATA) ? SSD1306_DMA_CHUNK : 0;
+    xfer->done     = ssd1306_XferDone;
+    xfer->context  = panel;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    panel->XferState = state;
+    if (i2c_bus_submit(xfer) != HAL_OK) {
+        panel->XferState = SSD1306_XFER_IDLE;
+        panel->Stats.errors++;
+    }
+    uint8_t queued = (panel->XferState != SSD1306_XFER_IDLE);
+    __set_PRIMASK(primask);
+
+    return queued;
+}
+
+/* Commands done -> send the pages; pages done -> frame done */
+static void ssd1306_XferDone(i2c_xfer_t *xfer) {
+    SSD1306_t *panel = xfer->context;
+
+    if (xfer->status != HAL_OK) {
+        panel->Stats.errors++;
+        panel->FrontTag = 0;
+        panel->XferState = SSD1306_XFER_IDLE;
+        return;
+    }
+
+    if (panel->XferState == SSD1306_XFER_WINDOW) {
+        const uint8_t page1 = panel->Window[4];
+        const uint8_t page2 = panel->Window[5];
+        ssd1306_Submit(panel, SSD1306_XFER_DATA, 0x40, &panel->FrontBuffer[page1 * panel->Width],
+                       (page2 - page1 + 1) * panel->Width);
+        return;
+    }
+
+    ssd1306_StatsUpdate(&panel->Stats.transfer_us, &panel->Stats.transfer_max_us,
+                        ssd1306_GetTimeUs() - panel->XferStart);
+    ssd1306_TagDone(panel, &panel->FrontTag);
+    panel->XferState = SSD1306_XFER_IDLE;
+}
+
+/* Wait for a panel's transfer, at most SSD1306_XFER_TIMEOUT_MS; a bus that
+ * does not get there in time is aborted */
+static void ssd1306_WaitPanel(const SSD1306_t *panel) {
+    uint32_t start = HAL_GetTick();
+
+    while (panel->XferState != SSD1306_XFER_IDLE) {
+        if (HAL_GetTick() - start >= SSD1306_XFER_TIMEOUT_MS) {
+            ssd1306_AbortBus(panel->Bus);
+            i2c_bus_on_error(panel->Dev.bus, HAL_I2C_ERROR_TIMEOUT);
+            return;
+        }
+    }
+}
+
+uint8_t ssd1306_IsBusy(void) {
+    return SSD1306->XferState != SSD1306_XFER_IDLE;
+}
+
+void ssd1306_WaitIdle(void) {
+    ssd1306_WaitPanel(SSD1306);
+}
+
+/*
+ * Hand the back buffer over to the panel and continue drawing on the other
+ * one. Waits only if this panel's previous frame is still queued or being
+ * sent, so rendering frame N+1 overlaps the DMA transfer of frame N, and
+ * frames of other panels never hold up this one. The new back buffer
+ * starts as a copy of the presented frame, so incremental drawing keeps
+ * working as with a single buffer.
+ * Only pages page1..page2 are sent; the rest of the panel is left as it is.
+ */
+SSD1306_Error_t ssd1306_PresentPages(uint8_t page1, uint8_t page2) {
+    SSD1306_t *panel = SSD1306;
+    uint32_t t_present = ssd1306_GetTimeUs();
+
+    if (!panel->Initialized || page1 > page2 || page2 >= panel->Height / 8) {
+        return SSD1306_ERR;
+    }
+    ssd1306_StatsUpdate(&panel->Stats.render_us, &panel->Stats.render_max_us,
+                        t_present - panel->RenderStart);
+    if (panel->FrontBuffer == NULL) {
+        return ssd1306_PresentBlocking(t_present, page1, page2);
+    }
+
+    ssd1306_WaitIdle();
+    uint32_t t_ready = ssd1306_GetTimeUs();
+    ssd1306_StatsUpdate(&panel->Stats.wait_us, &panel->Stats.wait_max_us, t_ready - t_present);
+
+    // Swap: this panel has no transfer, so the ISR does not touch either buffer
+    uint8_t *front = panel->Buffer;
+    panel->Buffer = panel->FrontBuffer;
+    panel->FrontBuffer = front;
+    memcpy(panel->Buffer, panel->FrontBuffer, ssd1306_BufferSize(panel));
+    panel->FrontTag = panel->Tag;
+    panel->Tag = 0;
+
+    panel->Window[4] = page1;
+    panel->Window[5] = page2;
+    panel->Stats.frames++;
+    panel->XferStart = ssd1306_GetTimeUs();
+    uint8_t queued = ssd1306_Submit(panel, SSD1306_XFER_WINDOW, 0x00, panel->Window, sizeof(panel->Window));
+
+    panel->RenderStart = ssd1306_GetTimeUs();
+    return queued ? SSD1306_OK : SSD1306_ERR;
+}
+
+/*
+ * Initialize a double-buffered panel without waiting for the bus: the
+ * init table and a blank frame are queued as one transfer (command phase,
+ * then data phase) and sent by DMA. The panel is selected and can be drawn
+ * at once; ssd1306_IsBusy() reports when the init has reached it. Call
+ * after ssd1306_IsPoweredUp(), otherwise this waits for the power-up time
+ * like ssd1306_InitPanel. Single-buffered panels are initialized blocking.
+ */
+SSD1306_OLED_INIT_T ssd1306_InitPanelAsync(SSD1306_t *panel) {
+    if (panel->FrontBuffer == NULL) {
+        return ssd1306_InitPanel(panel);
+    }
+    if (ssd1306_InitPrepare(panel) != INITIALIZED_OLED_INIT_SUCCESSFULLY) {
+        return UNINITIALIZED_OLED_INIT;
+    }
+
+    ssd1306_Fill(Black);
+    memcpy(panel->FrontBuffer, panel->Buffer, ssd1306_BufferSize(panel));
+
+    panel->Stats.frames++;
+    panel->XferStart = ssd1306_GetTimeUs();
+    uint8_t queued = ssd1306_Submit(panel, SSD1306_XFER_WINDOW, 0x00, panel->InitCmds,
+                                    ssd1306_InitTable(panel, panel->InitCmds));
+
+    panel->RenderStart = ssd1306_GetTimeUs();
+    return queued ? INITIALIZED_OLED_INIT_SUCCESSFULLY : UNINITIALIZED_OLED_INIT;
+}
+
+#else
+uint8_t ssd1306_IsBusy(void) {
+    return 0;
+}
+
+void ssd1306_WaitIdle(void) {
+}
+
+SSD1306_OLED_INIT_T ssd1306_InitPanelAsync(SSD1306_t *panel) {
+    return ssd1306_InitPanel(panel);
+}
+
+/* Single buffer: present is a blocking update of the pages */
+SSD1306_Error_t ssd1306_PresentPages(uint8_t page1, uint8_t page2) {
+    uint32_t t_present = ssd1306_GetTimeUs();
+
+    if (!SSD1306->Initialized || page1 > page2 || page2 >= SSD1306->Height / 8) {
+        return SSD1306_ERR;
+    }
+    ssd1306_StatsUpdate(&SSD1306->Stats.render_us, &SSD1306->Stats.render_max_us,
+                        t_present - SSD1306->RenderStart);
+    return ssd1306_PresentBlocking(t_present, page1, page2);
+}
+#endif
+
+/* Present the whole screen */
+SSD1306_Error_t ssd1306_Present(void) {
+    return ssd1306_PresentPages(0, SSD1306->Height / 8 - 1);
+}
+
+/*
+ * Shift columns x1 + 1..x2 of pages page1..page2 one column to the left,
+ * on the panel with the content scroll command (0x2D) and in the
+ * screenbuffer, so both keep showing the same picture. Column x2 is
+ * cleared in the screenbuffer; the caller draws it and sends it with
+ * ssd1306_UpdateWindow. The controller needs two frame periods
+ * (SSD1306_SCROLL_SETTLE_MS) before the next scroll command.
+ */
+SSD1306_Error_t ssd1306_ScrollColumnLeft(uint8_t x1, uint8_t x2, uint8_t page1, uint8_t page2) {
+    if (x1 >= x2 || x2 >= SSD1306->Width || page1 > page2 || page2 >= SSD1306->Height / 8) {
+        return SSD1306_ERR;
+    }
+
+    const uint8_t scroll[] = {
+        0x2D,                      // Left horizontal content scroll by one column
+        0x00,                      // Dummy
+        page1,                     // Start page
+        0x01,                      // Dummy
+        page2,                     // End page
+        SSD1306->XOffset + x1,     // Start column
+        SSD1306->XOffset + x2,     // End column
+    };
+    ssd1306_WriteCommands(scroll, sizeof(scroll));
+
+    for (uint8_t page = page1; page <= page2; page++) {
+        uint8_t *row = &SSD1306->Buffer[page * SSD1306->Width];
+        memmove(&row[x1], &row[x1 + 1], x2 - x1);
+        row[x2] = 0x00;
+    }
+
+    return SSD1306_OK;
+}
+
+void ssd1306_GetFrameStats(SSD1306_FrameStats_t *stats) {
+    *stats = SSD1306->Stats;
+}
+
+/*
+ * Write a rectangular part of the screenbuffer to the screen.
+ * Uses horizontal addressing mode (set in ssd1306_Init): the column (0x21)
+ * and page (0x22) windows are set in one command transaction, after which
+ * the RAM pointer wraps inside the window on its own, so the whole window
+ * goes out in a single data transaction. Y is rounded out to whole pages.
+ */
+SSD1306_Error_t ssd1306_UpdateWindow(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+    const uint8_t screen_width = SSD1306->Width;
+
+    if (x1 > x2 || y1 > y2 || x1 >= screen_width || y1 >= SSD1306->Height) {
+        return SSD1306_ERR;
+    }
+    if (x2 >= screen_width) {
+        x2 = screen_width - 1;
+    }
+    if (y2 >= SSD1306->Height) {
+        y2 = SSD1306->Height - 1;
+    }
+
+    const uint8_t x_offset = SSD1306->XOffset;
+    const uint8_t page1 = y1 / 8;
+    const uint8_t page2 = y2 / 8;
+    const uint8_t width = x2 - x1 + 1;
+
+    const uint8_t window[] = {
+        0x21, x_offset + x1, x_offset + x2,  // Set column address
+        0x22, page1, page2,                  // Set page address
+    };
+    ssd1306_WriteCommands(window, sizeof(window));
+
+    if (width == screen_width) {
+        // Full-width pages are contiguous in the screenbuffer
+        ssd1306_WriteData(&SSD1306->Buffer[screen_width * page1], (size_t)screen_width * (page2 - page1 + 1));
+        ssd1306_TagDone(SSD1306, &SSD1306->Tag);
+        return SSD1306_OK;
+    }
+
+    // The RAM pointer keeps its place between data transactions, so a
+    // window larger than the gather buffer simply goes out in pieces
+    size_t len = 0;
+    for (uint8_t page = page1; page <= page2; page++) {
+        if (len + width > sizeof(SSD1306_WindowBuffer)) {
+            ssd1306_WriteData(SSD1306_WindowBuffer, len);
+            len = 0;
+        }
+        memcpy(&SSD1306_WindowBuffer[len], &SSD1306->Buffer[screen_width * page + x1], width);
+        len += width;
+    }
+    ssd1306_WriteData(SSD1306_WindowBuffer, len);
+    ssd1306_TagDone(SSD1306, &SSD1306->Tag);
+
+    return SSD1306_OK;
+}
+
+
+/*
+ * Span helpers. The screenbuffer is organised in pages: byte x + page * W
+ * holds pixels (x, 8 * page .. 8 * page + 7), LSB on top. Blocks are
+ * written as whole page bytes with a mask only on the first and last page,
+ * instead of one ssd1306_DrawPixel per pixel.
+ */
+static inline void ssd1306_ApplyMask(uint8_t *byte, uint8_t mask, SSD1306_COLOR color) {
+    if (color == White) {
+        *byte |= mask;
+    } else {
+        *byte &= ~mask;
+    }
+}
+
+/* Fill x1..x2 by y1..y2, already ordered and clipped to the screen */
+static void ssd1306_FillBlock(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+    const uint8_t page1 = y1 / 8;
+    const uint8_t page2 = y2 / 8;
+    const uint8_t cols = x2 - x1 + 1;
+
+    for (uint8_t page = page1; page <= page2; page++) {
+        uint8_t *row = &SSD1306->Buffer[page * SSD1306->Width + x1];
+        uint8_t mask = 0xFF;
+
+        if (page == page1) {
+            mask &= 0xFF << (y1 % 8);
+        }
+        if (page == page2) {
+            mask &= 0xFF >> (7 - (y2 % 8));
+        }
+
+        if (mask == 0xFF) {
+            memset(row, (color == White) ? 0xFF : 0x00, cols);
+        } else {
+            for (uint8_t i = 0; i < cols; i++) {
+                ssd1306_ApplyMask(&row[i], mask, color);
+            }
+        }
+    }
+}
+
+/* Vertical span with signed, unclipped coordinates */
+static void ssd1306_FillSpan(int32_t x, int32_t y1, int32_t y2, SSD1306_COLOR color) {
+    if (x < 0 || x >= SSD1306->Width || y2 < 0 || y1 >= SSD1306->Height) {
+        return;
+    }
+    if (y1 < 0) {
+        y1 = 0;
+    }
+    if (y2 >= SSD1306->Height) {
+        y2 = SSD1306->Height - 1;
+    }
+    ssd1306_FillBlock(x, y1, x, y2, color);
+}
+
+/* Horizontal line x1..x2 on row y */
+void ssd1306_DrawHLine(uint8_t x1, uint8_t x2, uint8_t y, SSD1306_COLOR color) {
+    if (x1 > x2) {
+        uint8_t t = x1; x1 = x2; x2 = t;
+    }
+    if (x1 >= SSD1306->Width || y >= SSD1306->Height) {
+        return;
+    }
+    ssd1306_FillBlock(x1, y, (x2 < SSD1306->Width) ? x2 : SSD1306->Width - 1, y, color);
+}
+
+/* Vertical line y1..y2 in column x */
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color) {
+    if (y1 > y2) {
+        uint8_t t = y1; y1 = y2; y2 = t;
+    }
+    ssd1306_FillSpan(x, y1, y2, color);
+}
+
 /*
  * Draw one pixel in the screenbuffer
  * X => X Coordinate
@@ -203,16 +767,16 @@ SSD1306_OLED_UPRDATE_SCREEN_T ssd1306_UpdateScreen(void) {
  * color => Pixel color
  */
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
-    if(x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+    if(x >= SSD1306->Width || y >= SSD1306->Height) {
         // Don't write outside the buffer
         return;
     }
    
     // Draw in the right color
     if(color == White) {
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+        SSD1306->Buffer[x + (y / 8) * SSD1306->Width] |= 1 << (y % 8);
     } else { 
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+        SSD1306->Buffer[x + (y / 8) * SSD1306->Width] &= ~(1 << (y % 8));
     }
 }
 
@@ -230,8 +794,8 @@ char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
         return 0;
     
     // Check remaining space on current line
-    if (SSD1306_WIDTH < (SSD1306.CurrentX + Font.width) ||
-        SSD1306_HEIGHT < (SSD1306.CurrentY + Font.height))
+    if (SSD1306->Width < (SSD1306->CurrentX + Font.width) ||
+        SSD1306->Height < (SSD1306->CurrentY + Font.height))
     {
         // Not enough space on current line
         return 0;
@@ -242,15 +806,15 @@ char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
         b = Font.data[(ch - 32) * Font.height + i];
         for(j = 0; j < Font.width; j++) {
             if((b << j) & 0x8000)  {
-                ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR) color);
+                ssd1306_DrawPixel(SSD1306->CurrentX + j, (SSD1306->CurrentY + i), (SSD1306_COLOR) color);
             } else {
-                ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR)!color);
+                ssd1306_DrawPixel(SSD1306->CurrentX + j, (SSD1306->CurrentY + i), (SSD1306_COLOR)!color);
             }
         }
     }
     
     // The current space is now taken
-    SSD1306.CurrentX += Font.char_width ? Font.char_width[ch - 32] : Font.width;
+    SSD1306->CurrentX += Font.char_width ? Font.char_width[ch - 32] : Font.width;
     
     // Return written char for validation
     return ch;
@@ -272,8 +836,8 @@ char ssd1306_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color) {
 
 /* Position the cursor */
 SSD1306_OLED_CURSOR_T ssd1306_SetCursor(uint8_t x, uint8_t y) {
-    SSD1306.CurrentX = x;
-    SSD1306.CurrentY = y;
+    SSD1306->CurrentX = x;
+    SSD1306->CurrentY = y;
     return INITIALIZED_OLED_CURSOR_SUCCESSFULLY;
 }
 
@@ -318,9 +882,38 @@ void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD13
     return;
 }
 
-/* Convert Degrees to Radians */
-static float ssd1306_DegToRad(float par_deg) {
-    return par_deg * (3.14f / 180.0f);
+/* sin(0..90 deg) in Q14, one entry per degree */
+static const int16_t SSD1306_SinQ14[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384,
+};
+
+/* sin(deg) in Q14 for any non-negative angle, by quadrant symmetry */
+static int32_t ssd1306_SinQ14(uint32_t deg) {
+    deg %= 360;
+    if (deg <= 90) {
+        return SSD1306_SinQ14[deg];
+    } else if (deg <= 180) {
+        return SSD1306_SinQ14[180 - deg];
+    } else if (deg <= 270) {
+        return -SSD1306_SinQ14[deg - 180];
+    }
+    return -SSD1306_SinQ14[360 - deg];
+}
+
+/* Point on the circle at the given angle, truncated like the float version */
+static void ssd1306_ArcPoint(uint8_t x, uint8_t y, uint8_t radius, uint32_t deg,
+                             uint8_t *px, uint8_t *py) {
+    *px = x + (int8_t)((ssd1306_SinQ14(deg) * radius) / 16384);
+    *py = y + (int8_t)((ssd1306_SinQ14(deg + 90) * radius) / 16384);
 }
 
 /* Normalize degree to [0;360] */
@@ -339,35 +932,29 @@ static uint16_t ssd1306_NormalizeTo0_360(uint16_t par_deg) {
  * DrawArc. Draw angle is beginning from 4 quart of trigonometric circle (3pi/2)
  * start_angle in degree
  * sweep in degree
+ * Segment end points come from a Q14 sine table, no floating point.
  */
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
     static const uint8_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
-    float approx_degree;
     uint32_t approx_segments;
     uint8_t xp1,xp2;
     uint8_t yp1,yp2;
     uint32_t count;
     uint32_t loc_sweep;
-    float rad;
-    
+
     loc_sweep = ssd1306_NormalizeTo0_360(sweep);
-    
+
     count = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
     approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_degree = loc_sweep / (float)approx_segments;
+    if (approx_segments == 0) {
+        return;
+    }
+
     while(count < approx_segments)
     {
-        rad = ssd1306_DegToRad(count*approx_degree);
-        xp1 = x + (int8_t)(sinf(rad)*radius);
-        yp1 = y + (int8_t)(cosf(rad)*radius);    
+        ssd1306_ArcPoint(x, y, radius, (count * loc_sweep) / approx_segments, &xp1, &yp1);
         count++;
-        if(count != approx_segments) {
-            rad = ssd1306_DegToRad(count*approx_degree);
-        } else {
-            rad = ssd1306_DegToRad(loc_sweep);
-        }
-        xp2 = x + (int8_t)(sinf(rad)*radius);
-        yp2 = y + (int8_t)(cosf(rad)*radius);    
+        ssd1306_ArcPoint(x, y, radius, (count * loc_sweep) / approx_segments, &xp2, &yp2);
         ssd1306_Line(xp1,yp1,xp2,yp2,color);
     }
     
@@ -382,7 +969,6 @@ void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle,
  */
 void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
     const uint32_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
-    float approx_degree;
     uint32_t approx_segments;
     uint8_t xp1;
     uint8_t xp2 = 0;
@@ -390,29 +976,22 @@ void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_
     uint8_t yp2 = 0;
     uint32_t count;
     uint32_t loc_sweep;
-    float rad;
-    
+    uint8_t first_point_x;
+    uint8_t first_point_y;
+
     loc_sweep = ssd1306_NormalizeTo0_360(sweep);
-    
+
     count = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
     approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_degree = loc_sweep / (float)approx_segments;
+    if (approx_segments == 0) {
+        return;
+    }
 
-    rad = ssd1306_DegToRad(count*approx_degree);
-    uint8_t first_point_x = x + (int8_t)(sinf(rad)*radius);
-    uint8_t first_point_y = y + (int8_t)(cosf(rad)*radius);   
+    ssd1306_ArcPoint(x, y, radius, (count * loc_sweep) / approx_segments, &first_point_x, &first_point_y);
     while (count < approx_segments) {
-        rad = ssd1306_DegToRad(count*approx_degree);
-        xp1 = x + (int8_t)(sinf(rad)*radius);
-        yp1 = y + (int8_t)(cosf(rad)*radius);    
+        ssd1306_ArcPoint(x, y, radius, (count * loc_sweep) / approx_segments, &xp1, &yp1);
         count++;
-        if (count != approx_segments) {
-            rad = ssd1306_DegToRad(count*approx_degree);
-        } else {
-            rad = ssd1306_DegToRad(loc_sweep);
-        }
-        xp2 = x + (int8_t)(sinf(rad)*radius);
-        yp2 = y + (int8_t)(cosf(rad)*radius);    
+        ssd1306_ArcPoint(x, y, radius, (count * loc_sweep) / approx_segments, &xp2, &yp2);
         ssd1306_Line(xp1,yp1,xp2,yp2,color);
     }
     
@@ -429,7 +1008,7 @@ void ssd1306_DrawCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
     int32_t err = 2 - 2 * par_r;
     int32_t e2;
 
-    if (par_x >= SSD1306_WIDTH || par_y >= SSD1306_HEIGHT) {
+    if (par_x >= SSD1306->Width || par_y >= SSD1306->Height) {
         return;
     }
 
@@ -457,23 +1036,22 @@ void ssd1306_DrawCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
     return;
 }
 
-/* Draw filled circle. Pixel positions calculated using Bresenham's algorithm */
+/*
+ * Draw filled circle. Same Bresenham stepping as ssd1306_DrawCircle, but
+ * each column pair is filled as one vertical span once its height is final.
+ */
 void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
     int32_t x = -par_r;
     int32_t y = 0;
     int32_t err = 2 - 2 * par_r;
     int32_t e2;
 
-    if (par_x >= SSD1306_WIDTH || par_y >= SSD1306_HEIGHT) {
+    if (par_x >= SSD1306->Width || par_y >= SSD1306->Height) {
         return;
     }
 
     do {
-        for (uint8_t _y = (par_y + y); _y >= (par_y - y); _y--) {
-            for (uint8_t _x = (par_x - x); _x >= (par_x + x); _x--) {
-                ssd1306_DrawPixel(_x, _y, par_color);
-            }
-        }
+        int32_t span = y;   // Half height of the columns par_x -+ x
 
         e2 = err;
         if (e2 <= y) {
@@ -485,6 +1063,11 @@ void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
         }
 
         if (e2 > x) {
+            // Column pair is complete, later steps are narrower
+            ssd1306_FillSpan(par_x + x, par_y - span, par_y + span, par_color);
+            if (x != 0) {
+                ssd1306_FillSpan(par_x - x, par_y - span, par_y + span, par_color);
+            }
             x++;
             err = err + (x * 2 + 1);
         }
@@ -503,23 +1086,29 @@ void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD13
     return;
 }
 
-/* Draw a filled rectangle */
+/* Draw a filled rectangle, page by page */
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
     uint8_t x_start = ((x1<=x2) ? x1 : x2);
     uint8_t x_end   = ((x1<=x2) ? x2 : x1);
     uint8_t y_start = ((y1<=y2) ? y1 : y2);
     uint8_t y_end   = ((y1<=y2) ? y2 : y1);
 
-    for (uint8_t y= y_start; (y<= y_end)&&(y<SSD1306_HEIGHT); y++) {
-        for (uint8_t x= x_start; (x<= x_end)&&(x<SSD1306_WIDTH); x++) {
-            ssd1306_DrawPixel(x, y, color);
-        }
+    if (x_start >= SSD1306->Width || y_start >= SSD1306->Height) {
+        return;
+    }
+    if (x_end >= SSD1306->Width) {
+        x_end = SSD1306->Width - 1;
+    }
+    if (y_end >= SSD1306->Height) {
+        y_end = SSD1306->Height - 1;
     }
+
+    ssd1306_FillBlock(x_start, y_start, x_end, y_end, color);
     return;
 }
 
 SSD1306_Error_t ssd1306_InvertRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
-  if ((x2 >= SSD1306_WIDTH) || (y2 >= SSD1306_HEIGHT)) {
+  if ((x2 >= SSD1306->Width) || (y2 >= SSD1306->Height)) {
     return SSD1306_ERR;
   }
   if ((x1 > x2) || (y1 > y2)) {
@@ -529,50 +1118,103 @@ SSD1306_Error_t ssd1306_InvertRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint
   if ((y1 / 8) != (y2 / 8)) {
     /* if rectangle doesn't lie on one 8px row */
     for (uint32_t x = x1; x <= x2; x++) {
-      i = x + (y1 / 8) * SSD1306_WIDTH;
-      SSD1306_Buffer[i] ^= 0xFF << (y1 % 8);
-      i += SSD1306_WIDTH;
-      for (; i < x + (y2 / 8) * SSD1306_WIDTH; i += SSD1306_WIDTH) {
-        SSD1306_Buffer[i] ^= 0xFF;
+      i = x + (y1 / 8) * SSD1306->Width;
+      SSD1306->Buffer[i] ^= 0xFF << (y1 % 8);
+      i += SSD1306->Width;
+      for (; i < x + (y2 / 8) * SSD1306->Width; i += SSD1306->Width) {
+        SSD1306->Buffer[i] ^= 0xFF;
       }
-      SSD1306_Buffer[i] ^= 0xFF >> (7 - (y2 % 8));
+      SSD1306->Buffer[i] ^= 0xFF >> (7 - (y2 % 8));
     }
   } else {
     /* if rectangle lies on one 8px row */
     const uint8_t mask = (0xFF << (y1 % 8)) & (0xFF >> (7 - (y2 % 8)));
-    for (i = x1 + (y1 / 8) * SSD1306_WIDTH;
-         i <= (uint32_t)x2 + (y2 / 8) * SSD1306_WIDTH; i++) {
-      SSD1306_Buffer[i] ^= mask;
+    for (i = x1 + (y1 / 8) * SSD1306->Width;
+         i <= (uint32_t)x2 + (y2 / 8) * SSD1306->Width; i++) {
+      SSD1306->Buffer[i] ^= mask;
     }
   }
   return SSD1306_OK;
 }
 
-/* Draw a bitmap */
+/*
+ * Draw a bitmap (rows of MSB-first bytes, transparent where a bit is 0).
+ * Destination byte and row mask are worked out once per row.
+ */
 void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color) {
     int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-    uint8_t byte = 0;
 
-    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+    if (x >= SSD1306->Width || y >= SSD1306->Height) {
         return;
     }
 
-    for (uint8_t j = 0; j < h; j++, y++) {
-        for (uint8_t i = 0; i < w; i++) {
-            if (i & 7) {
-                byte <<= 1;
-            } else {
-                byte = (*(const unsigned char *)(&bitmap[j * byteWidth + i / 8]));
-            }
+    const uint8_t cols = (w < SSD1306->Width - x) ? w : SSD1306->Width - x;
+    const uint8_t rows = (h < SSD1306->Height - y) ? h : SSD1306->Height - y;
+
+    for (uint8_t j = 0; j < rows; j++) {
+        const unsigned char *src = &bitmap[j * byteWidth];
+        uint8_t *dst = &SSD1306->Buffer[((y + j) / 8) * SSD1306->Width + x];
+        const uint8_t mask = 1 << ((y + j) % 8);
 
-            if (byte & 0x80) {
-                ssd1306_DrawPixel(x + i, y, color);
+        for (uint8_t i = 0; i < cols; i++) {
+            if (src[i / 8] & (0x80 >> (i & 7))) {
+                ssd1306_ApplyMask(&dst[i], mask, color);
             }
         }
     }
     return;
 }
 
+/*
+ * Copy a bitmap in screenbuffer format ((h + 7) / 8 pages of w bytes, LSB
+ * on top) into the screenbuffer. The copy is opaque: the w x h rectangle
+ * is replaced. A page-aligned destination is a plain memcpy per page,
+ * otherwise every source byte is split over two destination pages.
+ */
+void ssd1306_BlitPages(uint8_t x, uint8_t y, const uint8_t* pages, uint8_t w, uint8_t h) {
+    if (x >= SSD1306->Width || y >= SSD1306->Height || w == 0 || h == 0) {
+        return;
+    }
+
+    const uint8_t screen_width = SSD1306->Width;
+    const uint8_t screen_pages = SSD1306->Height / 8;
+    const uint8_t cols = (w < screen_width - x) ? w : screen_width - x;
+    const uint8_t shift = y % 8;
+    const uint8_t src_pages = (h + 7) / 8;
+
+    for (uint8_t p = 0; p < src_pages; p++) {
+        const uint8_t *src = &pages[p * w];
+        const uint8_t dst_page = y / 8 + p;
+        // Rows of this source page that belong to the bitmap
+        const uint8_t valid = (p == src_pages - 1 && (h % 8) != 0) ? (0xFF >> (8 - h % 8)) : 0xFF;
+
+        if (dst_page >= screen_pages) {
+            break;
+        }
+
+        uint8_t *dst = &SSD1306->Buffer[dst_page * screen_width + x];
+        if (shift == 0 && valid == 0xFF) {
+            memcpy(dst, src, cols);
+            continue;
+        }
+
+        const uint8_t mask_lo = (uint8_t)(valid << shift);
+        for (uint8_t i = 0; i < cols; i++) {
+            dst[i] = (dst[i] & ~mask_lo) | ((uint8_t)(src[i] << shift) & mask_lo);
+        }
+
+        if (shift == 0 || dst_page + 1 >= screen_pages) {
+            continue;
+        }
+
+        const uint8_t mask_hi = valid >> (8 - shift);
+        dst += screen_width;
+        for (uint8_t i = 0; i < cols; i++) {
+            dst[i] = (dst[i] & ~mask_hi) | ((src[i] >> (8 - shift)) & mask_hi);
+        }
+    }
+}
+
 void ssd1306_SetContrast(const uint8_t value) {
     const uint8_t kSetContrastControlRegister = 0x81;
     ssd1306_WriteCommand(kSetContrastControlRegister);
@@ -583,15 +1225,15 @@ void ssd1306_SetDisplayOn(const uint8_t on) {
     uint8_t value;
     if (on) {
         value = 0xAF;   // Display on
-        SSD1306.DisplayOn = 1;
+        SSD1306->DisplayOn = 1;
     } else {
         value = 0xAE;   // Display off
-        SSD1306.DisplayOn = 0;
+        SSD1306->DisplayOn = 0;
     }
     ssd1306_WriteCommand(value);
 }
 
 uint8_t ssd1306_GetDisplayOn() {
-    return SSD1306.DisplayOn;
+    return SSD1306->DisplayOn;
 }
 
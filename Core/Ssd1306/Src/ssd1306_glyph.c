@@ -0,0 +1,149 @@
+#include "ssd1306_glyph.h"
+#include <string.h>
+
+#define SSD1306_GLYPH_NONE  0xFF
+
+/* Render one font character into a page-format cell */
+static void ssd1306_GlyphRender(const ssd1306_GlyphCache_t *cache, char ch, uint8_t *glyph) {
+    const SSD1306_Font_t *font = cache->font;
+
+    memset(glyph, 0x00, cache->glyph_size);
+    for (uint8_t i = 0; i < font->height; i++) {
+        uint16_t b = font->data[(ch - 32) * font->height + i];
+        for (uint8_t j = 0; j < font->width; j++) {
+            if ((b << j) & 0x8000) {
+                glyph[(i / 8) * cache->width + j] |= 1 << (i % 8);
+            }
+        }
+    }
+}
+
+/*
+ * Pre-render the given characters of a font. Done once at start-up; the
+ * pool is sized for the digits and a few labels of one small font.
+ */
+SSD1306_Error_t ssd1306_GlyphCacheInit(ssd1306_GlyphCache_t *cache, const SSD1306_Font_t *font,
+                                       const char *chars) {
+    cache->font = font;
+    cache->width = font->width;
+    cache->height = font->height;
+    cache->glyph_size = font->width * ((font->height + 7) / 8);
+    memset(cache->index, SSD1306_GLYPH_NONE, sizeof(cache->index));
+
+    uint8_t count = 0;
+    for (; *chars; chars++) {
+        char ch = *chars;
+        if (ch < 32 || ch > 126 || cache->index[ch - 32] != SSD1306_GLYPH_NONE) {
+            continue;
+        }
+        if ((size_t)(count + 1) * cache->glyph_size > sizeof(cache->pool)) {
+            return SSD1306_ERR;
+        }
+
+        ssd1306_GlyphRender(cache, ch, &cache->pool[count * cache->glyph_size]);
+        cache->index[ch - 32] = count++;
+    }
+
+    return SSD1306_OK;
+}
+
+/* Page-format glyph of a character, NULL if it is not cached */
+const uint8_t *ssd1306_GlyphGet(const ssd1306_GlyphCache_t *cache, char ch) {
+    if (ch < 32 || ch > 126 || cache->index[ch - 32] == SSD1306_GLYPH_NONE) {
+        return NULL;
+    }
+    return &cache->pool[cache->index[ch - 32] * cache->glyph_size];
+}
+
+/* Blit one cell; characters missing from the cache fall back to the font */
+static void ssd1306_GlyphDraw(const ssd1306_GlyphCache_t *cache, uint8_t x, uint8_t y, char ch) {
+    const uint8_t *glyph = ssd1306_GlyphGet(cache, ch);
+
+    if (glyph != NULL) {
+        ssd1306_BlitPages(x, y, glyph, cache->width, cache->height);
+    } else {
+        ssd1306_SetCursor(x, y);
+        ssd1306_WriteChar(ch, *cache->font, White);
+    }
+}
+
+/* Draw a string from the cache, returns the column after the last cell */
+uint8_t ssd1306_GlyphDrawString(const ssd1306_GlyphCache_t *cache, uint8_t x, uint8_t y, const char *str) {
+    for (; *str; str++) {
+        ssd1306_GlyphDraw(cache, x, y, *str);
+        x += cache->width;
+    }
+    return x;
+}
+
+void ssd1306_NumFieldInit(ssd1306_NumField_t *field, const ssd1306_GlyphCache_t *cache,
+                          uint8_t x, uint8_t y, uint8_t length) {
+    field->cache = cache;
+    field->x = x;
+    field->y = y;
+    field->length = (length < SSD1306_NUMFIELD_MAX) ? length : SSD1306_NUMFIELD_MAX;
+    memset(field->shown, 0, sizeof(field->shown));
+    field->dirty_x1 = -1;
+    field->dirty_x2 = -1;
+}
+
+/*
+ * Show new text (padded with spaces to the field length). Only characters
+ * that differ from the screenbuffer are blitted, and their columns are
+ * added to the dirty range. Returns the number of characters redrawn.
+ */
+uint8_t ssd1306_NumFieldSet(ssd1306_NumField_t *field, const char *text) {
+    const uint8_t w = field->cache->width;
+    uint8_t changed = 0;
+    uint8_t end = 0;
+
+    for (uint8_t i = 0; i < field->length; i++) {
+        char ch = ' ';
+        if (!end && text[i] != '\0') {
+            ch = text[i];
+        } else {
+            end = 1;
+        }
+
+        if (field->shown[i] == ch) {
+            continue;
+        }
+
+        uint8_t x = field->x + i * w;
+        ssd1306_GlyphDraw(field->cache, x, field->y, ch);
+        field->shown[i] = ch;
+        changed++;
+
+        if (field->dirty_x1 < 0 || x < field->dirty_x1) {
+            field->dirty_x1 = x;
+        }
+        if (x + w - 1 > field->dirty_x2) {
+            field->dirty_x2 = x + w - 1;
+        }
+    }
+
+    return changed;
+}
+
+/* Fetch and clear the dirty column range, returns 0 if nothing changed */
+uint8_t ssd1306_NumFieldTakeDirty(ssd1306_NumField_t *field, uint8_t *x1, uint8_t *x2) {
+    if (field->dirty_x1 < 0) {
+        return 0;
+    }
+
+    *x1 = field->dirty_x1;
+    *x2 = field->dirty_x2;
+    field->dirty_x1 = -1;
+    field->dirty_x2 = -1;
+    return 1;
+}
+
+/* Send only the dirty columns of the field to the panel */
+SSD1306_Error_t ssd1306_NumFieldFlush(ssd1306_NumField_t *field) {
+    uint8_t x1, x2;
+
+    if (!ssd1306_NumFieldTakeDirty(field, &x1, &x2)) {
+        return SSD1306_OK;
+    }
+    return ssd1306_UpdateWindow(x1, field->y, x2, field->y + field->cache->height - 1);
+}
@@ -0,0 +1,54 @@
+#include "ssd1306_graph.h"
+
+void ssd1306_GraphInit(ssd1306_Graph_t *graph, uint8_t x, uint8_t width,
+                       uint8_t page1, uint8_t page2, int32_t full_scale) {
+    graph->x = x;
+    graph->width = width;
+    graph->page1 = page1;
+    graph->page2 = page2;
+    graph->full_scale = (full_scale > 0) ? full_scale : 1;
+    graph->last_y = -1;
+}
+
+/* Clear the plot in the screenbuffer; it reaches the panel with the next full present */
+void ssd1306_GraphClear(ssd1306_Graph_t *graph) {
+    ssd1306_FillRectangle(graph->x, graph->page1 * 8,
+                          graph->x + graph->width - 1, graph->page2 * 8 + 7, Black);
+    graph->last_y = -1;
+}
+
+/*
+ * Append one sample on the right and move the history one column left.
+ * A negative value leaves a gap. The trace is drawn as a vertical span
+ * from the previous sample's row, so steep changes stay connected.
+ * I2C traffic per sample: the scroll command, one column window and
+ * (page2 - page1 + 1) data bytes, instead of a full frame.
+ * Call at most every SSD1306_SCROLL_SETTLE_MS.
+ */
+SSD1306_Error_t ssd1306_GraphPush(ssd1306_Graph_t *graph, int32_t value) {
+    const uint8_t x_new = graph->x + graph->width - 1;
+    const uint8_t top = graph->page1 * 8;
+    const uint8_t bottom = graph->page2 * 8 + 7;
+
+    if (ssd1306_ScrollColumnLeft(graph->x, x_new, graph->page1, graph->page2) != SSD1306_OK) {
+        return SSD1306_ERR;
+    }
+
+    if (value >= 0) {
+        if (value > graph->full_scale) {
+            value = graph->full_scale;
+        }
+        int16_t y = bottom - (int16_t)((value * (bottom - top)) / graph->full_scale);
+
+        if (graph->last_y >= 0) {
+            ssd1306_DrawVLine(x_new, graph->last_y, y, White);
+        } else {
+            ssd1306_DrawPixel(x_new, y, White);
+        }
+        graph->last_y = y;
+    } else {
+        graph->last_y = -1;
+    }
+
+    return ssd1306_UpdateWindow(x_new, top, x_new, bottom);
+}
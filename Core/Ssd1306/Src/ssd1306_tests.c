@@ -1,5 +1,6 @@
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 #include "ssd1306.h"
 #include "ssd1306_tests.h"
 #include "ssd1306_fonts.h"
@@ -111,6 +112,168 @@ const unsigned char github_logo_64x64[] = {
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 
+/*
+ * Per-pixel reference versions of the span/blit primitives in ssd1306.c.
+ * They are the original implementations and only serve to check and time
+ * the fast paths (ssd1306_TestBenchmark).
+ */
+static void ref_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+    const SSD1306_t *panel = ssd1306_GetPanel();
+    uint8_t x_start = ((x1<=x2) ? x1 : x2);
+    uint8_t x_end   = ((x1<=x2) ? x2 : x1);
+    uint8_t y_start = ((y1<=y2) ? y1 : y2);
+    uint8_t y_end   = ((y1<=y2) ? y2 : y1);
+
+    for (uint8_t y= y_start; (y<= y_end)&&(y<panel->Height); y++) {
+        for (uint8_t x= x_start; (x<= x_end)&&(x<panel->Width); x++) {
+            ssd1306_DrawPixel(x, y, color);
+        }
+    }
+}
+
+static void ref_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
+    int32_t x = -par_r;
+    int32_t y = 0;
+    int32_t err = 2 - 2 * par_r;
+    int32_t e2;
+
+    do {
+        for (uint8_t _y = (par_y + y); _y >= (par_y - y); _y--) {
+            for (uint8_t _x = (par_x - x); _x >= (par_x + x); _x--) {
+                ssd1306_DrawPixel(_x, _y, par_color);
+            }
+        }
+
+        e2 = err;
+        if (e2 <= y) {
+            y++;
+            err = err + (y * 2 + 1);
+            if (-x == y && e2 <= x) {
+                e2 = 0;
+            }
+        }
+
+        if (e2 > x) {
+            x++;
+            err = err + (x * 2 + 1);
+        }
+    } while (x <= 0);
+}
+
+static void ref_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
+    const uint32_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
+    uint32_t loc_sweep = (sweep <= 360) ? sweep : ((sweep % 360) ? (sweep % 360) : 360);
+    uint32_t start = (start_angle <= 360) ? start_angle : ((start_angle % 360) ? (start_angle % 360) : 360);
+    uint32_t count = (start * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
+    uint32_t approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
+    float approx_degree = loc_sweep / (float)approx_segments;
+    float rad;
+
+    while (count < approx_segments) {
+        rad = (count * approx_degree) * (3.14f / 180.0f);
+        uint8_t xp1 = x + (int8_t)(sinf(rad) * radius);
+        uint8_t yp1 = y + (int8_t)(cosf(rad) * radius);
+        count++;
+        rad = ((count != approx_segments) ? count * approx_degree : (float)loc_sweep) * (3.14f / 180.0f);
+        uint8_t xp2 = x + (int8_t)(sinf(rad) * radius);
+        uint8_t yp2 = y + (int8_t)(cosf(rad) * radius);
+        ssd1306_Line(xp1, yp1, xp2, yp2, color);
+    }
+}
+
+static void ref_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color) {
+    int16_t byteWidth = (w + 7) / 8;
+    uint8_t byte = 0;
+
+    for (uint8_t j = 0; j < h; j++, y++) {
+        for (uint8_t i = 0; i < w; i++) {
+            if (i & 7) {
+                byte <<= 1;
+            } else {
+                byte = bitmap[j * byteWidth + i / 8];
+            }
+            if (byte & 0x80) {
+                ssd1306_DrawPixel(x + i, y, color);
+            }
+        }
+    }
+}
+
+static void ref_BlitPages(uint8_t x, uint8_t y, const uint8_t* pages, uint8_t w, uint8_t h) {
+    for (uint8_t j = 0; j < h; j++) {
+        for (uint8_t i = 0; i < w; i++) {
+            uint8_t bit = (pages[(j / 8) * w + i] >> (j % 8)) & 1;
+            ssd1306_DrawPixel(x + i, y + j, bit ? White : Black);
+        }
+    }
+}
+
+/*
+ * Old vs. new timing of the optimized primitives. Every case is drawn
+ * SSD1306_BENCH_RUNS times into a cleared buffer with each version; the
+ * screenbuffers are compared to confirm both draw the same pixels.
+ */
+#define SSD1306_BENCH_RUNS  20
+
+static void bench_rect_ref(void)     { ref_FillRectangle(3, 5, 120, 58, White); }
+static void bench_rect_fast(void)    { ssd1306_FillRectangle(3, 5, 120, 58, White); }
+static void bench_circle_ref(void)   { ref_FillCircle(64, 32, 28, White); }
+static void bench_circle_fast(void)  { ssd1306_FillCircle(64, 32, 28, White); }
+static void bench_arc_ref(void)      { ref_DrawArc(64, 32, 30, 20, 270, White); }
+static void bench_arc_fast(void)     { ssd1306_DrawArc(64, 32, 30, 20, 270, White); }
+static void bench_bitmap_ref(void)   { ref_DrawBitmap(32, 3, github_logo_64x64, 64, 58, White); }
+static void bench_bitmap_fast(void)  { ssd1306_DrawBitmap(32, 3, github_logo_64x64, 64, 58, White); }
+static void bench_blit_ref(void)     { ref_BlitPages(0, 16, garfield_128x64, 128, 32); }
+static void bench_blit_fast(void)    { ssd1306_BlitPages(0, 16, garfield_128x64, 128, 32); }
+static void bench_blit3_ref(void)    { ref_BlitPages(0, 19, garfield_128x64, 128, 30); }
+static void bench_blit3_fast(void)   { ssd1306_BlitPages(0, 19, garfield_128x64, 128, 30); }
+
+static const struct {
+    const char *name;
+    void (*ref)(void);
+    void (*fast)(void);
+} bench_cases[] = {
+    { "FillRect",  bench_rect_ref,   bench_rect_fast   },
+    { "FillCirc",  bench_circle_ref, bench_circle_fast },
+    { "Arc",       bench_arc_ref,    bench_arc_fast    },
+    { "Bitmap",    bench_bitmap_ref, bench_bitmap_fast },
+    { "Blit y%8=0", bench_blit_ref,  bench_blit_fast   },
+    { "Blit y%8=3", bench_blit3_ref, bench_blit3_fast  },
+};
+
+static uint8_t bench_snapshot[SSD1306_BUFFER_SIZE];
+
+static uint32_t bench_run(void (*draw)(void)) {
+    uint32_t total = 0;
+
+    for (int run = 0; run < SSD1306_BENCH_RUNS; run++) {
+        ssd1306_Fill(Black);
+        uint32_t start = ssd1306_GetTimeUs();
+        draw();
+        total += ssd1306_GetTimeUs() - start;
+    }
+    return total;
+}
+
+int ssd1306_TestBenchmark(ssd1306_BenchResult_t *results, int max_results) {
+    const SSD1306_t *panel = ssd1306_GetPanel();
+    const size_t size = (size_t)panel->Width * panel->Height / 8;
+    int count = 0;
+
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]) && count < max_results; i++) {
+        ssd1306_BenchResult_t *r = &results[count++];
+
+        r->name = bench_cases[i].name;
+        r->ref_us = bench_run(bench_cases[i].ref);
+        memcpy(bench_snapshot, panel->Buffer, size);
+        r->fast_us = bench_run(bench_cases[i].fast);
+        r->match = (memcmp(bench_snapshot, panel->Buffer, size) == 0);
+    }
+
+    ssd1306_Fill(Black);
+    return count;
+}
+
 void ssd1306_TestBorder() {
     ssd1306_Fill(Black);
    
@@ -215,12 +378,19 @@ void ssd1306_TestFonts3() {
     ssd1306_UpdateScreen();
 }
 
-void ssd1306_TestFPS() {
+/*
+ * Full-frame refresh rate, measured: frames are counted over
+ * SSD1306_FPS_WINDOW_US on the microsecond clock (ssd1306_GetTimeUs) and
+ * divided by the time they actually took, from the first frame start to
+ * the end of the last transfer.
+ */
+#define SSD1306_FPS_WINDOW_US  5000000U
+
+void ssd1306_TestFPS(ssd1306_FpsResult_t *result) {
     ssd1306_Fill(White);
    
-    uint32_t start = HAL_GetTick();
-    uint32_t end = start;
-    int fps = 0;
+    uint32_t frames = 0;
+    uint32_t elapsed = 0;
     char message[] = "ABCDEFGHIJK";
    
     ssd1306_SetCursor(2,0);
@@ -228,24 +398,30 @@ void ssd1306_TestFPS() {
     ssd1306_SetCursor(2, 18*2);
     ssd1306_WriteString("0123456789A", Font_11x18, Black);
    
+    uint32_t start = ssd1306_GetTimeUs();
     do {
         ssd1306_SetCursor(2, 18);
         ssd1306_WriteString(message, Font_11x18, Black);
         ssd1306_UpdateScreen();
+        ssd1306_WaitIdle();     // Counted once it is on the panel
        
         char ch = message[0];
         memmove(message, message+1, sizeof(message)-2);
         message[sizeof(message)-2] = ch;
 
-        fps++;
-        end = HAL_GetTick();
-    } while((end - start) < 5000);
+        frames++;
+        elapsed = ssd1306_GetTimeUs() - start;
+    } while(elapsed < SSD1306_FPS_WINDOW_US);
+
+    result->frames = frames;
+    result->elapsed_us = elapsed;
+    result->fps_x100 = (uint32_t)(((uint64_t)frames * 100000000U) / elapsed);
    
     HAL_Delay(5000);
 
     char buff[64];
-    fps = (float)fps / ((end - start) / 1000.0);
-    snprintf(buff, sizeof(buff), "~%d FPS", fps);
+    snprintf(buff, sizeof(buff), "%lu.%02lu FPS",
+             (unsigned long)(result->fps_x100 / 100), (unsigned long)(result->fps_x100 % 100));
    
     ssd1306_Fill(White);
     ssd1306_SetCursor(2, 2);
@@ -360,7 +536,8 @@ void ssd1306_TestDrawBitmap()
 void ssd1306_TestAll() {
     ssd1306_Init();
 
-    ssd1306_TestFPS();
+    ssd1306_FpsResult_t fps;
+    ssd1306_TestFPS(&fps);
     HAL_Delay(3000);
     ssd1306_TestBorder();
     ssd1306_TestFonts1();
@@ -0,0 +1,68 @@
+#ifndef _STATS_H
+#define _STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include "arm_math.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define STATS_BLOCK        32U           /**< Samples reduced at once by CMSIS-DSP */
+#define STATS_BINS         64U           /**< Histogram bins for the percentiles */
+#define STATS_PANES        4U            /**< Window = this many publish intervals */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+/* Count, mean, sum of squared deviations and range of a set of samples */
+typedef struct {
+    uint32_t  count;
+    float32_t mean;
+    float32_t m2;
+    float32_t min;
+    float32_t max;
+} stats_moments_t;
+
+/* One measured quantity. The window slides by one pane per publish; each
+ * pane keeps its moments and its histogram, so the oldest drops out
+ * whole. */
+typedef struct {
+    float32_t       lo;                  /**< Lower edge of bin 0 */
+    float32_t       bin_width;           /**< Samples outside the bins count in the end ones */
+    float32_t       block[STATS_BLOCK];
+    uint32_t        block_len;
+    uint32_t        pane;                /**< Pane being filled */
+    stats_moments_t panes[STATS_PANES];
+    uint16_t        hist[STATS_PANES][STATS_BINS];
+} stats_stream_t;
+
+typedef struct {
+    uint32_t  count;                     /**< Samples in the window, 0 = the rest is invalid */
+    float32_t min;
+    float32_t max;
+    float32_t mean;
+    float32_t std;
+    float32_t p50;
+    float32_t p90;
+    float32_t p99;
+} stats_summary_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void stats_init(stats_stream_t *stream, float32_t lo, float32_t hi);
+void stats_add(stats_stream_t *stream, float32_t sample);
+void stats_publish(stats_stream_t *stream, stats_summary_t *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _STATS_H */
@@ -0,0 +1,146 @@
+/**
+ * @file    stats.c
+ * @brief   Parking-Sensor project.
+ * @details Rolling statistics for monitoring. A sample costs a store and a
+ *          histogram increment; every STATS_BLOCK samples the block is
+ *          reduced by the CMSIS-DSP statistics functions and merged into
+ *          the pane (Chan et al.), so mean, variance and range stay O(1)
+ *          per sample without keeping the samples. Percentiles come from
+ *          the fixed-bin histogram, interpolated inside a bin.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "stats.h"
+#include <string.h>
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void stats_init(stats_stream_t *stream, float32_t lo, float32_t hi)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->lo        = lo;
+    stream->bin_width = (hi - lo) / (float32_t)STATS_BINS;
+}
+
+/* a += b */
+static void stats_merge(stats_moments_t *a, const stats_moments_t *b)
+{
+    if (b->count == 0U) {
+        return;
+    }
+    if (a->count == 0U) {
+        *a = *b;
+        return;
+    }
+
+    float32_t n     = (float32_t)(a->count + b->count);
+    float32_t delta = b->mean - a->mean;
+
+    a->m2   += b->m2 + delta * delta * ((float32_t)a->count * (float32_t)b->count / n);
+    a->mean += delta * ((float32_t)b->count / n);
+    a->count += b->count;
+    a->min   = (b->min < a->min) ? b->min : a->min;
+    a->max   = (b->max > a->max) ? b->max : a->max;
+}
+
+static void stats_flush(stats_stream_t *stream)
+{
+    stats_moments_t block;
+    float32_t var;
+    uint32_t index;
+
+    if (stream->block_len == 0U) {
+        return;
+    }
+    block.count = stream->block_len;
+    arm_mean_f32(stream->block, stream->block_len, &block.mean);
+    arm_var_f32(stream->block, stream->block_len, &var);          /* n - 1 in the divisor */
+    arm_min_f32(stream->block, stream->block_len, &block.min, &index);
+    arm_max_f32(stream->block, stream->block_len, &block.max, &index);
+    block.m2 = var * (float32_t)(stream->block_len - 1U);
+
+    stats_merge(&stream->panes[stream->pane], &block);
+    stream->block_len = 0;
+}
+
+void stats_add(stats_stream_t *stream, float32_t sample)
+{
+    int32_t bin = (int32_t)((sample - stream->lo) / stream->bin_width);
+    uint16_t *count;
+
+    bin   = (bin < 0) ? 0 : (bin >= (int32_t)STATS_BINS) ? (int32_t)STATS_BINS - 1 : bin;
+    count = &stream->hist[stream->pane][bin];
+    if (*count != UINT16_MAX) {
+        (*count)++;
+    }
+
+    stream->block[stream->block_len++] = sample;
+    if (stream->block_len == STATS_BLOCK) {
+        stats_flush(stream);
+    }
+}
+
+/* Sample below which a share of pct percent of the window lies */
+static float32_t stats_percentile(const uint32_t *hist, uint32_t total, uint32_t pct,
+                                  const stats_stream_t *stream)
+{
+    float32_t rank = (float32_t)total * (float32_t)pct / 100.0f;
+    uint32_t  below = 0;
+    uint32_t  bin   = 0;
+
+    while ((bin < STATS_BINS - 1U) && ((float32_t)(below + hist[bin]) < rank)) {
+        below += hist[bin];
+        bin++;
+    }
+
+    float32_t inside = (hist[bin] != 0U) ? (rank - (float32_t)below) / (float32_t)hist[bin] : 0.0f;
+    return stream->lo + ((float32_t)bin + inside) * stream->bin_width;
+}
+
+static float32_t stats_clamp(float32_t value, float32_t min, float32_t max)
+{
+    return (value < min) ? min : (value > max) ? max : value;
+}
+
+/**
+ * @brief  Summary of the last STATS_PANES intervals, then slide the window
+ *         by one interval.
+ */
+void stats_publish(stats_stream_t *stream, stats_summary_t *summary)
+{
+    stats_moments_t window = { 0 };
+    uint32_t hist[STATS_BINS] = { 0 };
+    uint32_t total = 0;
+
+    stats_flush(stream);
+    for (uint32_t pane = 0; pane < STATS_PANES; pane++) {
+        stats_merge(&window, &stream->panes[pane]);
+        for (uint32_t bin = 0; bin < STATS_BINS; bin++) {
+            hist[bin] += stream->hist[pane][bin];
+            total     += stream->hist[pane][bin];
+        }
+    }
+
+    memset(summary, 0, sizeof(*summary));
+    if ((window.count != 0U) && (total != 0U)) {
+        summary->count = window.count;
+        summary->min   = window.min;
+        summary->max   = window.max;
+        summary->mean  = window.mean;
+        arm_sqrt_f32((window.count > 1U) ? window.m2 / (float32_t)(window.count - 1U) : 0.0f, &summary->std);
+        /* The end bins also hold everything outside the histogram range */
+        summary->p50 = stats_clamp(stats_percentile(hist, total, 50U, stream), window.min, window.max);
+        summary->p90 = stats_clamp(stats_percentile(hist, total, 90U, stream), window.min, window.max);
+        summary->p99 = stats_clamp(stats_percentile(hist, total, 99U, stream), window.min, window.max);
+    }
+
+    stream->pane = (stream->pane + 1U) % STATS_PANES;
+    memset(&stream->panes[stream->pane], 0, sizeof(stream->panes[0]));
+    memset(stream->hist[stream->pane], 0, sizeof(stream->hist[0]));
+}
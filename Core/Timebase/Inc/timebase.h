@@ -0,0 +1,68 @@
+#ifndef _TIMEBASE_H
+#define _TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32l4xx_hal.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define TIMEBASE_TIM          TIM2       /**< 32-bit, 1 us tick (MX_TIM2_Init) */
+#define TIMEBASE_IRQn         TIM2_IRQn
+#define TIMEBASE_SWITCH_GUARD 16U        /**< Clock switch this close to a wrap waits for it [ticks] */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef uint64_t timebase_us_t;          /**< Microseconds since timebase_init() */
+
+/****************************************************************
+ * Variables
+****************************************************************/
+extern volatile uint32_t timebase_offset;  /**< Only for timebase_now32() */
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void timebase_init(void);
+void timebase_irq_handler(void);
+void timebase_switch_clock(uint32_t prescaler, void (*switch_clock)(void));
+
+timebase_us_t timebase_now_us(void);
+uint32_t timebase_now_ms(void);
+void timebase_delay_us(uint32_t us);
+
+/*******************************************************************************
+ * Static inline functions
+ ******************************************************************************/
+/* Low 32 bits of the time: for timestamps that are only ever subtracted
+ * from each other (wrap-safe up to 71 minutes apart), e.g. in an ISR */
+static inline uint32_t timebase_now32(void)
+{
+    return timebase_offset + TIMEBASE_TIM->CNT;
+}
+
+/* Deadlines are 64-bit and never wrap, so a plain compare is safe */
+static inline timebase_us_t timebase_deadline_us(uint32_t us)
+{
+    return timebase_now_us() + us;
+}
+
+static inline bool timebase_expired(timebase_us_t deadline)
+{
+    return timebase_now_us() >= deadline;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TIMEBASE_H */
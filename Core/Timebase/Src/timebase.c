@@ -0,0 +1,170 @@
+/**
+ * @file    timebase.c
+ * @brief   Parking-Sensor project.
+ * @details Monotonic microsecond time for the whole application. TIM2
+ *          counts 1 us ticks over its full 32 bits and the update
+ *          interrupt adds the upper 32 bits. A reader checks the update
+ *          flag as well, so the 64-bit value is right from any context,
+ *          including ISRs that preempt a pending wrap. A clock profile
+ *          switch goes through timebase_switch_clock(), which takes the
+ *          new prescaler at an update event of its own, so the 1 us tick
+ *          goes on without a lost tick or a jump in the count.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "timebase.h"
+#include "irq_conf.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static volatile uint32_t timebase_wraps;   /**< Upper 32 bits of the time at CNT = 0 */
+volatile uint32_t        timebase_offset;  /**< Lower 32 bits of the time at CNT = 0 */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+/* Start counting from 0. MX_TIM2_Init must have run. */
+void timebase_init(void)
+{
+    TIMEBASE_TIM->CR1 &= ~TIM_CR1_CEN;
+    TIMEBASE_TIM->CNT = 0U;
+    TIMEBASE_TIM->SR  = (uint32_t)~TIM_SR_UIF;      // UG from the HAL init is not a wrap
+    timebase_wraps = 0U;
+    timebase_offset = 0U;
+
+    TIMEBASE_TIM->DIER |= TIM_DIER_UIE;
+    HAL_NVIC_SetPriority(TIMEBASE_IRQn, IRQ_PRIO_TIMEBASE, 0);
+    HAL_NVIC_EnableIRQ(TIMEBASE_IRQn);
+
+    TIMEBASE_TIM->CR1 |= TIM_CR1_CEN;
+}
+
+/* Counter wrap. Masked, so that a reader preempting this handler never
+ * sees the flag cleared but the wrap not yet counted. */
+void timebase_irq_handler(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (TIMEBASE_TIM->SR & TIM_SR_UIF) {
+        TIMEBASE_TIM->SR = (uint32_t)~TIM_SR_UIF;
+        timebase_wraps++;
+    }
+    __set_PRIMASK(primask);
+}
+
+/* Period ended early: the next one starts ticks later. 2^32 ticks is
+ * an ordinary wrap. */
+static void timebase_advance(uint64_t ticks)
+{
+    uint64_t start = ((uint64_t)timebase_wraps << 32) + timebase_offset + ticks;
+
+    timebase_wraps  = (uint32_t)(start >> 32);
+    timebase_offset = (uint32_t)start;
+}
+
+/**
+ * @brief Change the counter clock without losing the 1 us tick.
+ *        PSC is preloaded and only taken at an update event, which for the
+ *        free-running 32-bit counter is 71 minutes away. So the update is
+ *        brought forward: right after a tick edge ARR is set to the count,
+ *        and the next edge overflows to 0 and loads the new prescaler. The
+ *        clock is switched as soon as that update is seen, and the short
+ *        period (count + 1 ticks) is added to the time. Only the tick that
+ *        spans the switch is off, by the few cycles between the update and
+ *        the switch, in opposite directions for the two switches. Within
+ *        TIMEBASE_SWITCH_GUARD ticks of a wrap the wrap itself is the
+ *        update, so the two can never be mistaken for each other.
+ * @param prescaler    PSC for the new clock.
+ * @param switch_clock Switches the clock; runs masked and must not block.
+ * @note  Interrupts stay masked for up to two ticks of the old clock, or
+ *        up to the guard before a wrap.
+ */
+void timebase_switch_clock(uint32_t prescaler, void (*switch_clock)(void))
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    TIMEBASE_TIM->PSC = prescaler;
+
+    if (!(TIMEBASE_TIM->CR1 & TIM_CR1_CEN)) {
+        switch_clock();                             // Loaded by the start
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    /* A whole tick from the edge to write ARR in */
+    uint32_t count = TIMEBASE_TIM->CNT;
+    while (TIMEBASE_TIM->CNT == count) {
+    }
+    count = TIMEBASE_TIM->CNT;
+
+    if (count < 0xFFFFFFFFU - TIMEBASE_SWITCH_GUARD) {
+        /* No wrap until the update: a raised flag is an earlier one */
+        if (TIMEBASE_TIM->SR & TIM_SR_UIF) {
+            TIMEBASE_TIM->SR = (uint32_t)~TIM_SR_UIF;
+            timebase_wraps++;
+        }
+        TIMEBASE_TIM->ARR = count;
+
+        while (!(TIMEBASE_TIM->SR & TIM_SR_UIF)) {
+            uint32_t now = TIMEBASE_TIM->CNT;
+            if (now > count) {                      // Edge before the write: one tick on
+                count = now;
+                TIMEBASE_TIM->ARR = count;
+            }
+        }
+    } else {
+        while (!(TIMEBASE_TIM->SR & TIM_SR_UIF)) {  // The wrap loads PSC
+        }
+        count = 0xFFFFFFFFU;
+    }
+    switch_clock();
+
+    TIMEBASE_TIM->ARR = 0xFFFFFFFFU;
+    TIMEBASE_TIM->SR  = (uint32_t)~TIM_SR_UIF;      // Counted below; the IRQ finds nothing
+    timebase_advance((uint64_t)count + 1U);
+
+    __set_PRIMASK(primask);
+}
+
+timebase_us_t timebase_now_us(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t wraps  = timebase_wraps;
+    uint32_t offset = timebase_offset;
+    uint32_t count  = TIMEBASE_TIM->CNT;
+
+    /* Wrapped, but the handler has not run yet: the count read above may be
+     * from either side of the wrap, the one read now is after it */
+    if (TIMEBASE_TIM->SR & TIM_SR_UIF) {
+        count = TIMEBASE_TIM->CNT;
+        wraps++;
+    }
+    __set_PRIMASK(primask);
+
+    return (((timebase_us_t)wraps << 32) | offset) + count;
+}
+
+/* Milliseconds for the application schedulers; wraps after 49 days like
+ * HAL_GetTick(), so compare by subtraction */
+uint32_t timebase_now_ms(void)
+{
+    return (uint32_t)(timebase_now_us() / 1000U);
+}
+
+/* Busy wait of at least us - 1 microseconds (the tick in progress counts) */
+void timebase_delay_us(uint32_t us)
+{
+    uint32_t start = timebase_now32();
+
+    while (timebase_now32() - start < us) {
+    }
+}
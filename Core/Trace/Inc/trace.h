@@ -0,0 +1,47 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef enum {
+    TRACE_PING = 0,                      /**< Trigger pulse ended; value = ping offset [us] (APP_PING_JITTER) */
+    TRACE_EDGE,                          /**< Echo pin edge in the EXTI ISR; value = level */
+    TRACE_DONE,                          /**< Ping decided; value = echo_us, flags = reason, bit 7 = timed out */
+} trace_type_t;
+
+#define TRACE_DONE_TIMED_OUT   0x80U
+
+/* One raw event, 8 bytes */
+typedef struct {
+    uint32_t t_us;                       /**< timebase_now32() */
+    uint16_t value;
+    uint8_t  type;                       /**< trace_type_t */
+    uint8_t  flags;
+} trace_rec_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+void trace_put(uint8_t type, uint32_t t_us, uint16_t value, uint8_t flags);
+void trace_freeze(bool frozen);
+void trace_clear(void);
+uint32_t trace_count(void);
+uint32_t trace_lost(void);
+void trace_get(uint32_t index, trace_rec_t *rec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TRACE_H */
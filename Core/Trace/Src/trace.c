@@ -0,0 +1,80 @@
+/**
+ * @file    trace.c
+ * @brief   Parking-Sensor project.
+ * @details Flight recorder for the raw ping data: trigger times, echo edges
+ *          and the validation result, in a RAM ring that keeps the newest
+ *          APP_TRACE_RECORDS. Written from the EXTI ISR and the main loop;
+ *          a record is a few stores with interrupts masked. Frozen while
+ *          it is dumped, so the dump is one consistent stretch.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "trace.h"
+#include "app_conf.h"
+#include "stm32l4xx_hal.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static trace_rec_t       trace_ring[APP_TRACE_RECORDS];
+static uint32_t          trace_head   = 0;      /**< Records written since the last clear */
+static volatile bool     trace_frozen = false;
+static uint32_t          trace_missed = 0;      /**< Not recorded while frozen */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void trace_put(uint8_t type, uint32_t t_us, uint16_t value, uint8_t flags)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (trace_frozen) {
+        trace_missed++;
+    } else {
+        trace_rec_t *rec = &trace_ring[trace_head % APP_TRACE_RECORDS];
+        rec->t_us  = t_us;
+        rec->value = value;
+        rec->type  = type;
+        rec->flags = flags;
+        trace_head++;
+    }
+    __set_PRIMASK(primask);
+}
+
+void trace_freeze(bool frozen)
+{
+    trace_frozen = frozen;
+}
+
+void trace_clear(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    trace_head   = 0;
+    trace_missed = 0;
+    __set_PRIMASK(primask);
+}
+
+/* Records held, oldest first from index 0 */
+uint32_t trace_count(void)
+{
+    return (trace_head < APP_TRACE_RECORDS) ? trace_head : APP_TRACE_RECORDS;
+}
+
+/* Overwritten by newer records, or missed while frozen */
+uint32_t trace_lost(void)
+{
+    return trace_head - trace_count() + trace_missed;
+}
+
+/* Only while frozen */
+void trace_get(uint32_t index, trace_rec_t *rec)
+{
+    *rec = trace_ring[(trace_head - trace_count() + index) % APP_TRACE_RECORDS];
+}
@@ -0,0 +1,123 @@
+#ifndef _UI_H
+#define _UI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/****************************************************************
+ * Includes
+****************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1306.h"
+#include "ssd1306_glyph.h"
+#include "ssd1306_graph.h"
+
+/****************************************************************
+ * Defines
+****************************************************************/
+#define UI_TEXT_MAX         24U   /**< Longest label text, including the terminator */
+#define UI_SYNC_MAX_BYTES   64U   /**< Dirty area up to this size is sent by UpdateWindow,
+                                       larger ones as whole pages by DMA */
+#define UI_GRAPH_AXIS_GAP   2U    /**< Columns between the graph axis and the plot */
+
+/****************************************************************
+ * Typedefs
+****************************************************************/
+typedef enum {
+    UI_WIDGET_LABEL = 0,   /**< One line of text, aligned in its box */
+    UI_WIDGET_VALUE,       /**< Fixed-point number from a glyph cache */
+    UI_WIDGET_BAR,         /**< Horizontal bar gauge */
+    UI_WIDGET_GRAPH,       /**< Scrolling history plot with a left axis */
+    UI_WIDGET_ICON,        /**< Page-format bitmap, shown or hidden */
+} ui_kind_t;
+
+typedef enum {
+    UI_ALIGN_LEFT = 0,
+    UI_ALIGN_CENTER,
+    UI_ALIGN_RIGHT,
+} ui_align_t;
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t w;
+    uint8_t h;
+} ui_rect_t;
+
+typedef struct {
+    ui_kind_t kind;
+    ui_rect_t box;         /**< Pixels owned by the widget */
+    bool      visible;
+    bool      dirty;       /**< Value changed since the last commit */
+    bool      redraw;      /**< Box must be drawn from scratch */
+    union {
+        struct {
+            const SSD1306_Font_t *font;
+            ui_align_t            align;
+            char                  text[UI_TEXT_MAX];
+        } label;
+        struct {
+            ssd1306_NumField_t field;
+            uint8_t            decimals;
+            int32_t            value;   /**< In units of 10^-decimals */
+        } value;
+        struct {
+            int32_t max;
+            uint8_t fill;               /**< Filled columns inside the frame */
+        } bar;
+        struct {
+            ssd1306_Graph_t graph;
+            int32_t         sample;     /**< Pending sample, pushed on commit */
+            bool            pending;
+        } graph;
+        struct {
+            const uint8_t *pages;       /**< Screenbuffer format, box.w x box.h */
+        } icon;
+    } u;
+} ui_widget_t;
+
+typedef struct {
+    uint32_t commits;      /**< Commits that sent anything */
+    uint32_t renders;      /**< Widgets re-rendered */
+    uint32_t sync_bytes;   /**< Bytes sent by windowed updates */
+    uint32_t dma_pages;    /**< Pages sent by DMA presents */
+} ui_stats_t;
+
+/* Visible widgets must not overlap; a hidden one may cover others (e.g. a
+ * message shown in place of a readout) */
+typedef struct {
+    ui_widget_t *widgets;
+    uint8_t      count;
+    ui_stats_t   stats;
+} ui_screen_t;
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+uint16_t ui_text_width(const SSD1306_Font_t *font, const char *text);
+
+void ui_screen_init(ui_screen_t *screen, ui_widget_t *widgets, uint8_t count);
+void ui_screen_invalidate(ui_screen_t *screen);
+void ui_commit(ui_screen_t *screen);
+
+void ui_label_init(ui_widget_t *widget, ui_rect_t box, const SSD1306_Font_t *font,
+                   ui_align_t align, const char *text);
+void ui_value_init(ui_widget_t *widget, uint8_t x, uint8_t y, const ssd1306_GlyphCache_t *cache,
+                   uint8_t length, uint8_t decimals);
+void ui_bar_init(ui_widget_t *widget, ui_rect_t box, int32_t max);
+void ui_graph_init(ui_widget_t *widget, ui_rect_t box, int32_t full_scale);
+void ui_icon_init(ui_widget_t *widget, ui_rect_t box, const uint8_t *pages);
+
+void ui_set_visible(ui_widget_t *widget, bool visible);
+void ui_label_set(ui_widget_t *widget, const char *text);
+void ui_value_set(ui_widget_t *widget, int32_t value);
+void ui_bar_set(ui_widget_t *widget, int32_t value);
+void ui_graph_push(ui_widget_t *widget, int32_t sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _UI_H */
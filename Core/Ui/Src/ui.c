@@ -0,0 +1,420 @@
+/**
+ * @file    ui.c
+ * @brief   Parking-Sensor project.
+ * @details Retained-mode widgets for the SSD1306 dashboard. The application
+ *          only sets widget values; a setter marks its widget dirty when the
+ *          shown value actually changes. ui_commit() then re-renders the
+ *          dirty widgets into the screenbuffer and sends their union to the
+ *          panel in one transfer per frame.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "ui.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Typedefs
+ ******************************************************************************/
+typedef struct {
+    uint8_t x1;
+    uint8_t y1;
+    uint8_t x2;
+    uint8_t y2;
+    bool    any;
+} ui_area_t;
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+static bool ui_overlap(const ui_rect_t *a, const ui_rect_t *b)
+{
+    return (a->x < b->x + b->w) && (b->x < a->x + a->w)
+        && (a->y < b->y + b->h) && (b->y < a->y + a->h);
+}
+
+static void ui_clear(const ui_rect_t *box)
+{
+    ssd1306_FillRectangle(box->x, box->y, box->x + box->w - 1, box->y + box->h - 1, Black);
+}
+
+/* Grow the area that has to go to the panel (inclusive pixel bounds) */
+static void ui_area_add(ui_area_t *area, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    if (!area->any) {
+        *area = (ui_area_t){ x1, y1, x2, y2, true };
+        return;
+    }
+    if (x1 < area->x1) area->x1 = x1;
+    if (y1 < area->y1) area->y1 = y1;
+    if (x2 > area->x2) area->x2 = x2;
+    if (y2 > area->y2) area->y2 = y2;
+}
+
+/* Right-aligned fixed-point text, '-' filled if it does not fit */
+static void ui_format_value(char *out, uint8_t length, int32_t value, uint8_t decimals)
+{
+    char text[16];
+    uint32_t scale = 1U;
+    uint32_t mag = (value < 0) ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+    int n;
+
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10U;
+    }
+
+    if (decimals != 0U) {
+        n = snprintf(text, sizeof(text), "%s%lu.%0*lu", (value < 0) ? "-" : "",
+                     (unsigned long)(mag / scale), (int)decimals, (unsigned long)(mag % scale));
+    } else {
+        n = snprintf(text, sizeof(text), "%s%lu", (value < 0) ? "-" : "", (unsigned long)mag);
+    }
+
+    if (n < 0 || n > length) {
+        memset(out, '-', length);
+    } else {
+        memset(out, ' ', length - n);
+        memcpy(&out[length - n], text, n);
+    }
+    out[length] = '\0';
+}
+
+/*******************************************************************************
+ * Text layout
+ ******************************************************************************/
+/**
+ * @brief  Width of a string as ssd1306_WriteString advances the cursor,
+ *         i.e. from the per-character table of proportional fonts.
+ * @retval Width [px].
+ */
+uint16_t ui_text_width(const SSD1306_Font_t *font, const char *text)
+{
+    uint16_t width = 0U;
+
+    for (; *text != '\0'; text++) {
+        if (*text < 32 || *text > 126) {
+            continue;   // Not drawn by WriteChar
+        }
+        width += (font->char_width != NULL) ? font->char_width[*text - 32] : font->width;
+    }
+
+    return width;
+}
+
+/*******************************************************************************
+ * Rendering
+ ******************************************************************************/
+static void ui_render_label(ui_widget_t *widget)
+{
+    const ui_rect_t *box = &widget->box;
+    const SSD1306_Font_t *font = widget->u.label.font;
+    uint16_t width = ui_text_width(font, widget->u.label.text);
+    uint8_t x = box->x;
+
+    ui_clear(box);
+
+    if (width < box->w) {
+        if (widget->u.label.align == UI_ALIGN_CENTER) {
+            x += (box->w - width) / 2;
+        } else if (widget->u.label.align == UI_ALIGN_RIGHT) {
+            x += box->w - width;
+        }
+    }
+
+    ssd1306_SetCursor(x, box->y + (box->h > font->height ? (box->h - font->height) / 2 : 0));
+    ssd1306_WriteString(widget->u.label.text, *font, White);
+}
+
+static void ui_render_bar(ui_widget_t *widget)
+{
+    const ui_rect_t *box = &widget->box;
+    uint8_t x1 = box->x + 1;
+    uint8_t x2 = box->x + box->w - 2;
+    uint8_t y1 = box->y + 1;
+    uint8_t y2 = box->y + box->h - 2;
+    uint8_t fill = widget->u.bar.fill;
+
+    if (widget->redraw) {
+        ui_clear(box);
+        ssd1306_DrawRectangle(box->x, box->y, box->x + box->w - 1, box->y + box->h - 1, White);
+    }
+    if (fill > 0U) {
+        ssd1306_FillRectangle(x1, y1, x1 + fill - 1, y2, White);
+    }
+    if (x1 + fill <= x2) {
+        ssd1306_FillRectangle(x1 + fill, y1, x2, y2, Black);
+    }
+}
+
+static void ui_render_graph(ui_widget_t *widget)
+{
+    const ui_rect_t *box = &widget->box;
+
+    ui_clear(box);
+    ssd1306_DrawVLine(box->x, box->y, box->y + box->h - 1, White);
+    ssd1306_GraphClear(&widget->u.graph.graph);
+    widget->u.graph.pending = false;   // The first sample starts the empty plot
+}
+
+/*
+ * Draw one dirty, visible widget into the screenbuffer and add the pixels
+ * that changed to the area sent to the panel.
+ */
+static void ui_render(ui_widget_t *widget, ui_area_t *area)
+{
+    const ui_rect_t *box = &widget->box;
+    uint8_t x1 = box->x;
+    uint8_t x2 = box->x + box->w - 1;
+
+    switch (widget->kind) {
+    case UI_WIDGET_LABEL:
+        ui_render_label(widget);
+        break;
+    case UI_WIDGET_VALUE: {
+        ssd1306_NumField_t *field = &widget->u.value.field;
+        char text[SSD1306_NUMFIELD_MAX + 1];
+
+        if (widget->redraw) {
+            ssd1306_NumFieldInit(field, field->cache, field->x, field->y, field->length);
+        }
+        ui_format_value(text, field->length, widget->u.value.value, widget->u.value.decimals);
+        ssd1306_NumFieldSet(field, text);
+        if (!ssd1306_NumFieldTakeDirty(field, &x1, &x2)) {
+            return;   // Same text as before
+        }
+        break;
+    }
+    case UI_WIDGET_BAR:
+        ui_render_bar(widget);
+        break;
+    case UI_WIDGET_GRAPH:
+        ui_render_graph(widget);
+        break;
+    case UI_WIDGET_ICON:
+        ssd1306_BlitPages(box->x, box->y, widget->u.icon.pages, box->w, box->h);
+        break;
+    }
+
+    ui_area_add(area, x1, box->y, x2, box->y + box->h - 1);
+}
+
+/*******************************************************************************
+ * Screen
+ ******************************************************************************/
+void ui_screen_init(ui_screen_t *screen, ui_widget_t *widgets, uint8_t count)
+{
+    screen->widgets = widgets;
+    screen->count = count;
+    memset(&screen->stats, 0, sizeof(screen->stats));
+    ui_screen_invalidate(screen);
+}
+
+/* Draw every widget from scratch on the next commit */
+void ui_screen_invalidate(ui_screen_t *screen)
+{
+    for (uint8_t i = 0; i < screen->count; i++) {
+        screen->widgets[i].dirty = true;
+        screen->widgets[i].redraw = true;
+    }
+}
+
+/**
+ * @brief Render the dirty widgets of a screen on the selected panel and send
+ *        them in one transfer. Small areas (a few digits) go out as one
+ *        window; anything larger is presented as whole pages by DMA, so the
+ *        caller does not wait for it.
+ *        Widgets that were hidden are cleared first and the visible widgets
+ *        they overlapped are redrawn. Graph samples are pushed while the bus
+ *        is still idle: each is a panel-side scroll plus one column and is
+ *        not part of the frame.
+ */
+void ui_commit(ui_screen_t *screen)
+{
+    ui_area_t area = { 0 };
+    bool begun = false;
+
+    for (uint8_t i = 0; i < screen->count; i++) {
+        ui_widget_t *widget = &screen->widgets[i];
+
+        if (!widget->dirty || widget->visible) {
+            continue;
+        }
+        if (!begun) {
+            ssd1306_BeginFrame();
+            begun = true;
+        }
+
+        ui_clear(&widget->box);
+        ui_area_add(&area, widget->box.x, widget->box.y,
+                    widget->box.x + widget->box.w - 1, widget->box.y + widget->box.h - 1);
+        widget->dirty = false;
+        widget->redraw = false;
+
+        for (uint8_t j = 0; j < screen->count; j++) {
+            ui_widget_t *other = &screen->widgets[j];
+
+            if (other->visible && ui_overlap(&widget->box, &other->box)) {
+                other->dirty = true;
+                other->redraw = true;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < screen->count; i++) {
+        ui_widget_t *widget = &screen->widgets[i];
+
+        if (!widget->visible) {
+            continue;
+        }
+        if (widget->kind == UI_WIDGET_GRAPH && !widget->redraw && widget->u.graph.pending) {
+            ssd1306_GraphPush(&widget->u.graph.graph, widget->u.graph.sample);
+            widget->u.graph.pending = false;
+        }
+        if (!widget->dirty) {
+            continue;
+        }
+        if (!begun) {
+            ssd1306_BeginFrame();
+            begun = true;
+        }
+
+        ui_render(widget, &area);
+        widget->dirty = false;
+        widget->redraw = false;
+        screen->stats.renders++;
+    }
+
+    if (!area.any) {
+        return;
+    }
+    screen->stats.commits++;
+
+    uint8_t page1 = area.y1 / 8U;
+    uint8_t page2 = area.y2 / 8U;
+    uint32_t bytes = (uint32_t)(area.x2 - area.x1 + 1U) * (page2 - page1 + 1U);
+
+#if defined(SSD1306_USE_DOUBLE_BUFFER)
+    if (bytes > UI_SYNC_MAX_BYTES) {
+        ssd1306_PresentPages(page1, page2);
+        screen->stats.dma_pages += page2 - page1 + 1U;
+        return;
+    }
+#endif
+    ssd1306_UpdateWindow(area.x1, area.y1, area.x2, area.y2);
+    screen->stats.sync_bytes += bytes;
+}
+
+/*******************************************************************************
+ * Widgets
+ ******************************************************************************/
+static void ui_widget_init(ui_widget_t *widget, ui_kind_t kind, ui_rect_t box)
+{
+    memset(widget, 0, sizeof(*widget));
+    widget->kind = kind;
+    widget->box = box;
+    widget->visible = true;
+    widget->dirty = true;
+    widget->redraw = true;
+}
+
+void ui_label_init(ui_widget_t *widget, ui_rect_t box, const SSD1306_Font_t *font,
+                   ui_align_t align, const char *text)
+{
+    ui_widget_init(widget, UI_WIDGET_LABEL, box);
+    widget->u.label.font = font;
+    widget->u.label.align = align;
+    strncpy(widget->u.label.text, text, UI_TEXT_MAX - 1U);
+}
+
+/* Numeric field of `length` glyph cells at (x, y), e.g. "ddd.dd" */
+void ui_value_init(ui_widget_t *widget, uint8_t x, uint8_t y, const ssd1306_GlyphCache_t *cache,
+                   uint8_t length, uint8_t decimals)
+{
+    if (length > SSD1306_NUMFIELD_MAX) {
+        length = SSD1306_NUMFIELD_MAX;
+    }
+
+    ui_widget_init(widget, UI_WIDGET_VALUE, (ui_rect_t){ x, y, length * cache->width, cache->height });
+    ssd1306_NumFieldInit(&widget->u.value.field, cache, x, y, length);
+    widget->u.value.decimals = decimals;
+}
+
+void ui_bar_init(ui_widget_t *widget, ui_rect_t box, int32_t max)
+{
+    ui_widget_init(widget, UI_WIDGET_BAR, box);
+    widget->u.bar.max = (max > 0) ? max : 1;
+}
+
+/* The box must be page aligned; the axis takes its first columns */
+void ui_graph_init(ui_widget_t *widget, ui_rect_t box, int32_t full_scale)
+{
+    ui_widget_init(widget, UI_WIDGET_GRAPH, box);
+    ssd1306_GraphInit(&widget->u.graph.graph, box.x + UI_GRAPH_AXIS_GAP, box.w - UI_GRAPH_AXIS_GAP,
+                      box.y / 8U, (box.y + box.h - 1U) / 8U, full_scale);
+}
+
+void ui_icon_init(ui_widget_t *widget, ui_rect_t box, const uint8_t *pages)
+{
+    ui_widget_init(widget, UI_WIDGET_ICON, box);
+    widget->u.icon.pages = pages;
+}
+
+/*******************************************************************************
+ * Setters: mark the widget dirty only if what it shows changes
+ ******************************************************************************/
+void ui_set_visible(ui_widget_t *widget, bool visible)
+{
+    if (widget->visible == visible) {
+        return;
+    }
+    widget->visible = visible;
+    widget->dirty = true;
+    widget->redraw = true;
+}
+
+void ui_label_set(ui_widget_t *widget, const char *text)
+{
+    if (strncmp(widget->u.label.text, text, UI_TEXT_MAX - 1U) == 0) {
+        return;
+    }
+    strncpy(widget->u.label.text, text, UI_TEXT_MAX - 1U);
+    widget->u.label.text[UI_TEXT_MAX - 1U] = '\0';
+    widget->dirty = true;
+}
+
+void ui_value_set(ui_widget_t *widget, int32_t value)
+{
+    if (widget->u.value.value == value && !widget->redraw) {
+        return;
+    }
+    widget->u.value.value = value;
+    widget->dirty = true;
+}
+
+/* Bar length follows value / max; redrawn only when a column changes */
+void ui_bar_set(ui_widget_t *widget, int32_t value)
+{
+    int32_t inner = widget->box.w - 2;
+
+    if (value < 0) value = 0;
+    if (value > widget->u.bar.max) value = widget->u.bar.max;
+
+    uint8_t fill = (uint8_t)((value * inner) / widget->u.bar.max);
+    if (fill == widget->u.bar.fill) {
+        return;
+    }
+    widget->u.bar.fill = fill;
+    widget->dirty = true;
+}
+
+/* Queue one sample (negative = gap); the newest one is pushed on commit */
+void ui_graph_push(ui_widget_t *widget, int32_t sample)
+{
+    widget->u.graph.sample = sample;
+    widget->u.graph.pending = true;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file    bench_gfx.c
+ * @brief   Parking-Sensor project.
+ * @details Host run of the SSD1306 render benchmark. ssd1306_TestBenchmark()
+ *          from ssd1306_tests.c draws every optimized primitive with the
+ *          per-pixel reference and with the span/blit version and compares
+ *          the screenbuffers; here it runs on the host clock, repeated
+ *          until the totals are well above the clock resolution. The
+ *          glyph cache is timed the same way against ssd1306_WriteString
+ *          on the dashboard's font and digits. The numbers are host times:
+ *          the ratios carry over to the target, the absolute values do not.
+ *
+ *          bench_gfx [-n repeats]
+ *            exit code 1 if a fast path draws other pixels than its
+ *            reference (the arc excepted, see below)
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+#include "ssd1306_fonts.h"
+#include "ssd1306_glyph.h"
+#include "ssd1306_tests.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define BENCH_REPEATS_DEFAULT  500U
+#define BENCH_CASES_MAX        8
+#define BENCH_RUNS             20U       /**< SSD1306_BENCH_RUNS of ssd1306_tests.c */
+#define BENCH_TEXT             "123.45"  /**< A distance readout, DASH_GLYPHS of main.c */
+#define BENCH_GLYPHS           "0123456789. -"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+I2C_HandleTypeDef hi2c2;
+
+static ssd1306_GlyphCache_t glyphs;
+static uint8_t              snapshot[SSD1306_BUFFER_SIZE];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+/* Overrides the millisecond default of ssd1306.c */
+uint32_t ssd1306_GetTimeUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U);
+}
+
+static uint32_t bench_pixels_differ(const uint8_t *a, const uint8_t *b)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < SSD1306_BUFFER_SIZE; i++) {
+        count += (uint32_t)__builtin_popcount(a[i] ^ b[i]);
+    }
+    return count;
+}
+
+/* Same shape as bench_run() of ssd1306_tests.c: every draw into a cleared
+ * buffer, only the draw itself timed */
+static uint64_t bench_text(uint32_t repeats, bool cached)
+{
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < repeats * BENCH_RUNS; i++) {
+        ssd1306_Fill(Black);
+        uint32_t start = ssd1306_GetTimeUs();
+        if (cached) {
+            ssd1306_GlyphDrawString(&glyphs, 10, 20, BENCH_TEXT);
+        } else {
+            ssd1306_SetCursor(10, 20);
+            ssd1306_WriteString(BENCH_TEXT, Font_7x10, White);
+        }
+        total += ssd1306_GetTimeUs() - start;
+    }
+    return total;
+}
+
+static void bench_print(const char *name, uint64_t ref_us, uint64_t fast_us, uint32_t draws, bool same)
+{
+    printf("%-12s %10.1f %10.1f %8.1fx  %s",
+           name, 1000.0 * (double)ref_us / draws, 1000.0 * (double)fast_us / draws,
+           (fast_us != 0U) ? (double)ref_us / (double)fast_us : 0.0,
+           same ? "same" : "differ");
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t repeats = BENCH_REPEATS_DEFAULT;
+    ssd1306_BenchResult_t results[BENCH_CASES_MAX];
+    uint64_t ref_us[BENCH_CASES_MAX] = {0};
+    uint64_t fast_us[BENCH_CASES_MAX] = {0};
+    bool match[BENCH_CASES_MAX];
+    int failures = 0;
+    int count = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        repeats = (uint32_t)strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: bench_gfx [-n repeats]\n");
+        return 2;
+    }
+    if (repeats == 0U) {
+        repeats = 1U;
+    }
+
+    memset(match, 1, sizeof(match));
+    for (uint32_t r = 0; r < repeats; r++) {
+        count = ssd1306_TestBenchmark(results, BENCH_CASES_MAX);
+        for (int i = 0; i < count; i++) {
+            ref_us[i] += results[i].ref_us;
+            fast_us[i] += results[i].fast_us;
+            match[i] = match[i] && results[i].match;
+        }
+    }
+
+    printf("%u draws per case, ns per draw on the host\n", repeats * BENCH_RUNS);
+    printf("%-12s %10s %10s %9s\n", "case", "per-pixel", "fast", "speedup");
+    for (int i = 0; i < count; i++) {
+        bench_print(results[i].name, ref_us[i], fast_us[i], repeats * BENCH_RUNS, match[i]);
+        /* The reference arc takes pi as 3.14, the fast one uses the exact
+         * sine table, so a few end points land one pixel apart */
+        if (!match[i] && strcmp(results[i].name, "Arc") != 0) {
+            failures++;
+        }
+    }
+
+    /* Glyph cache against the font walk */
+    if (ssd1306_GlyphCacheInit(&glyphs, &Font_7x10, BENCH_GLYPHS) != SSD1306_OK) {
+        fprintf(stderr, "glyph cache too small\n");
+        return 2;
+    }
+    uint64_t text_ref = bench_text(repeats, false);
+    memcpy(snapshot, ssd1306_GetPanel()->Buffer, sizeof(snapshot));
+    uint64_t text_fast = bench_text(repeats, true);
+    uint32_t differ = bench_pixels_differ(snapshot, ssd1306_GetPanel()->Buffer);
+
+    bench_print("Glyph 7x10", text_ref, text_fast, repeats * BENCH_RUNS, differ == 0U);
+    if (differ != 0U) {
+        printf("  %u pixels differ\n", differ);
+        failures++;
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
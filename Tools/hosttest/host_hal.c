@@ -0,0 +1,76 @@
+/**
+ * @file    host_hal.c
+ * @brief   Parking-Sensor project.
+ * @details Host stand-in for the core and clock calls of the tested
+ *          modules. Time is a model: every HAL_GetTick() poll takes one
+ *          millisecond and every DWT->CYCCNT read a few cycles, so the
+ *          deadlines and busy waits of the firmware run to their end
+ *          without waiting on the host. A poll with interrupts enabled
+ *          first runs host_tick_hook, which is where host_i2c.c completes
+ *          the transfers in flight; a barrier runs host_dmb_hook, where a
+ *          test can let an interrupt in.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+#include "stm32l4xx_hal.h"
+#include "host_hal.h"
+
+#define HOST_DWT_CYCLES_PER_READ  4U
+
+uint32_t host_primask;
+uint32_t SystemCoreClock = 80000000U;
+
+uint32_t host_tick_ms;
+void   (*host_tick_hook)(void);
+void   (*host_dmb_hook)(void);
+
+static DWT_Type host_dwt_regs;
+
+DWT_Type *host_dwt(void)
+{
+    host_dwt_regs.CYCCNT += HOST_DWT_CYCLES_PER_READ;
+    return &host_dwt_regs;
+}
+
+/* A barrier is where the ordering of shared memory accesses matters: the
+ * hook may run an interrupt there */
+void host_dmb(void)
+{
+    __sync_synchronize();
+    if (host_dmb_hook != NULL && host_primask == 0U) {
+        host_primask = 1U;
+        host_dmb_hook();
+        host_primask = 0U;
+    }
+    __sync_synchronize();
+}
+
+uint32_t HAL_GetTick(void)
+{
+    if (host_tick_hook != NULL && host_primask == 0U) {
+        host_primask = 1U;              // An interrupt does not preempt itself
+        host_tick_hook();
+        host_primask = 0U;
+    }
+    return host_tick_ms++;
+}
+
+void HAL_Delay(uint32_t ms)
+{
+    host_tick_ms += ms;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *init)
+{
+    (void)init;
+    return HAL_OK;
+}
+
+/* Every kernel clock the modules ask for is HSI16 */
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint32_t periph)
+{
+    (void)periph;
+    return HSI_VALUE;
+}
@@ -0,0 +1,12 @@
+#ifndef _HOST_HAL_H
+#define _HOST_HAL_H
+
+/* Model time of the HAL stand-in (host_hal.c) */
+
+#include <stdint.h>
+
+extern uint32_t host_tick_ms;            /**< Next HAL_GetTick() value */
+extern void   (*host_tick_hook)(void);   /**< Runs on a poll with interrupts enabled */
+extern void   (*host_dmb_hook)(void);    /**< Runs at a __DMB() with interrupts enabled */
+
+#endif /* _HOST_HAL_H */
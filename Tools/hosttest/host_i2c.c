@@ -0,0 +1,450 @@
+/**
+ * @file    host_i2c.c
+ * @brief   Parking-Sensor project.
+ * @details Host stand-in for the I2C HAL, its DMA channel and the SCL/SDA
+ *          pins (see host_i2c.h). A started transfer stays in flight until
+ *          host_i2c_step() or the next HAL_GetTick() poll completes it and
+ *          calls the HAL completion or error callback, as the I2C
+ *          interrupt would. An armed fault ends the transfer it hits with
+ *          the given error code, a missing or silent slave ends it with an
+ *          acknowledge failure.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+#include "host_i2c.h"
+#include "host_hal.h"
+#include <string.h>
+
+#define HOST_I2C_HANDLES_MAX   4U
+#define HOST_I2C_RUN_MAX       100000U
+#define HOST_I2C_SCL           GPIO_PIN_13
+#define HOST_I2C_SDA           GPIO_PIN_14
+
+host_i2c_t  host_i2c;
+uint32_t    host_i2c_resets;
+I2C_TypeDef host_i2c2_regs;
+GPIO_TypeDef host_gpioa;
+GPIO_TypeDef host_gpiob;
+
+static I2C_HandleTypeDef *host_i2c_handles[HOST_I2C_HANDLES_MAX];
+
+/*******************************************************************************
+ * Bus lines
+ ******************************************************************************/
+static uint32_t host_gpio_mode(uint16_t pin)
+{
+    return (host_gpiob.MODER >> (2U * (uint32_t)__builtin_ctz(pin))) & 3U;
+}
+
+/* A pin drives its line low only as an output with a 0 in ODR (push-pull
+ * or open-drain alike, the model has no strong high); in AF mode
+ * the idle peripheral leaves it released */
+static bool host_gpio_released(uint16_t pin)
+{
+    return host_gpio_mode(pin) != (GPIO_MODE_OUTPUT_OD & 3U) || (host_gpiob.ODR & pin) != 0U;
+}
+
+bool host_i2c_scl(void)
+{
+    return host_gpio_released(HOST_I2C_SCL);
+}
+
+bool host_i2c_sda(void)
+{
+    return host_gpio_released(HOST_I2C_SDA) && host_i2c.sda_hold == 0U;
+}
+
+/* Apply a pin change: the slave puts its next bit on SDA after every
+ * falling SCL edge */
+static void host_i2c_lines_update(bool scl_before, bool sda_before)
+{
+    bool scl = host_i2c_scl();
+
+    if (scl_before && !scl && host_i2c.sda_hold != 0U && host_i2c.sda_hold != HOST_I2C_HOLD_FOREVER) {
+        host_i2c.sda_hold--;
+    }
+    if ((scl != scl_before || host_i2c_sda() != sda_before) && host_i2c.line_count < HOST_I2C_LINES_MAX) {
+        host_i2c_line_t *line = &host_i2c.lines[host_i2c.line_count++];
+        line->cycles = host_dwt()->CYCCNT;
+        line->scl = scl;
+        line->sda = host_i2c_sda();
+    }
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init)
+{
+    bool scl = host_i2c_scl(), sda = host_i2c_sda();
+
+    for (uint32_t bit = 0; bit < 16U; bit++) {
+        if (init->Pin & (1U << bit)) {
+            port->MODER = (port->MODER & ~(3U << (2U * bit))) | ((init->Mode & 3U) << (2U * bit));
+        }
+    }
+    host_i2c_lines_update(scl, sda);
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *port, uint32_t pin)
+{
+    GPIO_InitTypeDef init = { .Pin = pin, .Mode = GPIO_MODE_ANALOG };
+
+    HAL_GPIO_Init(port, &init);
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    bool scl = host_i2c_scl(), sda = host_i2c_sda();
+
+    if (state == GPIO_PIN_SET) {
+        port->ODR |= pin;
+    } else {
+        port->ODR &= ~(uint32_t)pin;
+    }
+    host_i2c_lines_update(scl, sda);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin)
+{
+    (void)port;
+    if (pin == HOST_I2C_SCL) {
+        return host_i2c_scl() ? GPIO_PIN_SET : GPIO_PIN_RESET;
+    }
+    if (pin == HOST_I2C_SDA) {
+        return host_i2c_sda() ? GPIO_PIN_SET : GPIO_PIN_RESET;
+    }
+    return GPIO_PIN_RESET;
+}
+
+/*******************************************************************************
+ * Slaves and faults
+ ******************************************************************************/
+static void host_i2c_service(void)
+{
+    for (uint32_t i = 0; i < HOST_I2C_HANDLES_MAX; i++) {
+        if (host_i2c_handles[i] != NULL) {
+            (void)host_i2c_step(host_i2c_handles[i]);
+        }
+    }
+}
+
+void host_i2c_reset(void)
+{
+    memset(&host_i2c, 0, sizeof(host_i2c));
+    memset(host_i2c_handles, 0, sizeof(host_i2c_handles));
+    host_i2c_resets = 0U;
+    host_gpiob.MODER = 0U;
+    host_gpiob.ODR = 0U;
+    host_tick_hook = host_i2c_service;
+}
+
+host_i2c_dev_t *host_i2c_add_device(uint16_t address)
+{
+    if (host_i2c.device_count >= HOST_I2C_DEVICES_MAX) {
+        return NULL;
+    }
+    host_i2c_dev_t *dev = &host_i2c.devices[host_i2c.device_count++];
+    dev->address = address;
+    return dev;
+}
+
+/* The transfer that ends after `after` more successful ones fails */
+void host_i2c_fail(uint32_t after, uint32_t error)
+{
+    host_i2c.fail_after = after;
+    host_i2c.fail_error = error;
+}
+
+/* The slave holds SDA low for this many more bits (a byte cut short by a
+ * reset); HOST_I2C_HOLD_FOREVER never lets go */
+void host_i2c_hold_sda(uint32_t bits)
+{
+    host_i2c.sda_hold = bits;
+}
+
+static host_i2c_dev_t *host_i2c_find(uint16_t address)
+{
+    for (uint32_t i = 0; i < host_i2c.device_count; i++) {
+        if (host_i2c.devices[i].address == address) {
+            return &host_i2c.devices[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Transfers
+ ******************************************************************************/
+static HAL_StatusTypeDef host_i2c_start(I2C_HandleTypeDef *hi2c, bool read, bool dma, uint16_t addr,
+                                        uint16_t reg, uint16_t reg_size, uint8_t *data, uint16_t size)
+{
+    if (hi2c->State != 1U || hi2c->host.busy) {
+        return HAL_BUSY;
+    }
+
+    for (uint32_t i = 0; i < HOST_I2C_HANDLES_MAX; i++) {
+        if (host_i2c_handles[i] == hi2c) {
+            break;
+        }
+        if (host_i2c_handles[i] == NULL) {
+            host_i2c_handles[i] = hi2c;
+            break;
+        }
+    }
+
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    hi2c->host = (host_i2c_xfer_t){
+        .busy = true, .read = read, .dma = dma, .address = addr,
+        .reg = reg, .reg_size = reg_size, .data = data, .size = size
+    };
+    return HAL_OK;
+}
+
+/* Complete the transfer in flight: the completion or error interrupt */
+bool host_i2c_step(I2C_HandleTypeDef *hi2c)
+{
+    host_i2c_xfer_t xfer = hi2c->host;
+
+    if (!xfer.busy || host_i2c.stall) {
+        return false;
+    }
+
+    host_i2c_dev_t *dev = host_i2c_find(xfer.address);
+    uint32_t error = HAL_I2C_ERROR_NONE;
+
+    if (host_i2c.fail_error != 0U && host_i2c.fail_after-- == 0U) {
+        error = host_i2c.fail_error;
+        host_i2c.fail_error = 0U;
+    } else if (dev == NULL || dev->nack) {
+        error = HAL_I2C_ERROR_AF;
+    } else {
+        uint8_t pointer = (xfer.reg_size != 0U) ? (uint8_t)xfer.reg : dev->pointer;
+        uint16_t i = 0;
+
+        if (!xfer.read && xfer.reg_size == 0U && xfer.size > 0U) {
+            pointer = xfer.data[i++];
+        }
+        for (; i < xfer.size; i++, pointer++) {
+            if (xfer.read) {
+                xfer.data[i] = dev->mem[pointer];
+            } else {
+                dev->mem[pointer] = xfer.data[i];
+            }
+        }
+        dev->pointer = pointer;
+    }
+
+    if (host_i2c.log_count < HOST_I2C_LOG_MAX) {
+        host_i2c.log[host_i2c.log_count++] = (host_i2c_log_t){
+            .address = xfer.address, .read = xfer.read, .dma = xfer.dma, .reg = xfer.reg,
+            .reg_size = xfer.reg_size, .size = xfer.size, .error = error
+        };
+    }
+
+    /* Ready again before the callback, which may start the next transfer;
+     * the callback runs as the interrupt, masked */
+    uint32_t primask = host_primask;
+    host_primask = 1U;
+    hi2c->host.busy = false;
+    if (error != HAL_I2C_ERROR_NONE) {
+        hi2c->ErrorCode = error;
+        HAL_I2C_ErrorCallback(hi2c);
+    } else if (xfer.read && xfer.reg_size != 0U) {
+        HAL_I2C_MemRxCpltCallback(hi2c);
+    } else if (xfer.read) {
+        HAL_I2C_MasterRxCpltCallback(hi2c);
+    } else if (xfer.reg_size != 0U) {
+        HAL_I2C_MemTxCpltCallback(hi2c);
+    } else {
+        HAL_I2C_MasterTxCpltCallback(hi2c);
+    }
+    host_primask = primask;
+    return true;
+}
+
+/* Complete transfers until the handle is idle, returns how many */
+uint32_t host_i2c_run(I2C_HandleTypeDef *hi2c)
+{
+    uint32_t count = 0;
+
+    while (count < HOST_I2C_RUN_MAX && host_i2c_step(hi2c)) {
+        count++;
+    }
+    return count;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, false, false, addr, 0U, 0U, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, true, false, addr, 0U, 0U, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, false, true, addr, 0U, 0U, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, true, true, addr, 0U, 0U, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                       uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, false, false, addr, reg, reg_size, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                      uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, true, false, addr, reg, reg_size, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                        uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, false, true, addr, reg, reg_size, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                       uint8_t *data, uint16_t size)
+{
+    return host_i2c_start(hi2c, true, true, addr, reg, reg_size, data, size);
+}
+
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t addr, uint32_t trials, uint32_t timeout)
+{
+    host_i2c_dev_t *dev = host_i2c_find(addr);
+
+    (void)trials;
+    (void)timeout;
+    if (hi2c->State != 1U || hi2c->host.busy) {
+        return HAL_BUSY;
+    }
+    if (dev == NULL || dev->nack) {
+        hi2c->ErrorCode = HAL_I2C_ERROR_AF;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+/*******************************************************************************
+ * Peripheral and DMA setup
+ ******************************************************************************/
+/* As in the HAL: i2c.c and i2c_bus.c override these when they are linked */
+__weak void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+__weak void HAL_I2C_MspDeInit(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c->State == 0U) {
+        HAL_I2C_MspInit(hi2c);
+    }
+    hi2c->Instance->TIMINGR = hi2c->Init.Timing & 0xF0FFFFFFU;
+    hi2c->Instance->CR1 |= I2C_CR1_PE;
+    hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+    hi2c->State = 1U;
+    host_i2c.inits++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c->host.busy) {
+        hi2c->host.busy = false;
+        host_i2c.dropped++;
+    }
+    hi2c->Instance->CR1 &= ~I2C_CR1_PE;
+    HAL_I2C_MspDeInit(hi2c);
+    hi2c->State = 0U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef *hi2c, uint32_t filter)
+{
+    (void)hi2c;
+    (void)filter;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigDigitalFilter(I2C_HandleTypeDef *hi2c, uint32_t filter)
+{
+    (void)hi2c;
+    (void)filter;
+    return HAL_OK;
+}
+
+void HAL_I2CEx_EnableFastModePlus(uint32_t config)
+{
+    (void)config;
+    host_i2c.fast_mode_plus = true;
+}
+
+void HAL_I2CEx_DisableFastModePlus(uint32_t config)
+{
+    (void)config;
+    host_i2c.fast_mode_plus = false;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = 1U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = 0U;
+    return HAL_OK;
+}
+
+/* Stops a DMA transfer of the linked I2C handle without a callback; the
+ * peripheral is left to the caller */
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+    I2C_HandleTypeDef *hi2c = hdma->Parent;
+
+    if (hi2c != NULL && hi2c->host.busy && hi2c->host.dma) {
+        hi2c->host.busy = false;
+        host_i2c.dma_aborts++;
+        host_i2c.dropped++;
+    }
+    return HAL_OK;
+}
@@ -0,0 +1,74 @@
+#ifndef _HOST_I2C_H
+#define _HOST_I2C_H
+
+/* I2C stand-in behind the stub HAL: register-file slaves on the bus, one
+ * transfer in flight per handle, completed from host_i2c_step() (the
+ * completion interrupt) or from a HAL_GetTick() poll. Faults are injected
+ * per transfer; SCL and SDA are modeled as open-drain lines for the bus
+ * recovery, with a slave that can hold SDA low. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32l4xx_hal.h"
+
+#define HOST_I2C_DEVICES_MAX   4U
+#define HOST_I2C_LOG_MAX       1024U
+#define HOST_I2C_LINES_MAX     256U
+#define HOST_I2C_HOLD_FOREVER  UINT32_MAX
+
+/* Slave with 256 byte registers; the first byte of a plain write is the
+ * register pointer */
+typedef struct {
+    uint16_t address;                    /**< Shifted 8-bit address */
+    bool     nack;                       /**< Does not acknowledge its address */
+    uint8_t  pointer;
+    uint8_t  mem[256];
+} host_i2c_dev_t;
+
+/* One transfer as it ended on the bus */
+typedef struct {
+    uint16_t address;
+    bool     read;
+    bool     dma;
+    uint16_t reg;
+    uint16_t reg_size;
+    uint16_t size;
+    uint32_t error;                      /**< HAL_I2C_ERROR_*, 0 = completed */
+} host_i2c_log_t;
+
+/* SCL/SDA as seen on the wires, at every change */
+typedef struct {
+    uint32_t cycles;                     /**< DWT->CYCCNT */
+    bool     scl;
+    bool     sda;
+} host_i2c_line_t;
+
+typedef struct {
+    host_i2c_dev_t  devices[HOST_I2C_DEVICES_MAX];
+    uint32_t        device_count;
+    host_i2c_log_t  log[HOST_I2C_LOG_MAX];
+    uint32_t        log_count;
+    host_i2c_line_t lines[HOST_I2C_LINES_MAX];
+    uint32_t        line_count;
+    uint32_t        fail_after;          /**< Transfers to complete before the fault */
+    uint32_t        fail_error;          /**< 0 = no fault armed */
+    bool            stall;               /**< Transfers in flight never complete */
+    uint32_t        sda_hold;            /**< Low bits the slave still has to send */
+    uint32_t        inits;               /**< HAL_I2C_Init calls */
+    uint32_t        dma_aborts;          /**< HAL_DMA_Abort with a transfer in flight */
+    uint32_t        dropped;             /**< Transfers stopped without a callback */
+    bool            fast_mode_plus;
+} host_i2c_t;
+
+extern host_i2c_t host_i2c;
+
+void host_i2c_reset(void);
+host_i2c_dev_t *host_i2c_add_device(uint16_t address);
+void host_i2c_fail(uint32_t after, uint32_t error);
+void host_i2c_hold_sda(uint32_t bits);
+bool host_i2c_step(I2C_HandleTypeDef *hi2c);
+uint32_t host_i2c_run(I2C_HandleTypeDef *hi2c);
+bool host_i2c_scl(void);
+bool host_i2c_sda(void);
+
+#endif /* _HOST_I2C_H */
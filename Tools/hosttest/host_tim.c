@@ -0,0 +1,152 @@
+/**
+ * @file    host_tim.c
+ * @brief   Parking-Sensor project.
+ * @details Host model of a general purpose timer in upcounting mode, for
+ *          the host tests. Writes are taken from the register block at the
+ *          next access, so they land at the time they were made; SR bits
+ *          are cleared by writing 0 like rc_w0 bits. An overflow while
+ *          CNT > ARR only happens after the 32-bit rollover.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <string.h>
+#include "stm32l4xx_hal.h"
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+host_tim_t         host_tim;
+
+static TIM_TypeDef host_tim_regs;
+static TIM_TypeDef host_tim_seen;        /**< Registers as handed out last */
+static int         host_tim_in_irq;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+uint32_t host_tim_random(void)
+{
+    host_tim.seed ^= host_tim.seed << 13;
+    host_tim.seed ^= host_tim.seed >> 17;
+    host_tim.seed ^= host_tim.seed << 5;
+    return host_tim.seed;
+}
+
+void host_tim_reset(uint32_t clk_units, uint32_t psc, uint32_t seed)
+{
+    memset(&host_tim, 0, sizeof(host_tim));
+    memset(&host_tim_regs, 0, sizeof(host_tim_regs));
+    host_tim.clk_units   = clk_units;
+    host_tim.psc_active  = psc;
+    host_tim.access_min  = 1U;
+    host_tim.access_span = 4U;
+    host_tim.seed        = (seed != 0U) ? seed : 1U;
+    host_tim_regs.PSC    = psc;
+    host_tim_regs.ARR    = 0xFFFFFFFFU;
+    host_tim_seen        = host_tim_regs;
+    host_primask         = 0U;
+}
+
+static void host_tim_update(void)
+{
+    host_tim_regs.CNT = 0U;
+    host_tim.psc_count = 0U;
+    host_tim.psc_active = host_tim_regs.PSC;
+}
+
+/* Registers written since the last access */
+static void host_tim_take_writes(void)
+{
+    TIM_TypeDef *r = &host_tim_regs;
+
+    if (r->SR != host_tim_seen.SR) {
+        r->SR = host_tim_seen.SR & r->SR;
+    }
+    if (r->EGR & TIM_EGR_UG) {
+        host_tim_update();
+        if (!(r->CR1 & TIM_CR1_URS)) {
+            r->SR |= TIM_SR_UIF;
+        }
+    }
+    r->EGR = 0U;
+    host_tim_seen = *r;
+}
+
+/* Kernel cycles, stopping after an overflow: returns the cycles left */
+static uint64_t host_tim_count(uint64_t cycles)
+{
+    TIM_TypeDef *r = &host_tim_regs;
+
+    if (!(r->CR1 & TIM_CR1_CEN)) {
+        host_tim.units += cycles * host_tim.clk_units;
+        return 0U;
+    }
+
+    uint64_t div = (uint64_t)host_tim.psc_active + 1U;
+    uint64_t ticks_to_ovf = (r->CNT <= r->ARR) ? (uint64_t)r->ARR - r->CNT + 1U
+                                               : (1ULL << 32) - r->CNT + r->ARR + 1U;
+    uint64_t to_ovf = (ticks_to_ovf - 1U) * div + (div - host_tim.psc_count);
+
+    if (cycles < to_ovf) {
+        uint64_t total = host_tim.psc_count + cycles;
+        r->CNT = (uint32_t)(r->CNT + total / div);
+        host_tim.psc_count = (uint32_t)(total % div);
+        host_tim.units += cycles * host_tim.clk_units;
+        host_tim_seen = *r;
+        return 0U;
+    }
+
+    host_tim.units += to_ovf * host_tim.clk_units;
+    host_tim_update();
+    r->SR |= TIM_SR_UIF;
+    if (r->DIER & TIM_DIER_UIE) {
+        host_tim.irq_pending = 1U;
+    }
+    host_tim_seen = *r;
+    return cycles - to_ovf;
+}
+
+static void host_tim_irq(void)
+{
+    if (host_tim.irq_pending && host_primask == 0U && !host_tim_in_irq &&
+        host_tim.irq_handler != NULL) {
+        host_tim.irq_pending = 0U;
+        host_tim.irqs++;
+        host_tim_in_irq = 1;
+        host_tim.irq_handler();
+        host_tim_in_irq = 0;
+    }
+}
+
+static void host_tim_advance(uint64_t kernel_cycles)
+{
+    do {
+        kernel_cycles = host_tim_count(kernel_cycles);
+        host_tim_irq();
+        host_tim_take_writes();         // The handler's last access
+    } while (kernel_cycles > 0U);
+}
+
+/* Time passing outside register accesses, e.g. other main loop work */
+void host_tim_run(uint64_t kernel_cycles)
+{
+    host_tim_take_writes();
+    host_tim_advance(kernel_cycles);
+}
+
+TIM_TypeDef *host_tim_access(void)
+{
+    host_tim_take_writes();
+    host_tim_advance(host_tim.access_min + host_tim_random() % host_tim.access_span);
+    return &host_tim_regs;
+}
+
+uint64_t host_tim_true_us(void)
+{
+    return host_tim.units / HOST_TIM_UNITS_PER_US;
+}
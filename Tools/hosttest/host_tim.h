@@ -0,0 +1,45 @@
+#ifndef _HOST_TIM_H
+#define _HOST_TIM_H
+
+/* Counter model behind the stub TIM2: prescaler with preload, auto-reload,
+ * update flag and interrupt, on a kernel clock the test can switch. Every
+ * register access advances the model by a few kernel cycles and may run
+ * the update interrupt first, so code under test is preempted at random
+ * points between its register accesses, as on the target. */
+
+#include <stdint.h>
+
+#define HOST_TIM_UNITS_PER_US  80U    /**< Model time unit: one 80 MHz cycle */
+
+typedef struct {
+    uint32_t CR1;
+    uint32_t DIER;
+    uint32_t SR;
+    uint32_t EGR;
+    uint32_t CNT;
+    uint32_t PSC;
+    uint32_t ARR;
+} TIM_TypeDef;
+
+typedef struct {
+    uint64_t units;          /**< Model time [1/80 us] */
+    uint32_t clk_units;      /**< Kernel clock period [units]: 1 = 80 MHz, 5 = 16 MHz */
+    uint32_t psc_active;     /**< Prescaler in use, PSC is its preload */
+    uint32_t psc_count;
+    uint32_t access_min;     /**< Kernel cycles per register access */
+    uint32_t access_span;
+    uint32_t irq_pending;    /**< NVIC pending bit of the update interrupt */
+    uint64_t irqs;
+    uint32_t seed;
+    void   (*irq_handler)(void);
+} host_tim_t;
+
+extern host_tim_t host_tim;
+
+void host_tim_reset(uint32_t clk_units, uint32_t psc, uint32_t seed);
+TIM_TypeDef *host_tim_access(void);
+void host_tim_run(uint64_t kernel_cycles);
+uint64_t host_tim_true_us(void);
+uint32_t host_tim_random(void);
+
+#endif /* _HOST_TIM_H */
@@ -0,0 +1,19 @@
+/**
+ * @file    hosttest.c
+ * @brief   Parking-Sensor project.
+ * @details Check counters shared by the host tests.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+#include "hosttest.h"
+
+unsigned hosttest_failed;
+unsigned hosttest_checks;
+
+int hosttest_report(void)
+{
+    printf("%u checks, %u failed\n", hosttest_checks, hosttest_failed);
+    return (hosttest_failed == 0U) ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+#ifndef _HOSTTEST_H
+#define _HOSTTEST_H
+
+/* Minimal checks for the host tests: a failed check prints its place and
+ * the test goes on, the exit code tells if any failed */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+extern unsigned hosttest_failed;
+extern unsigned hosttest_checks;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        hosttest_checks++;                                                 \
+        if (!(cond)) {                                                     \
+            hosttest_failed++;                                             \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                  \
+    } while (0)
+
+#define CHECK_EQ_I64(a, b, tol)                                            \
+    do {                                                                   \
+        int64_t a_ = (int64_t)(a), b_ = (int64_t)(b);                      \
+        hosttest_checks++;                                                 \
+        if (a_ - b_ > (tol) || b_ - a_ > (tol)) {                          \
+            hosttest_failed++;                                             \
+            printf("%s:%d: %s = %lld, expected %lld\n", __FILE__, __LINE__, \
+                   #a, (long long)a_, (long long)b_);                      \
+        }                                                                  \
+    } while (0)
+
+#define RUN(test)                                                          \
+    do {                                                                   \
+        printf("%s\n", #test);                                             \
+        test;                                                              \
+    } while (0)
+
+int hosttest_report(void);
+
+#endif /* _HOSTTEST_H */
@@ -0,0 +1,14 @@
+#ifndef _HOSTTEST_ANSI_H
+#define _HOSTTEST_ANSI_H
+
+/* newlib's _ansi.h, as far as the SSD1306 headers use it */
+
+#ifdef __cplusplus
+#define _BEGIN_STD_C extern "C" {
+#define _END_STD_C   }
+#else
+#define _BEGIN_STD_C
+#define _END_STD_C
+#endif
+
+#endif /* _HOSTTEST_ANSI_H */
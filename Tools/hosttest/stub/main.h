@@ -0,0 +1,23 @@
+#ifndef _HOSTTEST_MAIN_H
+#define _HOSTTEST_MAIN_H
+
+/* Host stand-in for Core/App/Inc/main.h, as far as the tested modules use
+ * it: the pin helpers go through the HAL, as without APP_FAST_IO. The test
+ * defines Error_Handler. */
+
+#include "stm32l4xx_hal.h"
+#include "app_conf.h"
+
+void Error_Handler(void);
+
+static inline void IO_PinWrite(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    HAL_GPIO_WritePin(port, pin, state);
+}
+
+static inline GPIO_PinState IO_PinRead(GPIO_TypeDef *port, uint16_t pin)
+{
+    return HAL_GPIO_ReadPin(port, pin);
+}
+
+#endif /* _HOSTTEST_MAIN_H */
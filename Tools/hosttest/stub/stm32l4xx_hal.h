@@ -0,0 +1,256 @@
+#ifndef _HOSTTEST_STM32L4XX_HAL_H
+#define _HOSTTEST_STM32L4XX_HAL_H
+
+/* Host stand-in for the HAL and CMSIS parts the tested modules use.
+ * host_hal.c has the core and clock functions, host_i2c.c the I2C
+ * peripheral, its DMA channel and the two bus lines. Timer registers go
+ * through host_tim.c, which runs a counter model on every access. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "host_tim.h"
+
+#define __weak                             __attribute__((weak))
+
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+/* Core: tick, cycle counter, PRIMASK, NVIC */
+typedef struct {
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+#define DWT                                (host_dwt())
+#define HSI_VALUE                          16000000U
+
+#define HAL_NVIC_SetPriority(irq, p, s)    ((void)(irq), (void)(p), (void)(s))
+#define HAL_NVIC_EnableIRQ(irq)            ((void)(irq))
+#define HAL_NVIC_DisableIRQ(irq)           ((void)(irq))
+#define EXTI0_IRQn                         6
+#define __get_PRIMASK()                    (host_primask)
+#define __set_PRIMASK(mask)                (host_primask = (mask))
+#define __disable_irq()                    (host_primask = 1U)
+#define __DMB()                            host_dmb()
+
+extern uint32_t host_primask;
+extern uint32_t SystemCoreClock;
+
+DWT_Type *host_dwt(void);
+void host_dmb(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+
+/* TIM2, the timebase counter */
+#define TIM2                               (host_tim_access())
+#define TIM2_IRQn                          28
+#define TIM_CR1_CEN                        0x0001U
+#define TIM_CR1_URS                        0x0004U
+#define TIM_DIER_UIE                       0x0001U
+#define TIM_SR_UIF                         0x0001U
+#define TIM_EGR_UG                         0x0001U
+
+/* RCC */
+typedef struct {
+    uint32_t PeriphClockSelection;
+    uint32_t I2c2ClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_PERIPHCLK_I2C2                 0x0100U
+#define RCC_I2C2CLKSOURCE_HSI              0x0002U
+#define __HAL_RCC_GPIOA_CLK_ENABLE()       ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()       ((void)0)
+#define __HAL_RCC_I2C2_CLK_ENABLE()        ((void)0)
+#define __HAL_RCC_I2C2_CLK_DISABLE()       ((void)0)
+#define __HAL_RCC_I2C2_FORCE_RESET()       (host_i2c_resets++)
+#define __HAL_RCC_I2C2_RELEASE_RESET()     ((void)0)
+
+extern uint32_t host_i2c_resets;
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *init);
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint32_t periph);
+
+/* GPIO: port B carries the I2C2 lines */
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+    uint32_t MODER;                      /**< 2 bits per pin, the low bits of GPIO_MODE_* */
+    uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+    uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+extern GPIO_TypeDef host_gpioa;
+extern GPIO_TypeDef host_gpiob;
+
+#define GPIOA                              (&host_gpioa)
+#define GPIOB                              (&host_gpiob)
+#define GPIO_PIN_0                         0x0001U
+#define GPIO_PIN_6                         0x0040U
+#define GPIO_PIN_13                        0x2000U
+#define GPIO_PIN_14                        0x4000U
+#define GPIO_MODE_INPUT                    0x00U
+#define GPIO_MODE_OUTPUT_PP                0x01U
+#define GPIO_MODE_OUTPUT_OD                0x11U
+#define GPIO_MODE_AF_OD                    0x12U
+#define GPIO_MODE_ANALOG                   0x03U
+#define GPIO_MODE_IT_RISING_FALLING        0x10310000U
+#define GPIO_NOPULL                        0U
+#define GPIO_SPEED_FREQ_LOW                0U
+#define GPIO_SPEED_FREQ_VERY_HIGH          3U
+#define GPIO_AF4_I2C2                      4U
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_DeInit(GPIO_TypeDef *port, uint32_t pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+
+/* DMA, as far as the drivers look into the handles */
+typedef struct {
+    uint32_t Request;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct {
+    void            *Instance;
+    DMA_InitTypeDef  Init;
+    void            *Parent;
+    uint32_t         State;
+} DMA_HandleTypeDef;
+
+#define DMA1_Channel4                      ((void *)"dma1 ch4")
+#define DMA_REQUEST_3                      3U
+#define DMA_MEMORY_TO_PERIPH               0x10U
+#define DMA_PINC_DISABLE                   0U
+#define DMA_MINC_ENABLE                    0x80U
+#define DMA_PDATAALIGN_BYTE                0U
+#define DMA_MDATAALIGN_BYTE                0U
+#define DMA_NORMAL                         0U
+#define DMA_PRIORITY_LOW                   0U
+
+#define __HAL_LINKDMA(handle, field, dma)  \
+    do { (handle)->field = &(dma); (dma).Parent = (handle); } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+
+/* I2C */
+typedef struct {
+    uint32_t CR1;
+    uint32_t TIMINGR;
+} I2C_TypeDef;
+
+typedef struct {
+    uint32_t Timing;
+    uint32_t OwnAddress1;
+    uint32_t AddressingMode;
+    uint32_t DualAddressMode;
+    uint32_t OwnAddress2;
+    uint32_t OwnAddress2Masks;
+    uint32_t GeneralCallMode;
+    uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+/* Transfer started on the stand-in and not completed yet */
+typedef struct {
+    bool      busy;
+    bool      read;
+    bool      dma;
+    uint16_t  address;
+    uint16_t  reg;
+    uint16_t  reg_size;                  /**< 0 = no register address */
+    uint8_t  *data;
+    uint16_t  size;
+} host_i2c_xfer_t;
+
+typedef struct {
+    I2C_TypeDef       *Instance;
+    I2C_InitTypeDef    Init;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+    volatile uint32_t  State;            /**< 0 = reset, 1 = ready */
+    volatile uint32_t  ErrorCode;
+    host_i2c_xfer_t    host;
+} I2C_HandleTypeDef;
+
+extern I2C_TypeDef host_i2c2_regs;
+
+#define I2C2                               (&host_i2c2_regs)
+#define I2C2_EV_IRQn                       33
+#define I2C2_ER_IRQn                       34
+#define I2C_CR1_PE                         0x0001U
+#define I2C_TIMINGR_SCLL_Pos               0U
+#define I2C_TIMINGR_SCLH_Pos               8U
+#define I2C_TIMINGR_SDADEL_Pos             16U
+#define I2C_TIMINGR_SCLDEL_Pos             20U
+#define I2C_TIMINGR_PRESC_Pos              28U
+#define I2C_ADDRESSINGMODE_7BIT            1U
+#define I2C_DUALADDRESS_DISABLE            0U
+#define I2C_OA2_NOMASK                     0U
+#define I2C_GENERALCALL_DISABLE            0U
+#define I2C_NOSTRETCH_DISABLE              0U
+#define I2C_ANALOGFILTER_ENABLE            0U
+#define I2C_FASTMODEPLUS_I2C2              0x0200U
+#define HAL_I2C_ERROR_NONE                 0x00U
+#define HAL_I2C_ERROR_BERR                 0x01U
+#define HAL_I2C_ERROR_ARLO                 0x02U
+#define HAL_I2C_ERROR_AF                   0x04U
+#define HAL_I2C_ERROR_OVR                  0x08U
+#define HAL_I2C_ERROR_DMA                  0x10U
+#define HAL_I2C_ERROR_TIMEOUT              0x20U
+#define I2C_MEMADD_SIZE_8BIT               0x01U
+#define I2C_MEMADD_SIZE_16BIT              0x02U
+
+#define __HAL_I2C_ENABLE(h)                ((h)->Instance->CR1 |= I2C_CR1_PE)
+#define __HAL_I2C_DISABLE(h)               ((h)->Instance->CR1 &= ~I2C_CR1_PE)
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MspDeInit(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef *hi2c, uint32_t filter);
+HAL_StatusTypeDef HAL_I2CEx_ConfigDigitalFilter(I2C_HandleTypeDef *hi2c, uint32_t filter);
+void HAL_I2CEx_EnableFastModePlus(uint32_t config);
+void HAL_I2CEx_DisableFastModePlus(uint32_t config);
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                       uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                      uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                        uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *hi2c, uint16_t addr, uint16_t reg, uint16_t reg_size,
+                                       uint8_t *data, uint16_t size);
+HAL_StatusTypeDef HAL_I2C_IsDeviceReady(I2C_HandleTypeDef *hi2c, uint16_t addr, uint32_t trials, uint32_t timeout);
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+#endif /* _HOSTTEST_STM32L4XX_HAL_H */
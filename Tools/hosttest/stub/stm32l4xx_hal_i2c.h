@@ -0,0 +1,8 @@
+#ifndef _HOSTTEST_STM32L4XX_HAL_I2C_H
+#define _HOSTTEST_STM32L4XX_HAL_I2C_H
+
+/* The I2C part of the stand-in lives in stm32l4xx_hal.h */
+
+#include "stm32l4xx_hal.h"
+
+#endif /* _HOSTTEST_STM32L4XX_HAL_I2C_H */
@@ -0,0 +1,291 @@
+/**
+ * @file    test_calib.c
+ * @brief   Parking-Sensor project.
+ * @details Host tests of the distance calibration in calib.c: the identity
+ *          table, one reference as an offset, two as a gain and offset,
+ *          piecewise fits through random references against the ideal
+ *          broken line (exact on the breakpoints, within the chord error
+ *          between them), extrapolation past the references, a corrected
+ *          echo that never runs backwards, refused reference sets that
+ *          leave the table as it was, saturation of the offsets, and the
+ *          seal. calib_flash.c needs the linker's CALIB page and is not
+ *          built here.
+ *
+ *          test_calib [seed]
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "calib.h"
+#include "policy.h"
+#include "hosttest.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define ECHO_MIN_US        116U          /**< HS_SR04_ECHO_MIN_US */
+#define ECHO_MAX_US        23300U        /**< HS_SR04_ECHO_MAX_US */
+#define BREAKPOINT_US      (1U << CALIB_SHIFT)
+#define TABLE_END_US       ((CALIB_POINTS - 1U) << CALIB_SHIFT)   /**< Last breakpoint */
+#define FIT_TRIALS         2000U
+#define REF_SPACING_US     600U          /**< Closest references of the random fits */
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint32_t seed;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static uint32_t rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/* Broken line through the sorted references, straight on past both ends */
+static double ideal(const calib_ref_t *refs, uint32_t count, double x)
+{
+    uint32_t seg = 0;
+
+    if (count == 1U) {
+        return x + (double)refs[0].true_us - (double)refs[0].raw_us;
+    }
+    while (seg + 2U < count && x > refs[seg + 1U].raw_us) {
+        seg++;
+    }
+    const calib_ref_t *a = &refs[seg], *b = &refs[seg + 1U];
+    return a->true_us + ((double)b->true_us - a->true_us) * (x - a->raw_us) / ((double)b->raw_us - a->raw_us);
+}
+
+static void test_identity(void)
+{
+    calib_table_t table;
+
+    calib_identity(&table);
+    CHECK(calib_valid(&table));
+    CHECK(table.refs == 0U);
+    for (uint32_t raw = 0; raw < 30000U; raw += 7U) {
+        CHECK(calib_apply(&table, raw) == raw);
+    }
+}
+
+/* One reference shifts every echo; below zero the result stops at zero */
+static void test_offset(void)
+{
+    calib_table_t table;
+    calib_ref_t up = { 1000U, 1100U };
+    calib_ref_t down = { 1000U, 900U };
+
+    CHECK(calib_fit(&table, &up, 1U));
+    CHECK(calib_valid(&table) && table.refs == 1U);
+    for (uint32_t raw = 0; raw < 30000U; raw += 13U) {
+        CHECK(calib_apply(&table, raw) == raw + 100U);
+    }
+
+    CHECK(calib_fit(&table, &down, 1U));
+    CHECK(calib_apply(&table, 50U) == 0U);
+    for (uint32_t raw = 100U; raw < 30000U; raw += 13U) {
+        CHECK(calib_apply(&table, raw) == raw - 100U);
+    }
+}
+
+/* Two references: a gain and an offset, to the rounding of the table over
+ * the whole range. Past the last breakpoint the rounding of its last
+ * interval goes on with the line, up to 1 us per 256. */
+static void test_gain(void)
+{
+    for (uint32_t trial = 0; trial < FIT_TRIALS; trial++) {
+        calib_table_t table;
+        double gain = 0.9 + (rnd() % 2001U) / 10000.0;
+        int32_t offset = (int32_t)(rnd() % 601U) - 300;
+        calib_ref_t refs[2];
+
+        refs[0].raw_us = 500U + rnd() % 2000U;
+        refs[1].raw_us = 15000U + rnd() % 8000U;
+        for (uint32_t i = 0; i < 2U; i++) {
+            refs[i].true_us = (uint32_t)(refs[i].raw_us * gain + offset + 0.5);
+        }
+        CHECK(calib_fit(&table, refs, 2U));
+
+        int64_t worst = 0;
+        for (uint32_t raw = ECHO_MIN_US; raw <= TABLE_END_US + 2000U; raw += 37U) {
+            double want = ideal(refs, 2U, raw);
+            uint32_t out = calib_apply(&table, raw);
+
+            if (want < -1.0) {
+                CHECK(out == 0U);                        // Held at zero
+            } else if (raw > TABLE_END_US) {
+                CHECK_EQ_I64(out, (int64_t)(want + 0.5), 2 + (raw - TABLE_END_US) / 256U);
+            } else if (want >= 0.0) {
+                int64_t err = (int64_t)out - (int64_t)(want + 0.5);
+                worst = (llabs(err) > worst) ? llabs(err) : worst;
+            }
+        }
+        CHECK_EQ_I64(worst, 0, 2);
+    }
+}
+
+/* Random references in random order: the table follows the broken line
+ * through them, exactly on the breakpoints and within the chord error of
+ * a corner between them */
+static void test_piecewise(void)
+{
+    for (uint32_t trial = 0; trial < FIT_TRIALS; trial++) {
+        calib_table_t table, shuffled;
+        calib_ref_t refs[CALIB_MAX_REFS], mixed[CALIB_MAX_REFS];
+        uint32_t count = 2U + rnd() % (CALIB_MAX_REFS - 1U);
+        uint32_t raw = ECHO_MIN_US + rnd() % 1000U;
+        double y = raw * (0.95 + (rnd() % 1001U) / 10000.0);
+
+        for (uint32_t i = 0; i < count; i++) {
+            refs[i].raw_us = raw;
+            refs[i].true_us = (uint32_t)y;
+            uint32_t step = REF_SPACING_US + rnd() % ((ECHO_MAX_US - REF_SPACING_US) / count);
+            raw += step;
+            y += step * (0.9 + (rnd() % 2001U) / 10000.0);
+        }
+        CHECK(calib_fit(&table, refs, count));
+
+        memcpy(mixed, refs, sizeof(refs));
+        for (uint32_t i = count - 1U; i > 0U; i--) {
+            uint32_t j = rnd() % (i + 1U);
+            calib_ref_t t = mixed[i];
+            mixed[i] = mixed[j];
+            mixed[j] = t;
+        }
+        CHECK(calib_fit(&shuffled, mixed, count));
+        CHECK(memcmp(&table, &shuffled, sizeof(table)) == 0);
+
+        /* Largest slope change at a corner: the chord across its breakpoint
+         * interval is off by at most a quarter of it times the interval */
+        double bend = 0.0;
+        for (uint32_t i = 1; i + 1U < count; i++) {
+            double s0 = ((double)refs[i].true_us - refs[i - 1U].true_us) / (refs[i].raw_us - refs[i - 1U].raw_us);
+            double s1 = ((double)refs[i + 1U].true_us - refs[i].true_us) / (refs[i + 1U].raw_us - refs[i].raw_us);
+            bend = (s1 - s0 > bend) ? s1 - s0 : (s0 - s1 > bend) ? s0 - s1 : bend;
+        }
+        int64_t tol = 2 + (int64_t)(bend * BREAKPOINT_US / 4.0 + 0.5);
+
+        uint32_t prev = 0U;
+        for (uint32_t x = 0; x <= refs[count - 1U].raw_us + 2000U; x += 11U) {
+            uint32_t out = calib_apply(&table, x);
+            double want = ideal(refs, count, x);
+
+            if (want < -1.0) {
+                CHECK(out == 0U);
+            } else if (x > TABLE_END_US) {
+                CHECK_EQ_I64(out, (int64_t)(want + 0.5), 2 + (x - TABLE_END_US) / 256U);
+            } else if (want >= 0.0) {
+                CHECK_EQ_I64(out, (int64_t)(want + 0.5), (x % BREAKPOINT_US == 0U) ? 1 : tol);
+            }
+            CHECK(out >= prev);                          // Never runs backwards
+            prev = out;
+        }
+    }
+}
+
+/* Sets that cannot be fitted are refused and the table stays */
+static void test_refused(void)
+{
+    calib_table_t table, before;
+    calib_ref_t refs[CALIB_MAX_REFS + 1U];
+    calib_ref_t same_raw[2] = { { 3000U, 3100U }, { 3000U, 3200U } };
+    calib_ref_t flat[2] = { { 2000U, 2100U }, { 4000U, 2100U } };
+    calib_ref_t crossed[3] = { { 2000U, 2100U }, { 6000U, 5000U }, { 4000U, 5500U } };
+
+    for (uint32_t i = 0; i <= CALIB_MAX_REFS; i++) {
+        refs[i] = (calib_ref_t){ 1000U + i * 1000U, 1050U + i * 1000U };
+    }
+    CHECK(calib_fit(&table, refs, 2U));
+    before = table;
+
+    CHECK(!calib_fit(&table, refs, 0U));
+    CHECK(!calib_fit(&table, refs, CALIB_MAX_REFS + 1U));
+    CHECK(!calib_fit(&table, same_raw, 2U));
+    CHECK(!calib_fit(&table, flat, 2U));
+    CHECK(!calib_fit(&table, crossed, 3U));
+    CHECK(memcmp(&table, &before, sizeof(table)) == 0);
+    CHECK(calib_fit(&table, refs, CALIB_MAX_REFS));
+}
+
+/* An offset past int16 is held at the limit */
+static void test_saturation(void)
+{
+    calib_table_t table;
+    calib_ref_t far = { 1000U, 1000U + 40000U };
+    calib_ref_t steep[2] = { { 1000U, 1000U }, { 2000U, 12000U } };
+
+    CHECK(calib_fit(&table, &far, 1U));
+    for (uint32_t i = 0; i < CALIB_POINTS; i++) {
+        CHECK(table.corr_us[i] == INT16_MAX);
+    }
+    CHECK(calib_apply(&table, 5000U) == 5000U + INT16_MAX);
+
+    CHECK(calib_fit(&table, steep, 2U));
+    CHECK(table.corr_us[0] < 0 && table.corr_us[CALIB_POINTS - 1U] == INT16_MAX);
+    CHECK(calib_apply(&table, 0U) == 0U);
+}
+
+/* Any changed byte fails the check until the table is sealed again */
+static void test_seal(void)
+{
+    calib_table_t table;
+    calib_ref_t refs[3] = { { 1200U, 1180U }, { 6000U, 6100U }, { 15000U, 15350U } };
+
+    CHECK(calib_fit(&table, refs, 3U));
+    CHECK(calib_valid(&table));
+    for (uint32_t i = 0; i < offsetof(calib_table_t, crc); i++) {
+        calib_table_t bad = table;
+
+        ((uint8_t *)&bad)[i] ^= (uint8_t)(1U << (rnd() % 8U));
+        CHECK(!calib_valid(&bad));
+    }
+    table.corr_us[5]++;
+    CHECK(!calib_valid(&table));
+    calib_seal(&table);
+    CHECK(calib_valid(&table));
+    table.version++;
+    calib_seal(&table);
+    CHECK(!calib_valid(&table));                     // Sealed, but a newer layout
+}
+
+/* "cal <cm>" turns the target distance into its echo: the policy's echo
+ * to distance conversion gives the distance back */
+static void test_cm_to_echo(void)
+{
+    for (uint32_t cm100 = 200U; cm100 <= 40000U; cm100 += 3U) {
+        uint32_t echo = CALIB_CM100_TO_ECHO(cm100);
+
+        CHECK_EQ_I64(POLICY_ECHO_TO_CM100(echo), cm100, 1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1U;
+    if (seed == 0U) {
+        seed = 1U;
+    }
+
+    RUN(test_identity());
+    RUN(test_offset());
+    RUN(test_gain());
+    RUN(test_piecewise());
+    RUN(test_refused());
+    RUN(test_saturation());
+    RUN(test_seal());
+    RUN(test_cm_to_echo());
+
+    return hosttest_report();
+}
@@ -0,0 +1,249 @@
+/**
+ * @file    test_echo_ring.c
+ * @brief   Parking-Sensor project.
+ * @details Host stress test of the echo ring of hcsr04.c: the EXTI ISR
+ *          publishes completed echoes with HCSR04_EchoEdge(), the main
+ *          loop takes them with HCSR04_ReadEcho() and never masks
+ *          interrupts. Every echo carries its number in the timestamps
+ *          (rise = number * period, width a function of the number), so
+ *          a torn, repeated or reordered record shows up in the consumer.
+ *          Two kinds of preemption:
+ *          - at the barriers of the ring, through host_dmb_hook: a random
+ *            burst of edges lands between the head read, the copy and
+ *            the tail release, reproducible from the seed;
+ *          - anywhere, from a SIGALRM handler on a random one-shot timer,
+ *            which interrupts the consumer between any two instructions
+ *            as the EXTI interrupt would on the single core.
+ *          The consumer runs slower than the edges at random, so the ring
+ *          fills and drops; every echo is read once or counted as dropped.
+ *
+ *          test_echo_ring [seed]
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#include "hcsr04.h"
+#include "host_hal.h"
+#include "hosttest.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define ECHO_PERIOD_US      1000U        /**< Rise of echo n at n * period */
+#define BARRIER_ROUNDS      200000U
+#define SIGNAL_ECHOES       20000U
+#define SIGNAL_MIN_ECHOES   1000U        /**< Enough to count on a loaded host */
+#define SIGNAL_LIMIT_S      5
+#define SIGNAL_INTERVAL_US  40U          /**< Longest gap between two edges */
+#define SIGNAL_STALL_SPIN   500000U      /**< Now and then the loop is busy long enough to fill the ring */
+
+/*******************************************************************************
+ * Typedefs
+ ******************************************************************************/
+typedef struct {
+    uint32_t consumed;
+    uint32_t last;                       /**< Number of the last echo read */
+    bool     any;
+} consumer_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static volatile uint32_t produced;       /**< Echoes completed by the ISR model */
+static volatile bool     edge_high;
+static volatile uint32_t edges_in_read;  /**< Edges delivered inside HCSR04_ReadEcho */
+static uint32_t          seed;
+static uint32_t          alarm_seed;     /**< The handler's own generator */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static uint32_t xorshift(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static uint32_t rnd(void)
+{
+    return xorshift(&seed);
+}
+
+static timer_tick_t echo_width(uint32_t n)
+{
+    return HS_SR04_ECHO_MIN_US + (n * 37U) % 500U;
+}
+
+/* The EXTI ISR: the next edge of the echo sequence. It does not preempt
+ * itself, so its own barriers do not run the hook. */
+static void isr_edge(void)
+{
+    uint32_t n = produced;
+    uint32_t primask = host_primask;
+
+    host_primask = 1U;
+    if (!edge_high) {
+        edge_high = true;
+        HCSR04_EchoEdge(n * ECHO_PERIOD_US, GPIO_PIN_SET);
+    } else {
+        edge_high = false;
+        HCSR04_EchoEdge(n * ECHO_PERIOD_US + echo_width(n), GPIO_PIN_RESET);
+        produced = n + 1U;
+    }
+    host_primask = primask;
+}
+
+static void isr_burst(uint32_t max)
+{
+    for (uint32_t i = rnd() % (max + 1U); i > 0U; i--) {
+        isr_edge();
+    }
+}
+
+/* The record is one whole echo, newer than the one before */
+static void consume(consumer_t *c, const hcsr04_echo_t *echo)
+{
+    uint32_t n = echo->rise_us / ECHO_PERIOD_US;
+
+    CHECK(echo->status == HCSR04_ECHO_OK);
+    CHECK(echo->seq == 0U);
+    CHECK(echo->rise_us == n * ECHO_PERIOD_US);
+    CHECK(echo->fall_us - echo->rise_us == echo_width(n));
+    CHECK(n < produced);
+    CHECK(!c->any || n > c->last);
+    c->last = n;
+    c->any = true;
+    c->consumed++;
+}
+
+static void drain(consumer_t *c)
+{
+    hcsr04_echo_t echo;
+
+    while (HCSR04_ReadEcho(&echo)) {
+        consume(c, &echo);
+    }
+}
+
+/* Every echo completed since `before` was read once or dropped */
+static void check_accounting(const hcsr04_echo_stats_t *before, uint32_t produced_before,
+                             const consumer_t *c)
+{
+    hcsr04_echo_stats_t after;
+
+    HCSR04_GetEchoStats(&after);
+    CHECK(after.records - before->records == c->consumed);
+    CHECK(after.records - before->records + after.dropped - before->dropped == produced - produced_before);
+    printf("  %u echoes, %u read, %u dropped\n", produced - produced_before, c->consumed,
+           after.dropped - before->dropped);
+}
+
+static void dmb_hook(void)
+{
+    uint32_t before = produced;
+
+    isr_burst(3U);
+    edges_in_read += produced - before;
+}
+
+/* Preemption at the ring's barriers */
+static void test_barriers(void)
+{
+    hcsr04_echo_stats_t before;
+    consumer_t c = { 0 };
+    uint32_t produced_before = produced;
+    hcsr04_echo_t echo;
+
+    HCSR04_GetEchoStats(&before);
+    edges_in_read = 0U;
+    host_dmb_hook = dmb_hook;
+    for (uint32_t round = 0; round < BARRIER_ROUNDS; round++) {
+        isr_burst(4U);
+        for (uint32_t reads = rnd() % 4U; reads > 0U; reads--) {
+            if (HCSR04_ReadEcho(&echo)) {
+                consume(&c, &echo);
+            }
+        }
+    }
+    host_dmb_hook = NULL;
+    if (edge_high) {
+        isr_edge();
+    }
+    drain(&c);
+
+    check_accounting(&before, produced_before, &c);
+    CHECK(edges_in_read > 0U);
+    CHECK(c.consumed < produced - produced_before);   // The ring ran full
+}
+
+static void alarm_arm(void)
+{
+    struct itimerval t = { .it_value = { .tv_sec = 0, .tv_usec = 1 + (long)(xorshift(&alarm_seed) % SIGNAL_INTERVAL_US) } };
+
+    setitimer(ITIMER_REAL, &t, NULL);
+}
+
+static void alarm_handler(int sig)
+{
+    (void)sig;
+    isr_edge();
+    alarm_arm();
+}
+
+/* Preemption at any instruction of the consumer */
+static void test_signal(void)
+{
+    hcsr04_echo_stats_t before;
+    consumer_t c = { 0 };
+    uint32_t produced_before = produced;
+    struct sigaction sa = { .sa_handler = alarm_handler };
+    struct itimerval off = { 0 };
+    time_t t_end = time(NULL) + SIGNAL_LIMIT_S;
+    hcsr04_echo_t echo;
+
+    HCSR04_GetEchoStats(&before);
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGALRM, &sa, NULL);
+    alarm_arm();
+    while (produced - produced_before < SIGNAL_ECHOES && time(NULL) < t_end) {
+        if (HCSR04_ReadEcho(&echo)) {
+            consume(&c, &echo);
+        }
+        uint32_t work = (rnd() % 1024U == 0U) ? SIGNAL_STALL_SPIN : rnd() % 2000U;
+        for (volatile uint32_t spin = work; spin > 0U; spin--) {
+        }
+    }
+    setitimer(ITIMER_REAL, &off, NULL);
+    signal(SIGALRM, SIG_IGN);
+    if (edge_high) {
+        isr_edge();
+    }
+    drain(&c);
+
+    check_accounting(&before, produced_before, &c);
+    CHECK(produced - produced_before >= SIGNAL_MIN_ECHOES);
+}
+
+int main(int argc, char **argv)
+{
+    seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1U;
+    if (seed == 0U) {
+        seed = 1U;
+    }
+    alarm_seed = seed ^ 0x9E3779B9U;
+
+    RUN(test_barriers());
+    RUN(test_signal());
+
+    return hosttest_report();
+}
@@ -0,0 +1,358 @@
+/**
+ * @file    test_emitters.c
+ * @brief   Parking-Sensor project.
+ * @details Multi-emitter simulation of the echo validation in hcsr04.c.
+ *          Our unit pings a target at a known distance on the schedule of
+ *          Measure_Echo() in main.c: the next ping when the echo wait
+ *          ends, plus the APP_PING_JITTER offset in jitter mode. Other
+ *          emitters share the air: units with the same firmware (with or
+ *          without jitter, their own seeds) and steady car sensors. A
+ *          foreign burst that reaches our receiver while the echo pin is
+ *          high ends the echo there, as on the HC-SR04. The edges go
+ *          through HCSR04_EchoEdge() and the result through
+ *          HCSR04_PollEcho(); against the known distance every accepted
+ *          echo is right or a false accept.
+ *
+ *          Each scenario runs with the 043 validation alone (steady
+ *          schedule, no confirm) and with jitter and confirm, and prints
+ *          the rate of good readings, the false accepts and the driver's
+ *          own false accept estimate. Checked with jitter in every
+ *          scenario: at most the scenario's share of false accepts
+ *          among the accepted readings, and at least its rate of good
+ *          readings. A still target on a clean bus: every reading once
+ *          the history is filled. Then the confirm rule on its own: a
+ *          width that repeats at one ping offset is never accepted, a
+ *          real step is.
+ *
+ *          test_emitters [seed]
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdlib.h>
+#include "app_conf.h"
+#include "hcsr04.h"
+#include "timebase.h"
+#include "hosttest.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define SIM_PINGS              4000U
+#define SIM_EMITTERS_MAX       4U
+#define SIM_RISE_US            460U      /**< Trigger end -> echo rise: the 8-cycle burst */
+#define SIM_DONE_US            50U       /**< Fall -> PollEcho returns in the main loop */
+#define SIM_NOISE_US           20U       /**< Echo width jitter of a still target */
+#define SIM_GOOD_US            290U      /**< ~5 cm: a reading this close is right */
+#define SIM_US_PER_M           2915U     /**< Sound, one way */
+#define SIM_INTERVAL_US        1000U     /**< measure_interval of main.c */
+
+/*******************************************************************************
+ * Typedefs
+ ******************************************************************************/
+typedef enum {
+    EMITTER_STEADY = 0,                  /**< Fixed period, e.g. a car's sensor */
+    EMITTER_UNIT,                        /**< Our firmware on another unit */
+} emitter_kind_t;
+
+typedef struct {
+    emitter_kind_t kind;
+    uint32_t       period_us;            /**< Steady: ping period */
+    uint32_t       echo_us;              /**< Unit: its own echo width */
+    uint32_t       delay_us;             /**< Its burst -> our receiver */
+    uint32_t       first_us;             /**< First ping */
+    bool           jitter;               /**< Unit: APP_PING_JITTER */
+
+    /* Run state */
+    uint64_t       next_us;
+    uint32_t       rng;
+    uint32_t       offset_us;
+} emitter_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    false_max_permille;      /**< Of the accepted readings, with jitter */
+    uint32_t    rate_min_hz;             /**< Good readings with jitter */
+    uint32_t    echo_us;                 /**< Our target */
+    uint32_t    speed_cm_s;              /**< 0 = still, else in and out to half of echo_us */
+    uint32_t    count;
+    emitter_t   emitters[SIM_EMITTERS_MAX];
+} scenario_t;
+
+typedef struct {
+    uint32_t pings;
+    uint32_t good;
+    uint32_t false_accepts;
+    uint32_t driver_false;               /**< hcsr04_echo_stats_t.false_accepts */
+    uint64_t time_us;
+} sim_result_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint32_t seed;
+
+static const scenario_t scenarios[] = {
+    { "clean", 10U, 20U, 5830U, 0U, 0U, { { 0 } } },
+    /* Car sensors 1 m away. Without jitter our schedule can lock to one:
+     * its burst cuts every echo at the same point, or none get through. */
+    { "car60", 10U, 20U, 5830U, 0U, 1U, {
+        { .kind = EMITTER_STEADY, .period_us = 60000U, .delay_us = SIM_US_PER_M, .first_us = 1000U },
+    } },
+    { "car40", 10U, 20U, 5830U, 0U, 1U, {
+        { .kind = EMITTER_STEADY, .period_us = 40000U, .delay_us = SIM_US_PER_M, .first_us = 1000U },
+    } },
+    { "car25", 10U, 20U, 5830U, 0U, 1U, {
+        { .kind = EMITTER_STEADY, .period_us = 25000U, .delay_us = SIM_US_PER_M, .first_us = 1000U },
+    } },
+    /* Backing in and out at walking pace, alone and next to a unit */
+    { "move", 10U, 20U, 8750U, 30U, 0U, { { 0 } } },
+    { "move+u", 10U, 15U, 8750U, 30U, 1U, {
+        { .kind = EMITTER_UNIT, .echo_us = 8750U, .delay_us = SIM_US_PER_M, .first_us = 500U },
+    } },
+    /* A unit 1 m away pinging its own target */
+    { "unit", 10U, 20U, 5830U, 0U, 1U, {
+        { .kind = EMITTER_UNIT, .echo_us = 8750U, .delay_us = SIM_US_PER_M, .first_us = 500U },
+    } },
+    /* Two more units and a car sensor: three bursts in every echo wait */
+    { "garage", 20U, 10U, 4080U, 0U, 3U, {
+        { .kind = EMITTER_UNIT, .echo_us = 4080U, .delay_us = SIM_US_PER_M, .first_us = 300U },
+        { .kind = EMITTER_UNIT, .echo_us = 8750U, .delay_us = 2U * SIM_US_PER_M, .first_us = 2100U },
+        { .kind = EMITTER_STEADY, .period_us = 60000U, .delay_us = 3U * SIM_US_PER_M, .first_us = 1000U },
+    } },
+};
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static uint32_t xorshift(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/* Ping_Jitter() of main.c */
+static uint32_t ping_jitter(uint32_t *rng, uint32_t *last)
+{
+    uint32_t offset;
+
+    do {
+        offset = xorshift(rng) % (APP_PING_JITTER_US + 1U);
+    } while ((offset > *last ? offset - *last : *last - offset) < APP_PING_JITTER_STEP_US);
+
+    *last = offset;
+    return offset;
+}
+
+/* The end of the echo wait -> the next ping, as Measure_Echo() */
+static uint64_t next_ping(uint64_t ping_us, uint64_t done_us, bool jitter, uint32_t *rng, uint32_t *last)
+{
+    uint64_t next = ping_us + SIM_INTERVAL_US;
+
+    if (!jitter) {
+        return (done_us > next) ? done_us : next;
+    }
+    return ((done_us > next) ? done_us : next) + ping_jitter(rng, last);
+}
+
+/* First foreign burst reaching us in (from, to), or `to` */
+static uint64_t first_arrival(emitter_t *emitters, uint32_t count, uint64_t from, uint64_t to)
+{
+    uint64_t first = to;
+
+    for (uint32_t i = 0; i < count; i++) {
+        emitter_t *e = &emitters[i];
+
+        /* Pings that cannot reach the window any more */
+        while (e->next_us + e->delay_us <= from) {
+            uint64_t done = e->next_us + SIM_RISE_US + e->echo_us + SIM_DONE_US;
+            e->next_us = (e->kind == EMITTER_STEADY)
+                             ? e->next_us + e->period_us
+                             : next_ping(e->next_us, done, e->jitter, &e->rng, &e->offset_us);
+        }
+        if (e->next_us + e->delay_us < first) {
+            first = e->next_us + e->delay_us;
+        }
+    }
+    return first;
+}
+
+/* Our target's echo at time t */
+static uint32_t target_us(const scenario_t *s, uint64_t t)
+{
+    uint64_t span   = s->echo_us / 2U;
+    uint64_t travel = t * s->speed_cm_s * (2U * SIM_US_PER_M) / 100000000U;
+
+    if (s->speed_cm_s == 0U) {
+        return s->echo_us;
+    }
+    travel %= 2U * span;
+    return s->echo_us - (uint32_t)((travel < span) ? travel : 2U * span - travel);
+}
+
+static void run(const scenario_t *s, bool jitter, sim_result_t *r)
+{
+    emitter_t emitters[SIM_EMITTERS_MAX];
+    hcsr04_echo_stats_t before, after;
+    uint32_t rng = seed, last = 0U;
+    uint64_t t = 0U;
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        emitters[i] = s->emitters[i];
+        emitters[i].jitter = jitter;
+        emitters[i].next_us = emitters[i].first_us;
+        emitters[i].rng = seed * (i + 2U) + 0x9E3779B9U;
+        emitters[i].offset_us = 0U;
+    }
+    *r = (sim_result_t){ 0 };
+    HCSR04_SetConfirm(jitter);
+    HCSR04_GetEchoStats(&before);
+
+    for (uint32_t ping = 0; ping < SIM_PINGS; ping++) {
+        uint32_t target = target_us(s, t);
+        uint32_t width  = target - SIM_NOISE_US / 2U + xorshift(&rng) % (SIM_NOISE_US + 1U);
+        uint64_t rise = t + SIM_RISE_US;
+        uint64_t fall = first_arrival(emitters, s->count, rise, rise + width);
+        hcsr04_result_t result;
+
+        HCSR04_SetPingOffset(jitter ? last : 0U);
+        timer_tick_t trigger_us = HCSR04_Trigger();
+        HCSR04_EchoEdge(trigger_us + SIM_RISE_US, GPIO_PIN_SET);
+        HCSR04_EchoEdge(trigger_us + SIM_RISE_US + (timer_tick_t)(fall - rise), GPIO_PIN_RESET);
+
+        /* Decided at the fall, unless the pulse was too short to be an echo */
+        uint64_t done = fall + SIM_DONE_US;
+        if (!HCSR04_PollEcho(&result, false)) {
+            CHECK(HCSR04_PollEcho(&result, true));
+            done = t + HS_SR04_ECHO_TIMEOUT_US;
+        }
+        if (result.echo_us != 0U) {
+            uint32_t error = (result.echo_us > target) ? result.echo_us - target : target - result.echo_us;
+            if (error > SIM_GOOD_US) {
+                r->false_accepts++;
+            } else {
+                r->good++;
+            }
+        }
+        r->pings++;
+        t = next_ping(t, done, jitter, &rng, &last);
+    }
+
+    HCSR04_GetEchoStats(&after);
+    r->driver_false = after.false_accepts - before.false_accepts;
+    r->time_us = t;
+}
+
+static uint32_t rate_mhz(const sim_result_t *r)
+{
+    return (uint32_t)((uint64_t)r->good * 1000000000ULL / r->time_us);
+}
+
+static void print(const char *name, const char *mode, const sim_result_t *r)
+{
+    uint32_t rate = rate_mhz(r);
+
+    printf("  %-7s %-9s %5u pings  %5u good  %5u false  (driver %5u)  %4u.%u Hz\n", name, mode,
+           r->pings, r->good, r->false_accepts, r->driver_false, rate / 1000U, (rate % 1000U) / 100U);
+}
+
+static void test_scenarios(void)
+{
+    for (uint32_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const scenario_t *s = &scenarios[i];
+        sim_result_t plain, jittered;
+
+        run(s, false, &plain);
+        run(s, true, &jittered);
+        print(s->name, "plain", &plain);
+        print(s->name, "jitter", &jittered);
+
+        if ((s->count == 0U) && (s->speed_cm_s == 0U)) {
+            CHECK(plain.false_accepts == 0U && jittered.false_accepts == 0U);
+            CHECK(plain.good == plain.pings);
+            CHECK(jittered.good + HS_SR04_AGREE_DEPTH >= jittered.pings);
+        }
+        CHECK(jittered.false_accepts * 1000U <= (jittered.good + jittered.false_accepts) * s->false_max_permille);
+        CHECK(rate_mhz(&jittered) >= s->rate_min_hz * 1000U);
+    }
+}
+
+/* One ping of a still target, decided at once; true when accepted */
+static bool ping(uint32_t offset_us, uint32_t width, hcsr04_result_t *result)
+{
+    HCSR04_SetPingOffset(offset_us);
+    timer_tick_t trigger_us = HCSR04_Trigger();
+    HCSR04_EchoEdge(trigger_us + SIM_RISE_US, GPIO_PIN_SET);
+    HCSR04_EchoEdge(trigger_us + SIM_RISE_US + width, GPIO_PIN_RESET);
+    CHECK(HCSR04_PollEcho(result, true));
+    return result->echo_us != 0U;
+}
+
+/* A foreign burst at a fixed time after our trigger cuts every echo of one
+ * ping offset to the same width: never accepted, however often it comes */
+static void test_same_offset(void)
+{
+    hcsr04_result_t result;
+    uint32_t rng = seed, last = 0U;
+
+    HCSR04_SetConfirm(true);
+    for (uint32_t i = 0; i < 4U * HS_SR04_AGREE_DEPTH; i++) {
+        uint32_t offset = ping_jitter(&rng, &last);
+
+        if (ping(offset, 5830U, &result)) {
+            CHECK(result.echo_us == 5830U);
+        }
+        if (ping(1000U, 2915U + i % SIM_NOISE_US, &result)) {
+            CHECK(result.echo_us == 5830U);              // Never the cut width
+        }
+    }
+}
+
+/* A step in distance at jittered offsets: taken once enough pings at other
+ * offsets agree with it, within the history, then every ping. Nothing but
+ * the new distance in between. */
+static void test_step(void)
+{
+    hcsr04_result_t result;
+    uint32_t rng = seed, last = 0U;
+    uint32_t widths[] = { 4080U, 2915U, 8750U };
+
+    HCSR04_SetConfirm(true);
+    for (uint32_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        uint32_t first = 0U;
+
+        for (uint32_t i = 0; i < 2U * HS_SR04_AGREE_DEPTH; i++) {
+            if (ping(ping_jitter(&rng, &last), widths[w], &result)) {
+                CHECK(result.echo_us == widths[w]);
+                first = (first == 0U) ? i + 1U : first;
+            } else {
+                CHECK(result.reason == HCSR04_REASON_UNCONFIRMED);
+                CHECK(i < HS_SR04_AGREE_DEPTH);
+            }
+        }
+        CHECK(first > HS_SR04_AGREE_VOTES && first <= HS_SR04_AGREE_DEPTH);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1U;
+    if (seed == 0U) {
+        seed = 1U;
+    }
+    host_tim_reset(1U, 79U, seed);
+    host_tim.irq_handler = timebase_irq_handler;
+    timebase_init();
+
+    RUN(test_scenarios());
+    RUN(test_same_offset());
+    RUN(test_step());
+
+    return hosttest_report();
+}
@@ -0,0 +1,458 @@
+/**
+ * @file    test_i2c_bus.c
+ * @brief   Parking-Sensor project.
+ * @details Host tests of the I2C transaction manager (Core/I2cBus) on the
+ *          I2C stand-in of host_i2c.c: submit checks, the priority
+ *          queues, chunking with the register address advancing and a
+ *          more urgent transfer taking the bus between two chunks,
+ *          cancel in every state, the blocking calls and wait_idle with
+ *          and without a stalled bus, errors, the statistics, the IT and
+ *          DMA paths and several buses side by side.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <string.h>
+#include "i2c_bus.h"
+#include "host_hal.h"
+#include "host_i2c.h"
+#include "hosttest.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define DEV_ADDR        (0x3C << 1)
+#define DEV2_ADDR       (0x50 << 1)
+#define ABSENT_ADDR     (0x20 << 1)
+#define ORDER_MAX       16U
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static I2C_TypeDef       regs2;
+static I2C_HandleTypeDef hbus;
+static I2C_HandleTypeDef hbus2;
+static DMA_HandleTypeDef hdma_tx;
+static DMA_HandleTypeDef hdma_rx;
+static i2c_bus_t bus;
+static i2c_bus_t bus2;
+static i2c_dev_t dev;
+static i2c_dev_t dev2;
+static i2c_dev_t absent;
+static i2c_dev_t dev3;
+
+static char     order[ORDER_MAX + 1U];   /**< Tags of the finished transfers */
+static uint32_t order_count;
+static uint32_t bus_errors;
+static uint32_t last_error;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void i2c_bus_on_error(i2c_bus_t *b, uint32_t error)
+{
+    if (b == &bus) {
+        bus_errors++;
+        last_error = error;
+    }
+}
+
+static void xfer_done(i2c_xfer_t *xfer)
+{
+    if (order_count < ORDER_MAX) {
+        order[order_count++] = *(const char *)xfer->context;
+        order[order_count] = '\0';
+    }
+}
+
+static void handle_init(I2C_HandleTypeDef *hi2c, I2C_TypeDef *instance)
+{
+    memset(hi2c, 0, sizeof(*hi2c));
+    hi2c->Instance = instance;
+    (void)HAL_I2C_Init(hi2c);
+}
+
+/* One bus on the IT path (no DMA channels linked), or on DMA. Interrupts
+ * stay off: transfers complete only from host_i2c_step(), so a test sees
+ * the queues between any two completions. */
+static void start(bool dma)
+{
+    host_i2c_reset();
+    __disable_irq();
+    handle_init(&hbus, I2C2);
+    if (dma) {
+        __HAL_LINKDMA(&hbus, hdmatx, hdma_tx);
+        __HAL_LINKDMA(&hbus, hdmarx, hdma_rx);
+    }
+    i2c_bus_init(&bus, &hbus);
+    host_i2c_add_device(DEV_ADDR);
+    host_i2c_add_device(DEV2_ADDR);
+    i2c_dev_init(&dev, &bus, DEV_ADDR, "dev");
+    i2c_dev_init(&dev2, &bus, DEV2_ADDR, "dev2");
+    i2c_dev_init(&absent, &bus, ABSENT_ADDR, "absent");
+    i2c_dev_clear_stats(&dev);
+    i2c_dev_clear_stats(&dev2);
+    i2c_dev_clear_stats(&absent);
+
+    order_count = 0U;
+    order[0] = '\0';
+    bus_errors = 0U;
+    last_error = 0U;
+}
+
+static i2c_xfer_t xfer_make(i2c_dev_t *d, i2c_xfer_dir_t dir, i2c_prio_t prio, const char *tag,
+                            uint8_t *data, uint16_t size)
+{
+    return (i2c_xfer_t){
+        .dev = d, .dir = dir, .prio = prio, .reg_size = 1, .reg = 0x00,
+        .data = data, .size = size, .done = xfer_done, .context = (void *)tag,
+    };
+}
+
+/* Malformed descriptors are refused, a queued one cannot go in twice */
+static void test_submit_checks(void)
+{
+    uint8_t data[4] = { 0 };
+    i2c_xfer_t x = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "a", data, 0);
+
+    start(false);
+    CHECK(i2c_bus_submit(&x) == HAL_ERROR);
+    x.size = sizeof(data);
+    x.data = NULL;
+    CHECK(i2c_bus_submit(&x) == HAL_ERROR);
+    x.data = data;
+    x.prio = I2C_PRIO_COUNT;
+    CHECK(i2c_bus_submit(&x) == HAL_ERROR);
+    CHECK(host_i2c.log_count == 0U && order_count == 0U);
+
+    x.prio = I2C_PRIO_NORMAL;
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    CHECK(x.state == I2C_XFER_QUEUED && bus.active == &x);
+    CHECK(i2c_bus_submit(&x) == HAL_BUSY);
+    CHECK(host_i2c_run(&hbus) == 1U);
+    CHECK(x.state == I2C_XFER_IDLE && x.status == HAL_OK);
+    CHECK(strcmp(order, "a") == 0);
+}
+
+/* Behind the transfer on the bus: most urgent first, FIFO within a level */
+static void test_priority_order(void)
+{
+    uint8_t data[6][2];
+    static const char tags[] = "xabcde";
+    i2c_xfer_t x[6];
+
+    start(false);
+    x[0] = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, &tags[0], data[0], 2);
+    x[1] = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, &tags[1], data[1], 2);
+    x[2] = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, &tags[2], data[2], 2);
+    x[3] = xfer_make(&dev2, I2C_XFER_READ, I2C_PRIO_HIGH, &tags[3], data[3], 2);
+    x[4] = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, &tags[4], data[4], 2);
+    x[5] = xfer_make(&dev2, I2C_XFER_READ, I2C_PRIO_HIGH, &tags[5], data[5], 2);
+    for (uint32_t i = 0; i < 6U; i++) {
+        CHECK(i2c_bus_submit(&x[i]) == HAL_OK);
+    }
+    CHECK(bus.active == &x[0]);
+    CHECK(i2c_bus_busy(&bus));
+
+    CHECK(host_i2c_run(&hbus) == 6U);
+    CHECK(strcmp(order, "xcebda") == 0);
+    CHECK(!i2c_bus_busy(&bus));
+    CHECK(bus.preemptions == 0U);
+}
+
+/* Chunks of an auto-incrementing write land one after the other; a sensor
+ * read submitted while a chunk is on the bus goes next, then the push
+ * resumes where it stopped */
+static void test_chunk_preemption(void)
+{
+    uint8_t frame[200];
+    uint8_t sample[2];
+    i2c_xfer_t push = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, "p", frame, sizeof(frame));
+    i2c_xfer_t read = xfer_make(&dev2, I2C_XFER_READ, I2C_PRIO_HIGH, "r", sample, sizeof(sample));
+
+    start(true);
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)(i ^ 0x5AU);
+    }
+    host_i2c.devices[1].mem[0x00] = 0x12;
+    host_i2c.devices[1].mem[0x01] = 0x34;
+    push.reg = 0x10;
+    push.chunk = 64;
+    push.flags = I2C_XFER_REG_INCREMENT;
+
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(host_i2c_step(&hbus));                       // Chunk 1 done, chunk 2 on the bus
+    CHECK(push.offset == 64U && bus.active == &push);
+    CHECK(i2c_bus_submit(&read) == HAL_OK);
+    CHECK(host_i2c_step(&hbus));                       // Chunk 2 done, the read overtakes
+    CHECK(bus.active == &read && bus.resume == NULL);
+    CHECK(bus.preemptions == 1U);
+    CHECK(host_i2c_run(&hbus) == 3U);
+
+    CHECK(strcmp(order, "rp") == 0);
+    CHECK(push.status == HAL_OK && push.offset == sizeof(frame));
+    CHECK(read.status == HAL_OK && sample[0] == 0x12 && sample[1] == 0x34);
+    CHECK(memcmp(&host_i2c.devices[0].mem[0x10], frame, sizeof(frame)) == 0);
+
+    static const uint16_t regs[] = { 0x10, 0x50, 0x00, 0x90, 0xD0 };
+    static const uint16_t sizes[] = { 64, 64, 2, 64, 8 };
+    CHECK(host_i2c.log_count == 5U);
+    for (uint32_t i = 0; i < 5U; i++) {
+        CHECK(host_i2c.log[i].reg == regs[i]);
+        CHECK(host_i2c.log[i].size == sizes[i]);
+        CHECK(host_i2c.log[i].dma);
+    }
+    CHECK(dev.stats.bytes == sizeof(frame) && dev.stats.xfers == 1U);
+}
+
+/* Without the increment flag every chunk goes to the same register (a
+ * data stream such as the SSD1306 GDDRAM control byte) */
+static void test_chunk_same_reg(void)
+{
+    uint8_t data[10];
+    i2c_xfer_t x = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, "s", data, sizeof(data));
+
+    start(true);
+    x.reg = 0x40;
+    x.chunk = 4;
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    CHECK(host_i2c_run(&hbus) == 3U);
+    CHECK(host_i2c.log_count == 3U);
+    CHECK(host_i2c.log[0].reg == 0x40 && host_i2c.log[1].reg == 0x40 && host_i2c.log[2].reg == 0x40);
+    CHECK(host_i2c.log[2].size == 2U);
+    CHECK(x.status == HAL_OK && strcmp(order, "s") == 0);
+}
+
+/* Cancel: a queued transfer and one between chunks leave without their
+ * callback, the one on the bus cannot */
+static void test_cancel(void)
+{
+    uint8_t frame[96], data[2];
+    i2c_xfer_t push = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, "p", frame, sizeof(frame));
+    i2c_xfer_t cmd = xfer_make(&dev2, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "c", data, sizeof(data));
+    i2c_xfer_t high = xfer_make(&dev2, I2C_XFER_READ, I2C_PRIO_HIGH, "h", data, sizeof(data));
+
+    start(true);
+    push.chunk = 32;
+    CHECK(i2c_bus_cancel(&push));                      // Idle: nothing to do
+    CHECK(dev.stats.errors == 0U);
+
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(i2c_bus_submit(&cmd) == HAL_OK);
+    CHECK(!i2c_bus_cancel(&push));                     // On the bus
+    CHECK(i2c_bus_cancel(&cmd));
+    CHECK(cmd.state == I2C_XFER_IDLE && cmd.status == HAL_ERROR);
+    CHECK(dev2.stats.errors == 1U);
+
+    CHECK(i2c_bus_submit(&high) == HAL_OK);
+    CHECK(host_i2c_step(&hbus));                       // Push paused, the read on the bus
+    CHECK(bus.active == &high && push.state == I2C_XFER_QUEUED && push.offset == 32U);
+    CHECK(i2c_bus_cancel(&push));
+    CHECK(host_i2c_run(&hbus) == 1U);
+
+    CHECK(strcmp(order, "h") == 0);
+    CHECK(push.status == HAL_ERROR && push.offset == 32U);
+    CHECK(host_i2c.log_count == 2U);
+    CHECK(!i2c_bus_busy(&bus));
+}
+
+/* The blocking calls complete from the tick hook (the I2C interrupt while
+ * the caller polls); wait_idle gives up on a stalled bus */
+static void test_blocking(void)
+{
+    uint8_t out[3] = { 0xDE, 0xAD, 0x01 };
+    uint8_t in[3] = { 0 };
+    uint8_t frame[64];
+    i2c_xfer_t push = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, "p", frame, sizeof(frame));
+
+    start(false);
+    __set_PRIMASK(0U);
+    CHECK(i2c_dev_write(&dev2, 0x80, 1, out, sizeof(out), 10U) == HAL_OK);
+    CHECK(i2c_dev_read(&dev2, 0x80, 1, in, sizeof(in), 10U) == HAL_OK);
+    CHECK(memcmp(in, out, sizeof(out)) == 0);
+    CHECK(host_i2c.log_count == 2U && !host_i2c.log[0].read && host_i2c.log[1].read);
+
+    push.chunk = 16;
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(i2c_bus_wait_idle(&bus, 100U));
+    CHECK(push.status == HAL_OK);
+
+    host_i2c.stall = true;
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    uint32_t t0 = host_tick_ms;
+    CHECK(!i2c_bus_wait_idle(&bus, 20U));
+    CHECK(host_tick_ms - t0 >= 20U && host_tick_ms - t0 <= 22U);
+    CHECK(push.state == I2C_XFER_QUEUED);
+    CHECK(bus_errors == 0U);                           // Waiting is not an error
+
+    CHECK(i2c_dev_read(&dev2, 0x80, 1, in, sizeof(in), 5U) == HAL_TIMEOUT);
+    CHECK(bus_errors == 1U && last_error == HAL_I2C_ERROR_TIMEOUT);
+    host_i2c.stall = false;
+    CHECK(i2c_bus_wait_idle(&bus, 100U));
+    CHECK(push.status == HAL_OK);
+}
+
+/* A silent slave and an injected fault fail their transfer, report the
+ * error and leave the queue running */
+static void test_errors(void)
+{
+    uint8_t data[4] = { 1, 2, 3, 4 };
+    i2c_xfer_t a = xfer_make(&absent, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "a", data, sizeof(data));
+    i2c_xfer_t b = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "b", data, sizeof(data));
+    i2c_xfer_t c = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "c", data, sizeof(data));
+
+    start(true);
+    host_i2c_fail(2U, HAL_I2C_ERROR_OVR);
+    CHECK(i2c_bus_submit(&a) == HAL_OK);
+    CHECK(i2c_bus_submit(&b) == HAL_OK);
+    CHECK(i2c_bus_submit(&c) == HAL_OK);
+    CHECK(host_i2c_run(&hbus) == 3U);
+
+    CHECK(strcmp(order, "abc") == 0);
+    CHECK(a.status == HAL_ERROR && b.status == HAL_OK && c.status == HAL_ERROR);
+    CHECK(host_i2c.log[0].error == HAL_I2C_ERROR_AF);
+    CHECK(host_i2c.log[2].error == HAL_I2C_ERROR_OVR);
+    CHECK(bus_errors == 2U && last_error == HAL_I2C_ERROR_OVR);
+    CHECK(absent.stats.errors == 1U && dev.stats.errors == 1U && dev.stats.xfers == 1U);
+    CHECK(dev.stats.bytes == sizeof(data));
+
+    /* A transfer the HAL refuses to start fails from submit and the next
+     * one is tried */
+    hbus.State = 0U;
+    CHECK(i2c_bus_submit(&b) == HAL_OK);
+    CHECK(b.status == HAL_ERROR && b.state == I2C_XFER_IDLE);
+    CHECK(strcmp(order, "abcb") == 0);
+    CHECK(!i2c_bus_busy(&bus));
+    hbus.State = 1U;
+}
+
+/* Bus time and queueing delay per device; a re-init keeps the numbers */
+static void test_stats(void)
+{
+    uint8_t frame[64], data[2];
+    i2c_xfer_t push = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_BULK, "p", frame, sizeof(frame));
+    i2c_xfer_t read = xfer_make(&dev2, I2C_XFER_READ, I2C_PRIO_HIGH, "r", data, sizeof(data));
+    i2c_dev_stats_t s;
+
+    start(true);
+    push.chunk = 16;
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(i2c_bus_submit(&read) == HAL_OK);
+    host_tick_ms += 3U;                                // The first chunk takes 3 ms
+    CHECK(host_i2c_run(&hbus) == 5U);
+
+    i2c_dev_get_stats(&dev, &s);
+    CHECK(s.xfers == 1U && s.errors == 0U && s.bytes == sizeof(frame));
+    CHECK(s.busy_us >= 3000U);
+    CHECK(s.wait_max_us < 3000U);                      // The bus was free
+    i2c_dev_get_stats(&dev2, &s);
+    CHECK(s.xfers == 1U && s.bytes == sizeof(data));
+    CHECK(s.wait_max_us >= 3000U);
+
+    i2c_dev_init(&dev, &bus, DEV_ADDR, "dev");
+    CHECK(dev.stats.xfers == 1U);
+    CHECK(bus.devices == &dev && dev.next == &dev2 && dev2.next == &absent && absent.next == NULL);
+    i2c_dev_clear_stats(&dev);
+    i2c_dev_get_stats(&dev, &s);
+    CHECK(s.xfers == 0U && s.bytes == 0U && s.busy_us == 0U && s.wait_max_us == 0U);
+}
+
+/* The HAL call each descriptor maps to */
+static void test_paths(void)
+{
+    uint8_t data[4] = { 0x07, 0xAA, 0xBB, 0xCC };
+    uint8_t in[3] = { 0 };
+    i2c_xfer_t x;
+
+    start(false);
+    x = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "w", data, sizeof(data));
+    x.reg_size = 0;                                    // Plain write: pointer + data
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    host_i2c_run(&hbus);
+    x = xfer_make(&dev, I2C_XFER_READ, I2C_PRIO_NORMAL, "r", in, sizeof(in));
+    x.reg_size = 0;                                    // Plain read from the pointer
+    host_i2c.devices[0].pointer = 0x07;
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    host_i2c_run(&hbus);
+    CHECK(memcmp(in, &data[1], sizeof(in)) == 0);
+    x = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "m", data, sizeof(data));
+    x.reg_size = 2;
+    x.reg = 0x0100;
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    host_i2c_run(&hbus);
+
+    CHECK(host_i2c.log_count == 3U);
+    CHECK(host_i2c.log[0].reg_size == 0U && !host_i2c.log[0].dma && !host_i2c.log[0].read);
+    CHECK(host_i2c.log[1].reg_size == 0U && !host_i2c.log[1].dma && host_i2c.log[1].read);
+    CHECK(host_i2c.log[2].reg_size == I2C_MEMADD_SIZE_16BIT && host_i2c.log[2].reg == 0x0100);
+
+    /* DMA for writes only when the TX channel is linked, for reads the RX one */
+    start(false);
+    __HAL_LINKDMA(&hbus, hdmatx, hdma_tx);
+    x = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "w", data, sizeof(data));
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    host_i2c_run(&hbus);
+    x = xfer_make(&dev, I2C_XFER_READ, I2C_PRIO_NORMAL, "r", in, sizeof(in));
+    CHECK(i2c_bus_submit(&x) == HAL_OK);
+    host_i2c_run(&hbus);
+    CHECK(host_i2c.log_count == 2U);
+    CHECK(host_i2c.log[0].dma && host_i2c.log[0].reg_size == I2C_MEMADD_SIZE_8BIT);
+    CHECK(!host_i2c.log[1].dma);
+}
+
+/* Two buses keep their own queues; completions of a handle without a
+ * manager and late ones after an abort are ignored */
+static void test_buses(void)
+{
+    uint8_t a_data[2], b_data[2];
+    i2c_xfer_t a = xfer_make(&dev, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "a", a_data, sizeof(a_data));
+    i2c_xfer_t b = xfer_make(&dev3, I2C_XFER_WRITE, I2C_PRIO_NORMAL, "b", b_data, sizeof(b_data));
+    I2C_HandleTypeDef stray;
+
+    start(true);
+    handle_init(&hbus2, &regs2);
+    i2c_bus_init(&bus2, &hbus2);
+    i2c_bus_init(&bus2, &hbus2);                       // Again: still listed once
+    i2c_dev_init(&dev3, &bus2, DEV2_ADDR, "dev3");
+    CHECK(i2c_bus_find(&hbus) == &bus && i2c_bus_find(&hbus2) == &bus2);
+
+    CHECK(i2c_bus_submit(&a) == HAL_OK);
+    CHECK(i2c_bus_submit(&b) == HAL_OK);
+    CHECK(bus.active == &a && bus2.active == &b);
+    CHECK(host_i2c_run(&hbus2) == 1U);
+    CHECK(strcmp(order, "b") == 0 && bus.active == &a);
+    CHECK(host_i2c_run(&hbus) == 1U);
+    CHECK(strcmp(order, "ba") == 0);
+
+    memset(&stray, 0, sizeof(stray));
+    CHECK(i2c_bus_find(&stray) == NULL);
+    HAL_I2C_MemTxCpltCallback(&stray);
+    HAL_I2C_ErrorCallback(&stray);
+
+    CHECK(i2c_bus_submit(&a) == HAL_OK);
+    i2c_bus_abort(&bus);
+    CHECK(host_i2c.dma_aborts == 1U && a.status == HAL_ERROR);
+    HAL_I2C_MemTxCpltCallback(&hbus);
+    CHECK(strcmp(order, "ba") == 0 && !i2c_bus_busy(&bus));
+    CHECK(bus2.devices == &dev3 && dev3.next == NULL);
+}
+
+int main(void)
+{
+    RUN(test_submit_checks());
+    RUN(test_priority_order());
+    RUN(test_chunk_preemption());
+    RUN(test_chunk_same_reg());
+    RUN(test_cancel());
+    RUN(test_blocking());
+    RUN(test_errors());
+    RUN(test_stats());
+    RUN(test_paths());
+    RUN(test_buses());
+
+    return hosttest_report();
+}
@@ -0,0 +1,363 @@
+/**
+ * @file    test_i2c_recovery.c
+ * @brief   Parking-Sensor project.
+ * @details Host fault-injection tests of the I2C2 error path: i2c.c and
+ *          the bus manager (Core/I2cBus) on the I2C stand-in of
+ *          host_i2c.c. Which errors MX_I2C2_ReportError() counts and which
+ *          ask for a recovery; MX_I2C2_Recover() against a slave holding
+ *          SDA for 0 to 11 bits or for good (clock pulses, their length,
+ *          the STOP, the result, the peripheral set up again with its
+ *          speed profile); and faults in the middle of chunked and
+ *          blocking transfers, recovered the way Display_Service() does,
+ *          after which the bus has to work again.
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <string.h>
+#include "i2c.h"
+#include "i2c_bus.h"
+#include "host_i2c.h"
+#include "hosttest.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define DEV_ADDR           (0x3C << 1)
+#define DEV2_ADDR          (0x3D << 1)
+#define FRAME_SIZE         512U
+#define FRAME_CHUNK        128U
+#define HALF_BIT_CYCLES    (80U * 5U)    /**< I2C2_RECOVERY_HALF_US at 80 MHz */
+#define SCL_PIN_BIT        13U
+#define SDA_PIN_BIT        14U
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+I2C_HandleTypeDef hi2c2;
+DMA_HandleTypeDef hdma_i2c2_tx;
+
+static i2c_bus_t i2c2_bus;
+static i2c_dev_t panel;
+static i2c_dev_t panel2;
+static uint32_t  error_handler_calls;
+static uint32_t  done_calls;
+static uint8_t   frame[FRAME_SIZE];
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+void Error_Handler(void)
+{
+    error_handler_calls++;
+}
+
+/* As main.c: failed transfers and bus wait timeouts of I2C2 */
+void i2c_bus_on_error(i2c_bus_t *bus, uint32_t error)
+{
+    if (bus == &i2c2_bus) {
+        MX_I2C2_ReportError(error);
+    }
+}
+
+/* As Display_Service() */
+static HAL_StatusTypeDef recover(void)
+{
+    i2c_bus_abort(&i2c2_bus);
+    return MX_I2C2_Recover();
+}
+
+static void xfer_done(i2c_xfer_t *xfer)
+{
+    (void)xfer;
+    done_calls++;
+}
+
+static void start(void)
+{
+    host_i2c_reset();
+    memset(&hi2c2, 0, sizeof(hi2c2));
+    memset(&hdma_i2c2_tx, 0, sizeof(hdma_i2c2_tx));
+    MX_I2C2_Init();
+    i2c_bus_init(&i2c2_bus, &hi2c2);
+    host_i2c_add_device(DEV_ADDR);
+    host_i2c_add_device(DEV2_ADDR);
+    i2c_dev_init(&panel, &i2c2_bus, DEV_ADDR, "panel");
+    i2c_dev_init(&panel2, &i2c2_bus, DEV2_ADDR, "panel2");
+    i2c_dev_clear_stats(&panel);
+    i2c_dev_clear_stats(&panel2);
+    done_calls = 0U;
+    for (uint32_t i = 0; i < FRAME_SIZE; i++) {
+        frame[i] = (uint8_t)(i * 7U + 1U);
+    }
+}
+
+static i2c_bus_stats_t stats(void)
+{
+    i2c_bus_stats_t s;
+
+    MX_I2C2_GetStats(&s);
+    return s;
+}
+
+static uint32_t pin_mode(uint32_t bit)
+{
+    return (host_gpiob.MODER >> (2U * bit)) & 3U;
+}
+
+/* The peripheral is back as MX_I2C2_Init leaves it */
+static void check_reinit(uint32_t inits_before, i2c_speed_t speed)
+{
+    CHECK(host_i2c.inits == inits_before + 1U);
+    CHECK(hi2c2.State == 1U);
+    CHECK(hi2c2.hdmatx == &hdma_i2c2_tx);
+    CHECK(pin_mode(SCL_PIN_BIT) == (GPIO_MODE_AF_OD & 3U));
+    CHECK(pin_mode(SDA_PIN_BIT) == (GPIO_MODE_AF_OD & 3U));
+    CHECK(hi2c2.Instance->TIMINGR == (I2C_ComputeTiming(HSI_VALUE, I2C_SpeedHz(speed)) & 0xF0FFFFFFU));
+    CHECK(host_i2c.fast_mode_plus == (speed == I2C_SPEED_FAST_PLUS));
+    CHECK(!MX_I2C2_RecoveryPending());
+}
+
+/* Only errors that can leave the bus stuck ask for a recovery; a NACK or
+ * an overrun only counts */
+static void test_report_error(void)
+{
+    static const struct {
+        uint32_t code;
+        bool     recover;
+    } cases[] = {
+        { HAL_I2C_ERROR_AF,                        false },
+        { HAL_I2C_ERROR_OVR,                       false },
+        { HAL_I2C_ERROR_BERR,                      true  },
+        { HAL_I2C_ERROR_ARLO,                      true  },
+        { HAL_I2C_ERROR_DMA,                       true  },
+        { HAL_I2C_ERROR_TIMEOUT,                   true  },
+        { HAL_I2C_ERROR_AF | HAL_I2C_ERROR_BERR,   true  },
+    };
+
+    start();
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        i2c_bus_stats_t before = stats();
+
+        MX_I2C2_ReportError(cases[i].code);
+        i2c_bus_stats_t after = stats();
+        CHECK(after.errors == before.errors + 1U);
+        CHECK(after.timeouts == before.timeouts + ((cases[i].code & HAL_I2C_ERROR_TIMEOUT) ? 1U : 0U));
+        CHECK(MX_I2C2_RecoveryPending() == (cases[i].recover ? 1U : 0U));
+        if (MX_I2C2_RecoveryPending()) {
+            CHECK(recover() == HAL_OK);
+            CHECK(stats().recoveries == after.recoveries + 1U);
+        }
+    }
+
+    MX_I2C2_InjectFault();
+    CHECK(MX_I2C2_RecoveryPending());
+    CHECK(recover() == HAL_OK);
+    CHECK(error_handler_calls == 0U);
+}
+
+/* Count the clock pulses and check the bit timing and the STOP */
+static void check_lines(uint32_t pulses, bool stop)
+{
+    uint32_t rising = 0;
+
+    for (uint32_t i = 1; i < host_i2c.line_count; i++) {
+        const host_i2c_line_t *prev = &host_i2c.lines[i - 1U];
+        const host_i2c_line_t *line = &host_i2c.lines[i];
+
+        CHECK(line->cycles - prev->cycles >= HALF_BIT_CYCLES);
+        if (!prev->scl && line->scl) {
+            rising++;
+        }
+        /* SDA may only change while SCL is low, except for the STOP */
+        if (prev->scl && line->scl && prev->sda != line->sda) {
+            CHECK(line->sda && i == host_i2c.line_count - 1U);
+        }
+    }
+    CHECK(rising == pulses + 1U);                        // The STOP's own clock
+
+    const host_i2c_line_t *last = &host_i2c.lines[host_i2c.line_count - 1U];
+    CHECK(last->scl);
+    CHECK(last->sda == stop);
+}
+
+/* A slave cut off in the middle of a byte holds SDA for up to 9 bits; one
+ * more clock comes with the STOP. Longer than that, the recovery fails. */
+static void test_recover_stuck_sda(void)
+{
+    static const uint32_t holds[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, HOST_I2C_HOLD_FOREVER };
+
+    for (uint32_t i = 0; i < sizeof(holds) / sizeof(holds[0]); i++) {
+        uint32_t hold = holds[i];
+        bool freed = (hold <= 10U);
+
+        start();
+        uint32_t inits = host_i2c.inits;
+        uint32_t resets = host_i2c_resets;
+        i2c_bus_stats_t before = stats();
+
+        host_i2c_hold_sda(hold);
+        host_i2c.line_count = 0U;
+        MX_I2C2_ReportError(HAL_I2C_ERROR_BERR);
+        CHECK(recover() == (freed ? HAL_OK : HAL_ERROR));
+
+        i2c_bus_stats_t after = stats();
+        CHECK(after.recoveries == before.recoveries + 1U);
+        CHECK(after.stuck == before.stuck + ((hold != 0U) ? 1U : 0U));
+        CHECK(host_i2c_resets == resets + 1U);
+        check_lines((hold < 9U) ? hold : 9U, freed);
+        check_reinit(inits, I2C2_SPEED_DEFAULT);
+    }
+}
+
+/* The speed profile survives the recovery */
+static void test_recover_keeps_speed(void)
+{
+    start();
+    CHECK(MX_I2C2_SetSpeed(I2C_SPEED_FAST_PLUS) == HAL_OK);
+    uint32_t inits = host_i2c.inits;
+    MX_I2C2_ReportError(HAL_I2C_ERROR_ARLO);
+    CHECK(recover() == HAL_OK);
+    check_reinit(inits, I2C_SPEED_FAST_PLUS);
+    CHECK(MX_I2C2_SetSpeed(I2C2_SPEED_DEFAULT) == HAL_OK);
+}
+
+static void frame_xfer(i2c_xfer_t *xfer, i2c_dev_t *dev)
+{
+    *xfer = (i2c_xfer_t){
+        .dev = dev, .dir = I2C_XFER_WRITE, .prio = I2C_PRIO_BULK, .reg_size = 1, .reg = 0x40,
+        .data = frame, .size = FRAME_SIZE, .chunk = FRAME_CHUNK, .done = xfer_done,
+    };
+}
+
+/* After a recovery a blocking write gets through again */
+static void check_bus_works(void)
+{
+    uint8_t data[4] = { 0xA5, 0x5A, 0x01, 0x02 };
+    host_i2c_dev_t *dev = &host_i2c.devices[0];
+
+    CHECK(i2c_dev_write(&panel, 0x10, 1, data, sizeof(data), 10U) == HAL_OK);
+    CHECK(memcmp(&dev->mem[0x10], data, sizeof(data)) == 0);
+    CHECK(!i2c_bus_busy(&i2c2_bus));
+}
+
+/* A bus error on the third chunk of a framebuffer push: the push fails
+ * once, the transfer queued behind it still runs, the recovery is asked
+ * for and brings the bus back */
+static void test_fault_mid_frame(uint32_t error, bool recovers)
+{
+    i2c_xfer_t push, next;
+
+    start();
+    frame_xfer(&push, &panel);
+    frame_xfer(&next, &panel2);
+    i2c_bus_stats_t before = stats();
+
+    host_i2c_fail(2U, error);
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(i2c_bus_submit(&next) == HAL_OK);
+    host_i2c_run(&hi2c2);
+
+    CHECK(push.state == I2C_XFER_IDLE && push.status == HAL_ERROR);
+    CHECK(push.offset == 2U * FRAME_CHUNK);
+    CHECK(next.state == I2C_XFER_IDLE && next.status == HAL_OK);
+    CHECK(done_calls == 2U);
+    CHECK(host_i2c.log_count == 3U + FRAME_SIZE / FRAME_CHUNK);
+    CHECK(host_i2c.log[2].error == error);
+    CHECK(panel.stats.errors == 1U && panel2.stats.xfers == 1U);
+    CHECK(stats().errors == before.errors + 1U);
+    CHECK(MX_I2C2_RecoveryPending() == (recovers ? 1U : 0U));
+
+    if (recovers) {
+        CHECK(recover() == HAL_OK);
+    }
+    check_bus_works();
+}
+
+/* A slave stretching the clock for good. A blocking write queued behind
+ * the stalled chunk is taken off the queue when it runs out of time; one
+ * that is on the bus itself has to abort it, and with it everything
+ * queued. Either way the timeout asks for a recovery and nothing
+ * completes late. */
+static void test_fault_stall(void)
+{
+    uint8_t data[2] = { 1, 2 };
+    i2c_xfer_t push;
+
+    start();
+    frame_xfer(&push, &panel2);
+    i2c_bus_stats_t before = stats();
+
+    host_i2c.stall = true;
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(i2c_dev_write(&panel, 0x00, 1, data, sizeof(data), 5U) == HAL_TIMEOUT);
+    CHECK(host_i2c.dma_aborts == 0U);
+    CHECK(push.state == I2C_XFER_QUEUED);
+    CHECK(panel.stats.errors == 1U);
+    CHECK(stats().timeouts == before.timeouts + 1U);
+    CHECK(MX_I2C2_RecoveryPending());
+
+    host_i2c.stall = false;
+    CHECK(recover() == HAL_OK);
+    CHECK(host_i2c.dma_aborts == 1U);
+    CHECK(push.state == I2C_XFER_IDLE && push.status == HAL_ERROR);
+    CHECK(host_i2c_run(&hi2c2) == 0U);
+    check_bus_works();
+
+    host_i2c.stall = true;
+    CHECK(i2c_dev_write(&panel, 0x00, 1, data, sizeof(data), 5U) == HAL_TIMEOUT);
+    CHECK(host_i2c.dma_aborts == 2U);
+    CHECK(!i2c_bus_busy(&i2c2_bus));
+    CHECK(stats().timeouts == before.timeouts + 2U);
+    CHECK(MX_I2C2_RecoveryPending());
+
+    host_i2c.stall = false;
+    CHECK(recover() == HAL_OK);
+    CHECK(done_calls == 0U);
+    check_bus_works();
+}
+
+/* The recovery while a chunk is on the bus (a fault reported by another
+ * path): the DMA is stopped, the queue emptied and the late completion of
+ * the dropped chunk never reaches the manager */
+static void test_recover_mid_frame(void)
+{
+    i2c_xfer_t push;
+
+    start();
+    frame_xfer(&push, &panel);
+    CHECK(i2c_bus_submit(&push) == HAL_OK);
+    CHECK(host_i2c_step(&hi2c2));
+    CHECK(hi2c2.host.busy);
+
+    MX_I2C2_ReportError(HAL_I2C_ERROR_TIMEOUT);
+    CHECK(recover() == HAL_OK);
+    CHECK(host_i2c.dropped >= 1U);
+    CHECK(push.state == I2C_XFER_IDLE && push.status == HAL_ERROR);
+    CHECK(done_calls == 0U);
+    CHECK(host_i2c_run(&hi2c2) == 0U);
+
+    /* A completion that raced with the abort is ignored */
+    HAL_I2C_MemTxCpltCallback(&hi2c2);
+    CHECK(!i2c_bus_busy(&i2c2_bus));
+    check_bus_works();
+}
+
+int main(void)
+{
+    RUN(test_report_error());
+    RUN(test_recover_stuck_sda());
+    RUN(test_recover_keeps_speed());
+    RUN(test_fault_mid_frame(HAL_I2C_ERROR_BERR, true));
+    RUN(test_fault_mid_frame(HAL_I2C_ERROR_ARLO, true));
+    RUN(test_fault_mid_frame(HAL_I2C_ERROR_AF, false));
+    RUN(test_fault_stall());
+    RUN(test_recover_mid_frame());
+
+    CHECK(error_handler_calls == 0U);
+    return hosttest_report();
+}
@@ -0,0 +1,176 @@
+/**
+ * @file    test_timebase.c
+ * @brief   Parking-Sensor project.
+ * @details Host tests of timebase.c on the counter model of host_tim.c:
+ *          reads around a wrap with the update flag raised before or
+ *          after the CNT read, wraps the handler has not served yet,
+ *          several wraps in a row, and clock switches through
+ *          timebase_switch_clock() against the model's true time. Each
+ *          case runs with random access timing and random preemption by
+ *          the update interrupt.
+ *
+ *          test_timebase [seed]
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "timebase.h"
+#include "hosttest.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define CLK_FULL_UNITS     1U        /**< 80 MHz */
+#define CLK_LOW_UNITS      5U        /**< 16 MHz */
+#define PSC_FULL           79U
+#define PSC_LOW            15U
+#define WRAP_TRIALS        2000U
+#define SWITCH_TRIALS      20000U
+#define SWITCH_ERROR_US    20        /**< Drift allowed after all switches */
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint32_t switch_units;            /**< Clock for switch_clock() */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static void switch_clock(void)
+{
+    host_tim.clk_units = switch_units;
+}
+
+static void start(uint32_t seed)
+{
+    host_tim_reset(CLK_FULL_UNITS, PSC_FULL, seed);
+    host_tim.irq_handler = timebase_irq_handler;
+    timebase_init();
+}
+
+/* Time of the timebase minus the model's, in us */
+static int64_t skew_us(void)
+{
+    timebase_us_t now = timebase_now_us();
+
+    return (int64_t)now - (int64_t)host_tim_true_us();
+}
+
+/* Move the counter to just before a wrap; the time jumps by the same */
+static int64_t near_wrap(uint32_t before)
+{
+    TIM2->CNT = 0xFFFFFFFFU - before;
+    return skew_us();
+}
+
+/* A read right at the wrap, with the flag raised before, between or
+ * after the reader's CNT accesses, from thread or handler level */
+static void test_wrap_read(void)
+{
+    for (uint32_t i = 0; i < WRAP_TRIALS; i++) {
+        start(i + 1U);
+        timebase_us_t prev = timebase_now_us();
+        int64_t skew = near_wrap(host_tim_random() % 4U);
+
+        /* Masked: the wrap stays pending like under a higher priority handler */
+        host_primask = (i & 1U);
+        for (uint32_t n = 0; n < 8U; n++) {
+            timebase_us_t now = timebase_now_us();
+            CHECK(now >= prev);
+            CHECK_EQ_I64((int64_t)now - (int64_t)host_tim_true_us(), skew, 1);
+            prev = now;
+        }
+        host_primask = 0U;
+        CHECK_EQ_I64(skew_us(), skew, 1);
+        uint32_t now32 = timebase_now32();
+        CHECK((uint32_t)timebase_now_us() - now32 <= 1U);
+    }
+}
+
+/* The flag stays raised: every reader adds the wrap, none adds it twice,
+ * and the handler counts it once when it finally runs */
+static void test_wrap_pending(void)
+{
+    start(7U);
+    int64_t skew = near_wrap(2U);
+
+    host_primask = 1U;
+    host_tim_run(1000U * PSC_FULL);
+    CHECK(TIM2->SR & TIM_SR_UIF);
+    CHECK_EQ_I64(skew_us(), skew, 1);
+    CHECK_EQ_I64(skew_us(), skew, 1);
+    host_primask = 0U;
+    host_tim_run(1U);
+    CHECK(host_tim.irqs == 1U);
+    CHECK_EQ_I64(skew_us(), skew, 1);
+}
+
+/* Whole counter periods back to back, the handler serving each wrap */
+static void test_wrap_repeated(void)
+{
+    start(11U);
+    int64_t skew = skew_us();
+
+    for (uint32_t n = 1; n <= 5U; n++) {
+        host_tim_run((1ULL << 32) * (PSC_FULL + 1U));
+        CHECK(host_tim.irqs == n);
+        CHECK(timebase_now_us() >> 32 == n);
+        CHECK_EQ_I64(skew_us(), skew, 1);
+    }
+}
+
+/* Profile switches at random points, some of them right at a wrap: the
+ * time may not jump, and the few cycles lost or gained at each switch
+ * must cancel out */
+static void test_switch(uint32_t seed)
+{
+    start(seed);
+    int64_t skew = skew_us();
+    timebase_us_t prev = timebase_now_us();
+    int64_t worst = 0;
+
+    for (uint32_t i = 0; i < SWITCH_TRIALS; i++) {
+        uint32_t r = host_tim_random();
+
+        if ((r % 64U) == 0U) {
+            skew = near_wrap(r % 40U);
+            prev = timebase_now_us();
+        }
+        host_tim_run(host_tim_random() % 4000U);
+
+        bool low = (host_tim.clk_units == CLK_FULL_UNITS);
+        switch_units = low ? CLK_LOW_UNITS : CLK_FULL_UNITS;
+        timebase_switch_clock(low ? PSC_LOW : PSC_FULL, switch_clock);
+
+        timebase_us_t now = timebase_now_us();
+        CHECK(now >= prev);
+        CHECK(TIM2->ARR == 0xFFFFFFFFU);
+        CHECK(timebase_now32() - (uint32_t)now <= 1U);
+        prev = now;
+
+        int64_t err = (int64_t)now - (int64_t)host_tim_true_us() - skew;
+        if (llabs(err) > worst) {
+            worst = llabs(err);
+        }
+    }
+    printf("  %u switches, worst skew %lld us\n", SWITCH_TRIALS, (long long)worst);
+    CHECK(worst <= SWITCH_ERROR_US);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1U;
+
+    RUN(test_wrap_read());
+    RUN(test_wrap_pending());
+    RUN(test_wrap_repeated());
+    RUN(test_switch(seed));
+
+    return hosttest_report();
+}
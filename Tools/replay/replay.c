@@ -0,0 +1,491 @@
+/**
+ * @file    replay.c
+ * @brief   Parking-Sensor project.
+ * @details Host replay of a raw ping trace ("trace dump" on the sensor's
+ *          UART). The recorded trigger times and echo edges go through the
+ *          firmware's own hcsr04.c and pipeline.c, built for the host with
+ *          the app_conf.h of the tree, so a change to the validation or the
+ *          decisions can be checked against field data before it is
+ *          flashed. Prints the decisions the sensor would take (buzzer zone,
+ *          tone, cadence, readout, BAY and STAT lines), the pings it decides
+ *          differently than the recorded run, and the time each stage takes.
+ *          Also simulates the end-to-end latency (latency.c) from the echo
+ *          edge to each output: the buzzer follows in the loop pass of the
+ *          decision (hardware cadence), a panel after its frame transfer.
+ *
+ *          replay [-v] [-r repeat] [-f frame_us] trace.log
+ *            -v  one line per ping
+ *            -r  run the trace this many times, for steadier timings
+ *            -f  modelled panel frame transfer, added to the panels' latency
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pipeline.h"
+#include "trace.h"
+#include "latency.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define REPLAY_LINE_LEN     128U
+
+typedef enum {
+    STAGE_VALIDATE = 0,                  /**< hcsr04.c: edges to a validated ping */
+    STAGE_FILTER,                        /**< pipeline_echo: calibration, hold, policy */
+    STAGE_STATS,
+    STAGE_OCCUPANCY,
+    STAGE_READOUT,
+    STAGE_COUNT
+} stage_t;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t ns;
+} stage_time_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+uint32_t     replay_now_us;              /**< Clock of the stub timebase.h */
+GPIO_TypeDef replay_gpioa;
+GPIO_TypeDef replay_gpiob;
+
+static const char *const stage_names[STAGE_COUNT] = {
+    "validate", "filter", "stats", "occupancy", "readout"
+};
+static const char *const reason_names[HCSR04_REASON_COUNT] = {
+    "ok", "to", "unp", "short", "long", "rise", "jump", "unconf", "edge"
+};
+static const char *const latency_names[LATENCY_OUT_COUNT] = {
+    "buzzer", "dash", "rear"
+};
+static const char *const zone_names[POLICY_ZONE_COUNT + 1U] = {
+#define ZONE_NAME(name, lower, upper, tone, near, far, style, arg) #name,
+    POLICY_ZONE_TABLE(ZONE_NAME, 0)
+#undef ZONE_NAME
+    "INVALID"
+};
+
+static trace_rec_t   *recs;
+static uint32_t       rec_count;
+static uint32_t       rec_lost;
+static calib_table_t  calib;
+static stage_time_t   stages[STAGE_COUNT];
+static uint64_t       timer_cost_ns;     /**< Of one measurement, subtracted */
+static bool           verbose;
+static uint32_t       frame_us;          /**< -f */
+static latency_channel_t latency[LATENCY_OUT_COUNT];       /**< LAT lines, as on the sensor */
+static stats_stream_t    latency_total[LATENCY_OUT_COUNT]; /**< Whole trace, for the summary */
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#define TIMED(stage, call) do {                     \
+        uint64_t t0_ = now_ns();                    \
+        call;                                       \
+        stages[stage].ns += now_ns() - t0_;         \
+        stages[stage].calls++;                      \
+    } while (0)
+
+static void timer_calibrate(void)
+{
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < 100000U; i++) {
+        (void)now_ns();
+    }
+    timer_cost_ns = (now_ns() - start) / 100000U;
+}
+
+static void trace_append(const trace_rec_t *rec)
+{
+    static uint32_t capacity = 0;
+
+    if (rec_count == capacity) {
+        capacity = (capacity != 0U) ? capacity * 2U : 1024U;
+        recs = realloc(recs, capacity * sizeof(*recs));
+        if (recs == NULL) {
+            fprintf(stderr, "replay: out of memory\n");
+            exit(1);
+        }
+    }
+    recs[rec_count++] = *rec;
+}
+
+/* "TR" lines anywhere in a terminal log; records before the first ping
+ * belong to a ping that is not in the trace */
+static bool trace_load(const char *path)
+{
+    static const char types[] = "PED";
+    char line[REPLAY_LINE_LEN];
+    bool pinged = false;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    calib_identity(&calib);
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        const char *tr = strstr(line, "TR ");
+        unsigned long t_us, value, flags, index;
+        int c[8];
+        char type;
+
+        if (tr == NULL) {
+            continue;
+        }
+        if (sscanf(tr, "TR begin %*u %lu", &value) == 1) {
+            rec_lost = (uint32_t)value;
+        } else if (sscanf(tr, "TR C %lu %d %d %d %d %d %d %d %d", &index,
+                          &c[0], &c[1], &c[2], &c[3], &c[4], &c[5], &c[6], &c[7]) == 9) {
+            for (uint32_t i = 0; (i < 8U) && (index + i < CALIB_POINTS); i++) {
+                calib.corr_us[index + i] = (int16_t)c[i];
+            }
+        } else if (sscanf(tr, "TR %c %lu %lu %lu", &type, &t_us, &value, &flags) == 4) {
+            const char *found = strchr(types, type);
+
+            if ((found == NULL) || (type == '\0')) {
+                continue;
+            }
+            trace_rec_t rec = {
+                .t_us  = (uint32_t)t_us,
+                .value = (uint16_t)value,
+                .type  = (uint8_t)(found - types),
+                .flags = (uint8_t)flags,
+            };
+            pinged |= (rec.type == TRACE_PING);
+            if (pinged) {
+                trace_append(&rec);
+            }
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+/* Firmware output lines, as main.c prints them */
+#if APP_STATS
+static void stats_print(const char *name, const stats_summary_t *sum, float scale)
+{
+    printf("STAT %s n:%lu min:%ld max:%ld mean:%ld sd:%ld p50:%ld p90:%ld p99:%ld\n",
+           name, (unsigned long)sum->count,
+           (long)(sum->min * scale), (long)(sum->max * scale),
+           (long)(sum->mean * scale), (long)(sum->std * scale),
+           (long)(sum->p50 * scale), (long)(sum->p90 * scale),
+           (long)(sum->p99 * scale));
+}
+#endif
+
+#if APP_OCCUPANCY
+static void occupancy_print(const occupancy_event_t *event)
+{
+    static const char *const events[] = { "free", "occ", "hb" };
+    static const char *const states[] = { "", "/free", "/occ" };
+
+    printf("BAY %u %s%s d:%u min:%u t:%lu\n",
+           (unsigned)event->seq, events[event->type],
+           (event->type == OCCUPANCY_EVENT_HEARTBEAT) ? states[event->state] : "",
+           (unsigned)event->distance_cm, (unsigned)event->closest_cm,
+           (unsigned long)event->duration_s);
+}
+#endif
+
+/* The output shows key from emit_us on; a change is one latency sample */
+static void latency_output(latency_out_t out, uint32_t key, uint32_t capture_us, uint32_t emit_us)
+{
+    latency_decide(&latency[out], key, capture_us);
+
+    uint32_t tag = latency_take(&latency[out]);
+    if (tag != LATENCY_NONE) {
+        latency_add(&latency[out], emit_us - tag);
+        stats_add(&latency_total[out], (float32_t)(emit_us - tag));
+    }
+}
+
+/**
+ * @brief  One run over the trace.
+ * @param  quiet  No output lines, only the timings.
+ * @return Pings decided differently than on the sensor.
+ */
+static uint32_t replay_run(bool quiet, uint32_t *pings, uint32_t reasons[HCSR04_REASON_COUNT],
+                           uint32_t zones[POLICY_ZONE_COUNT + 1U])
+{
+    static pipeline_t pipe;
+    hcsr04_result_t result = { 0 };
+    bool     pending   = false;         /* Pinged, not yet decided */
+    bool     decided   = false;         /* Decided, not yet done */
+    uint32_t ping_us   = 0;
+    uint64_t elapsed_us = 0;
+    uint32_t last_us   = recs[0].t_us;
+    uint32_t mismatches = 0;
+#if APP_STATS
+    uint32_t last_stats_ms = 0;
+#endif
+    uint32_t last_latency_ms = 0;
+    policy_entry_t last_policy = { .zone = 0xFFU };
+    long last_shown = -2;
+
+    pipeline_init(&pipe, 0);
+    for (uint32_t out = 0; out < LATENCY_OUT_COUNT; out++) {
+        float32_t range = (out == LATENCY_OUT_BUZZER) ? APP_LATENCY_BUZZER_RANGE_US : APP_LATENCY_DISPLAY_RANGE_US;
+        latency_init(&latency[out], range);
+        stats_init(&latency_total[out], 0.0f, range);
+    }
+
+    for (uint32_t i = 0; i < rec_count; i++) {
+        const trace_rec_t *rec = &recs[i];
+
+        elapsed_us   += (uint32_t)(rec->t_us - last_us);
+        last_us       = rec->t_us;
+        replay_now_us = rec->t_us;
+
+        if (rec->type == TRACE_PING) {
+            HCSR04_SetPingOffset(rec->value);
+            TIMED(STAGE_VALIDATE, (void)HCSR04_Trigger());
+            ping_us = rec->t_us;
+            pending = true;
+            decided = false;
+            continue;
+        }
+        if (rec->type == TRACE_EDGE) {
+            TIMED(STAGE_VALIDATE, HCSR04_EchoEdge(rec->t_us, rec->value ? GPIO_PIN_SET : GPIO_PIN_RESET));
+            if (pending && !decided) {
+                TIMED(STAGE_VALIDATE, decided = HCSR04_PollEcho(&result, false));
+            }
+            continue;
+        }
+        if (!pending) {
+            continue;                   /* DONE without its ping */
+        }
+
+        /* TRACE_DONE: the sensor stopped waiting here */
+        bool timed_out = (rec->flags & TRACE_DONE_TIMED_OUT) != 0U;
+        uint8_t reason = rec->flags & (uint8_t)~TRACE_DONE_TIMED_OUT;
+        bool same = true;
+
+        if (!decided) {
+            same = timed_out;           /* Else the sensor had an echo we did not accept yet */
+            TIMED(STAGE_VALIDATE, decided = HCSR04_PollEcho(&result, true));
+        }
+        same = same && decided && ((uint16_t)result.echo_us == rec->value) && (result.reason == reason);
+        pending = false;
+
+        uint32_t now_ms = (uint32_t)(elapsed_us / 1000U);
+        TIMED(STAGE_FILTER, pipeline_echo(&pipe, &result, (APP_CALIBRATION != 0) ? &calib : NULL));
+#if APP_STATS
+        stats_summary_t sum[2];
+        bool publish = (now_ms - last_stats_ms >= APP_STATS_INTERVAL_MS);
+        if (publish) {
+            last_stats_ms = now_ms;
+        }
+        TIMED(STAGE_STATS, {
+            pipeline_stats(&pipe, rec->t_us - ping_us);
+            if (publish) {
+                stats_publish(&pipe.stats_distance, &sum[0]);
+                stats_publish(&pipe.stats_latency, &sum[1]);
+            }
+        });
+#endif
+#if APP_OCCUPANCY
+        occupancy_event_t event;
+        bool changed;
+        TIMED(STAGE_OCCUPANCY, changed = pipeline_occupancy(&pipe, now_ms, &event));
+#endif
+        float shown;
+        TIMED(STAGE_READOUT, shown = pipeline_readout(&pipe));
+
+        long cm100 = (pipe.valid && (pipe.policy->style == POLICY_STYLE_DISTANCE)) ? (long)(shown * 100.0f) : -1;
+
+        latency_output(LATENCY_OUT_BUZZER, LATENCY_KEY_BUZZER(pipe.policy), pipe.capture_us, rec->t_us);
+        latency_output(LATENCY_OUT_DASH, (cm100 < 0) ? LATENCY_KEY_INVALID : (uint32_t)cm100,
+                       pipe.capture_us, rec->t_us + frame_us);
+        latency_output(LATENCY_OUT_REAR, (cm100 < 0) ? LATENCY_KEY_INVALID : (uint32_t)cm100 / 100U,
+                       pipe.capture_us, rec->t_us + frame_us);
+        bool latency_report = (now_ms - last_latency_ms >= APP_LATENCY_INTERVAL_MS);
+        stats_summary_t latency_sum[LATENCY_OUT_COUNT];
+        if (latency_report) {
+            last_latency_ms = now_ms;
+            for (uint32_t out = 0; out < LATENCY_OUT_COUNT; out++) {
+                stats_publish(&latency[out].hist, &latency_sum[out]);
+            }
+        }
+
+        (*pings)++;
+        reasons[(result.reason < HCSR04_REASON_COUNT) ? result.reason : 0]++;
+        zones[pipe.policy->zone]++;
+        mismatches += same ? 0U : 1U;
+        if (quiet) {
+            continue;
+        }
+
+        if (!same) {
+            printf("MISMATCH %lu.%03lu sensor:%u/%s%s replay:%lu/%s\n",
+                   (unsigned long)(now_ms / 1000U), (unsigned long)(now_ms % 1000U),
+                   (unsigned)rec->value, (reason < HCSR04_REASON_COUNT) ? reason_names[reason] : "?",
+                   timed_out ? "/to" : "", (unsigned long)result.echo_us, reason_names[result.reason]);
+        }
+        if (verbose) {
+            printf("PING %lu.%03lu echo:%lu %s conf:%u lat:%lu cal:%lu zone:%s\n",
+                   (unsigned long)(now_ms / 1000U), (unsigned long)(now_ms % 1000U),
+                   (unsigned long)result.echo_us, reason_names[result.reason], (unsigned)result.confidence,
+                   (unsigned long)(rec->t_us - ping_us), (unsigned long)pipe.echo_us,
+                   zone_names[pipe.policy->zone]);
+        }
+        if ((memcmp(pipe.policy, &last_policy, sizeof(last_policy)) != 0) || (cm100 != last_shown)) {
+            /* What the buzzer and the panels do from here on */
+            printf("OUT %lu.%03lu zone:%s tone:%u cad:%u show:",
+                   (unsigned long)(now_ms / 1000U), (unsigned long)(now_ms % 1000U),
+                   zone_names[pipe.policy->zone], (unsigned)pipe.policy->tone_hz,
+                   (unsigned)pipe.policy->cadence_ms);
+            if (cm100 < 0) {
+                printf("invalid\n");
+            } else {
+                printf("%ld.%02ld\n", cm100 / 100, cm100 % 100);
+            }
+            last_policy = *pipe.policy;
+            last_shown  = cm100;
+        }
+#if APP_OCCUPANCY
+        if (changed) {
+            occupancy_print(&event);
+        }
+#endif
+#if APP_STATS
+        if (publish) {
+            stats_print("dist[mm]", &sum[0], 10.0f);
+            stats_print("ping[us]", &sum[1], 1.0f);
+        }
+#endif
+        if (latency_report) {
+            for (uint32_t out = 0; out < LATENCY_OUT_COUNT; out++) {
+                printf("LAT %s n:%lu p50:%lu p99:%lu max:%lu worst:%lu us\n",
+                       latency_names[out], (unsigned long)latency_sum[out].count,
+                       (unsigned long)latency_sum[out].p50, (unsigned long)latency_sum[out].p99,
+                       (unsigned long)latency_sum[out].max, (unsigned long)latency[out].worst_us);
+            }
+        }
+    }
+    return mismatches;
+}
+
+static void report(uint32_t runs, uint32_t pings, uint32_t mismatches, const uint32_t *reasons,
+                   const uint32_t *zones, uint64_t wall_ns)
+{
+    uint64_t span_us = 0;
+
+    for (uint32_t i = 1; i < rec_count; i++) {
+        span_us += (uint32_t)(recs[i].t_us - recs[i - 1U].t_us);
+    }
+
+    printf("\ntrace: %lu records, %lu pings over %.1f s, %lu lost on the sensor\n",
+           (unsigned long)rec_count, (unsigned long)pings, (double)span_us / 1e6, (unsigned long)rec_lost);
+    printf("decided differently: %lu\n", (unsigned long)mismatches);
+    printf("reasons:");
+    for (uint32_t r = 0; r < HCSR04_REASON_COUNT; r++) {
+        printf(" %s:%lu", reason_names[r], (unsigned long)reasons[r]);
+    }
+    printf("\nzones:");
+    for (uint32_t z = 0; z <= POLICY_ZONE_COUNT; z++) {
+        printf(" %s:%.1f%%", zone_names[z], (pings != 0U) ? 100.0 * zones[z] / pings : 0.0);
+    }
+
+
+    printf("\n\n%-10s %8s %8s %8s %8s  echo edge to output [us]%s\n", "output", "changes", "p50", "p99", "max",
+           (frame_us != 0U) ? ", panels incl. -f" : "");
+    for (uint32_t out = 0; out < LATENCY_OUT_COUNT; out++) {
+        stats_summary_t sum;
+        stats_publish(&latency_total[out], &sum);
+        printf("%-10s %8lu %8lu %8lu %8lu\n", latency_names[out], (unsigned long)sum.count,
+               (unsigned long)sum.p50, (unsigned long)sum.p99, (unsigned long)sum.max);
+    }
+
+    printf("\n%-10s %12s %10s %12s\n", "stage", "calls", "ns/call", "Mcalls/s");
+    uint64_t total_ns = 0;
+    for (uint32_t s = 0; s < STAGE_COUNT; s++) {
+        uint64_t calls = stages[s].calls;
+        uint64_t cost  = stages[s].ns - ((stages[s].ns > calls * timer_cost_ns) ? calls * timer_cost_ns : stages[s].ns);
+        double per     = (calls != 0U) ? (double)cost / (double)calls : 0.0;
+
+        total_ns += cost;
+        printf("%-10s %12llu %10.1f %12.2f\n", stage_names[s], (unsigned long long)calls, per,
+               (per > 0.0) ? 1e3 / per : 0.0);
+    }
+    if ((pings != 0U) && (total_ns != 0U)) {
+        printf("pipeline: %.1f ns/ping, %.2f Mpings/s\n",
+               (double)total_ns / (double)pings / runs, (double)pings * runs / ((double)total_ns / 1e9) / 1e6);
+    }
+    printf("replayed %.1f s of trace x%lu in %.1f ms, %.0fx real time\n",
+           (double)span_us / 1e6, (unsigned long)runs, (double)wall_ns / 1e6,
+           (double)span_us * 1e3 * runs / (double)wall_ns);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t runs = 1;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc)) {
+            runs = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) {
+            frame_us = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            path = argv[i];
+        }
+    }
+    if ((path == NULL) || (runs == 0U)) {
+        fprintf(stderr, "usage: %s [-v] [-r repeat] [-f frame_us] trace.log\n", argv[0]);
+        return 2;
+    }
+    if (!trace_load(path)) {
+        return 1;
+    }
+    if (rec_count == 0U) {
+        fprintf(stderr, "replay: no TR records in %s\n", path);
+        return 1;
+    }
+
+    (void)HCSR04_Init();
+#if APP_PING_JITTER
+    HCSR04_SetConfirm(true);
+#endif
+    timer_calibrate();
+
+    uint32_t pings = 0, mismatches = 0;
+    uint32_t reasons[HCSR04_REASON_COUNT] = { 0 };
+    uint32_t zones[POLICY_ZONE_COUNT + 1U] = { 0 };
+    uint64_t start = now_ns();
+
+    for (uint32_t run = 0; run < runs; run++) {
+        uint32_t run_pings = 0, run_reasons[HCSR04_REASON_COUNT] = { 0 }, run_zones[POLICY_ZONE_COUNT + 1U] = { 0 };
+        uint32_t run_mismatches = replay_run(run != 0U, &run_pings, run_reasons, run_zones);
+
+        if (run == 0U) {
+            pings      = run_pings;
+            mismatches = run_mismatches;
+            memcpy(reasons, run_reasons, sizeof(reasons));
+            memcpy(zones, run_zones, sizeof(zones));
+        }
+    }
+    report(runs, pings, mismatches, reasons, zones, now_ns() - start);
+    return (mismatches != 0U) ? 3 : 0;
+}
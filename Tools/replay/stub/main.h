@@ -0,0 +1,25 @@
+#ifndef _REPLAY_MAIN_H
+#define _REPLAY_MAIN_H
+
+/* Host stand-in for Core/App/Inc/main.h, as far as hcsr04.c uses it */
+
+#include "stm32l4xx_hal.h"
+
+#define EXTI0_IRQn                        6
+#define HAL_NVIC_SetPriority(irq, p, s)   ((void)(irq), (void)(p), (void)(s))
+#define HAL_NVIC_EnableIRQ(irq)           ((void)(irq))
+#define __HAL_RCC_GPIOA_CLK_ENABLE()      ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()      ((void)0)
+#define __DMB()                           __sync_synchronize()
+
+static inline void IO_PinWrite(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    port->BSRR = (state != GPIO_PIN_RESET) ? (uint32_t)pin : (uint32_t)pin << 16;
+}
+
+static inline GPIO_PinState IO_PinRead(GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+#endif /* _REPLAY_MAIN_H */
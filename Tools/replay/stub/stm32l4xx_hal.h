@@ -0,0 +1,49 @@
+#ifndef _REPLAY_STM32L4XX_HAL_H
+#define _REPLAY_STM32L4XX_HAL_H
+
+/* Host stand-in for the HAL types hcsr04.h needs. The pins do
+ * nothing: the replay feeds the recorded edges to HCSR04_EchoEdge. */
+
+#include <stdint.h>
+
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+    uint32_t IDR;
+    uint32_t BSRR;
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+    uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+extern GPIO_TypeDef replay_gpioa;
+extern GPIO_TypeDef replay_gpiob;
+
+#define GPIOA                        (&replay_gpioa)
+#define GPIOB                        (&replay_gpiob)
+#define GPIO_PIN_0                   0x0001U
+#define GPIO_PIN_6                   0x0040U
+#define GPIO_MODE_OUTPUT_PP          0U
+#define GPIO_MODE_IT_RISING_FALLING  0U
+#define GPIO_NOPULL                  0U
+#define GPIO_SPEED_FREQ_LOW          0U
+#define GPIO_SPEED_FREQ_VERY_HIGH    0U
+
+#define HAL_GPIO_Init(port, init)    ((void)(port), (void)(init))
+
+#endif /* _REPLAY_STM32L4XX_HAL_H */
@@ -0,0 +1,21 @@
+#ifndef _REPLAY_TIMEBASE_H
+#define _REPLAY_TIMEBASE_H
+
+/* Host stand-in for Core/App/Inc/timebase.h: the replay sets the clock to
+ * the recorded time of each event, delays take no time */
+
+#include <stdint.h>
+
+extern uint32_t replay_now_us;
+
+static inline uint32_t timebase_now32(void)
+{
+    return replay_now_us;
+}
+
+static inline void timebase_delay_us(uint32_t us)
+{
+    (void)us;
+}
+
+#endif /* _REPLAY_TIMEBASE_H */
@@ -0,0 +1,314 @@
+/**
+ * @file    waveform.c
+ * @brief   Parking-Sensor project.
+ * @details Host renderer of the buzzer patterns. The pattern goes through
+ *          the firmware's own buzzer_pattern.c into the DMA stream that
+ *          Buzzer_Pattern_Play() hands to TIM1, and a model of TIM1 plays
+ *          it: preloaded ARR/CCR taken at the update event, RCR repeating
+ *          the period, one DMA burst per update, PWM mode 2 on the output.
+ *          Prints the register sequence as it becomes active and writes
+ *          the pin as a VCD file (GTKWave, PulseView) with 1 us
+ *          resolution. With -c the waveform is checked against the table:
+ *          tone frequency, duty for the volume, step and pattern length,
+ *          silent rests, a seamless loop and a low pin after the end.
+ *
+ *          waveform [-c] [-l loops] chirp|alarm|fade out.vcd
+ *            -c  check the waveform, exit code 1 on a mismatch
+ *            -l  passes of a looped pattern to render (default 2)
+ * @version 1.0.0
+ * @date    18.10.2026
+ * @author  Filip Radojevic
+ */
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "buzzer_pattern.h"
+
+/*******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define WAVEFORM_MAX_EDGES    200000U
+#define WAVEFORM_MAX_UPDATES  ((BUZZER_PATTERN_MAX_STEPS + 2U) * 16U)
+#define WAVEFORM_FREQ_TOL_PCT 1U         /**< Integer ARR rounding */
+
+/*******************************************************************************
+ * Typedefs
+ ******************************************************************************/
+/* TIM1 as the player sets it up: upcounting, ARPE and OCxPE set */
+typedef struct {
+    buzzer_burst_t preload;              /**< Written by the DMA burst */
+    buzzer_burst_t active;               /**< Taken at the update event */
+    uint32_t       rep;                  /**< Repetition counter */
+    uint32_t       cnt;
+} tim1_model_t;
+
+/* DMA channel on the TIM1 update request */
+typedef struct {
+    const buzzer_burst_t *src;
+    uint32_t              len;           /**< Bursts in the buffer */
+    uint32_t              next;
+    uint32_t              left;          /**< CNDTR in bursts */
+    bool                  circular;
+} dma_model_t;
+
+typedef struct {
+    uint32_t       t_us;
+    buzzer_burst_t regs;
+} update_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static uint32_t edges[WAVEFORM_MAX_EDGES];  /**< Times the pin toggled [us] */
+static uint32_t edge_count;
+static update_t updates[WAVEFORM_MAX_UPDATES];
+static uint32_t update_count;
+static uint32_t end_us;
+static bool     end_level;               /**< Pin when the player stopped */
+static uint32_t failures;
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+static const buzzer_pattern_t *pattern_by_name(const char *name)
+{
+    if (strcmp(name, "chirp") == 0) return &buzzer_pattern_chirp;
+    if (strcmp(name, "alarm") == 0) return &buzzer_pattern_alarm;
+    if (strcmp(name, "fade") == 0)  return &buzzer_pattern_fade;
+    return NULL;
+}
+
+/* Update event: preload becomes active, the DMA request sends the next burst */
+static void tim1_update(tim1_model_t *tim, dma_model_t *dma, uint32_t t_us)
+{
+    tim->active = tim->preload;
+    tim->rep = tim->active.rcr;
+    tim->cnt = 0U;
+
+    if (update_count < WAVEFORM_MAX_UPDATES) {
+        updates[update_count].t_us = t_us;
+        updates[update_count].regs = tim->active;
+        update_count++;
+    }
+
+    if (dma->left > 0U) {
+        tim->preload = dma->src[dma->next];
+        dma->next++;
+        dma->left--;
+        if (dma->circular && dma->left == 0U) {
+            dma->next = 0U;
+            dma->left = dma->len;
+        }
+    }
+}
+
+/* Buzzer_Pattern_Play() and the player's polling, one timer tick per
+ * iteration. A one-shot pattern stops when the channel counter is zero,
+ * a looped one after the requested passes. */
+static void render(const buzzer_pattern_t *pattern, uint32_t loops)
+{
+    static buzzer_burst_t bursts[BUZZER_PATTERN_MAX_STEPS + 2U];
+    tim1_model_t tim = {0};
+    dma_model_t dma = {0};
+    bool level = false;
+
+    uint32_t n = buzzer_pattern_render_stream(pattern, bursts);
+    if (n == 0U) {
+        fprintf(stderr, "pattern does not fit\n");
+        exit(2);
+    }
+
+    tim.preload = bursts[0];
+    dma.src = &bursts[1];
+    dma.len = n;
+    dma.left = n;
+    dma.circular = pattern->loop;
+
+    uint32_t stop_updates = pattern->loop ? loops * pattern->count + 1U : 0U;
+
+    tim1_update(&tim, &dma, 0U);        // UG
+    for (uint32_t t = 0; ; t++) {
+        bool pin = tim.cnt >= tim.active.ccr1;
+        if (pin != level && edge_count < WAVEFORM_MAX_EDGES) {
+            edges[edge_count++] = t;
+            level = pin;
+        }
+
+        if (tim.cnt == tim.active.arr) {
+            if (tim.rep == 0U) {
+                tim1_update(&tim, &dma, t + 1U);
+                bool done = pattern->loop ? (update_count >= stop_updates)
+                                          : (dma.left == 0U);
+                if (done) {
+                    end_us = t + 1U;            // Buzzer_Pattern_Stop: forced low
+                    end_level = tim.cnt >= tim.active.ccr1;
+                    if (level && edge_count < WAVEFORM_MAX_EDGES) {
+                        edges[edge_count++] = end_us;
+                    }
+                    return;
+                }
+            } else {
+                tim.rep--;
+                tim.cnt = 0U;
+            }
+        } else {
+            tim.cnt++;
+        }
+    }
+}
+
+static void write_vcd(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    bool level = false;
+
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    fprintf(f, "$timescale 1us $end\n");
+    fprintf(f, "$scope module buzzer $end\n$var wire 1 ! pa5_pa11 $end\n$upscope $end\n");
+    fprintf(f, "$enddefinitions $end\n#0\n0!\n");
+    for (uint32_t i = 0; i < edge_count; i++) {
+        level = !level;
+        fprintf(f, "#%u\n%c!\n", edges[i], level ? '1' : '0');
+    }
+    fprintf(f, "#%u\n", end_us);
+    fclose(f);
+}
+
+static void print_sequence(void)
+{
+    printf("   t [us]    ARR    RCR   CCR1   CCR4\n");
+    for (uint32_t i = 0; i < update_count; i++) {
+        const buzzer_burst_t *r = &updates[i].regs;
+        printf("%9u  %5u  %5u  %5u  %5u\n", updates[i].t_us, r->arr, r->rcr, r->ccr1, r->ccr4);
+    }
+    printf("end %u us, %u edges\n", end_us, edge_count);
+}
+
+#define EXPECT(cond, ...)                                  \
+    do {                                                   \
+        if (!(cond)) {                                     \
+            failures++;                                    \
+            printf("FAIL: " __VA_ARGS__);                  \
+            printf("\n");                                  \
+        }                                                  \
+    } while (0)
+
+/* Rising edges and high time of the pin in [t0, t1) */
+static void measure(uint32_t t0, uint32_t t1, uint32_t *rises, uint32_t *high_us)
+{
+    bool level = false;
+    uint32_t since = 0U;
+
+    *rises = 0U;
+    *high_us = 0U;
+    for (uint32_t i = 0; i < edge_count; i++) {
+        uint32_t t = edges[i];
+        if (t >= t1) {
+            break;
+        }
+        level = !level;
+        if (level) {
+            since = t;
+            if (t >= t0) {
+                (*rises)++;
+            }
+        } else if (t > t0) {
+            *high_us += t - ((since > t0) ? since : t0);
+        }
+    }
+    if (level && since < t1) {
+        *high_us += t1 - ((since > t0) ? since : t0);
+    }
+}
+
+static void check(const buzzer_pattern_t *pattern, uint32_t loops)
+{
+    uint32_t passes = pattern->loop ? loops : 1U;
+    uint32_t pass_us = updates[pattern->count].t_us;
+
+    EXPECT(update_count == passes * pattern->count + 1U,
+           "%u updates, expected %u", update_count, passes * pattern->count + 1U);
+
+    for (uint32_t i = 0; i < passes * pattern->count && i + 1U < update_count; i++) {
+        const buzzer_step_t *step = &pattern->steps[i % pattern->count];
+        const buzzer_burst_t *r = &updates[i].regs;
+        uint32_t t0 = updates[i].t_us;
+        uint32_t t1 = updates[i + 1U].t_us;
+        uint32_t period = r->arr + 1U;
+        uint32_t repeats = r->rcr + 1U;
+        uint32_t rises, high_us;
+
+        measure(t0, t1, &rises, &high_us);
+
+        EXPECT(t1 - t0 == period * repeats, "step %u: %u us, registers give %u",
+               i, t1 - t0, period * repeats);
+        EXPECT(t1 - t0 + period > step->duration_ms * 1000U &&
+               t1 - t0 < step->duration_ms * 1000U + period,
+               "step %u: %u us for %u ms", i, t1 - t0, step->duration_ms);
+
+        if (step->freq_hz == 0U || step->volume == 0U) {
+            EXPECT(rises == 0U && high_us == 0U, "step %u: rest not silent", i);
+            continue;
+        }
+
+        uint32_t freq = BUZZER_PATTERN_TIMER_HZ / period;
+        uint32_t active = (period * step->volume) / (2U * BUZZER_PATTERN_VOLUME_MAX);
+
+        EXPECT(rises == repeats, "step %u: %u pulses, expected %u", i, rises, repeats);
+        EXPECT(freq * 100U >= step->freq_hz * (100U - WAVEFORM_FREQ_TOL_PCT) &&
+               freq * 100U <= step->freq_hz * (100U + WAVEFORM_FREQ_TOL_PCT),
+               "step %u: %u Hz for %u Hz", i, freq, step->freq_hz);
+        EXPECT(high_us == active * repeats, "step %u: high %u us, expected %u for volume %u",
+               i, high_us, active * repeats, step->volume);
+    }
+
+    EXPECT(pass_us / 1000U == buzzer_pattern_duration_ms(pattern),
+           "pass %u us, buzzer_pattern_duration_ms %u", pass_us, buzzer_pattern_duration_ms(pattern));
+    for (uint32_t p = 1; p < passes; p++) {
+        EXPECT(updates[p * pattern->count].t_us == p * pass_us,
+               "loop pass %u starts at %u us, expected %u", p, updates[p * pattern->count].t_us, p * pass_us);
+    }
+    EXPECT(!end_level, "pin high when the player stopped");
+}
+
+int main(int argc, char **argv)
+{
+    bool verify = false;
+    uint32_t loops = 2U;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-c") == 0) {
+            verify = true;
+        } else if (strcmp(argv[arg], "-l") == 0 && arg + 1 < argc) {
+            loops = (uint32_t)strtoul(argv[++arg], NULL, 0);
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 2 || pattern_by_name(argv[arg]) == NULL || loops == 0U) {
+        fprintf(stderr, "usage: waveform [-c] [-l loops] chirp|alarm|fade out.vcd\n");
+        return 2;
+    }
+
+    const buzzer_pattern_t *pattern = pattern_by_name(argv[arg]);
+
+    render(pattern, loops);
+    print_sequence();
+    write_vcd(argv[arg + 1]);
+
+    if (verify) {
+        check(pattern, loops);
+        printf("%s: %s\n", argv[arg], (failures == 0U) ? "ok" : "FAILED");
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}